@@ -0,0 +1,18 @@
+/* Stand-in for PostgreSQL's access/xact.h, see postgres.h */
+#pragma once
+
+typedef enum
+{
+	XACT_EVENT_COMMIT,
+	XACT_EVENT_PARALLEL_COMMIT,
+	XACT_EVENT_ABORT,
+	XACT_EVENT_PARALLEL_ABORT,
+	XACT_EVENT_PREPARE,
+	XACT_EVENT_PRE_COMMIT,
+	XACT_EVENT_PARALLEL_PRE_COMMIT,
+	XACT_EVENT_PRE_PREPARE,
+} XactEvent;
+
+typedef void (*XactCallback) (XactEvent event, void *arg);
+
+extern void RegisterXactCallback(XactCallback callback, void *arg);
@@ -0,0 +1,15 @@
+/* Stand-in for PostgreSQL's common/hashfn.h, see postgres.h */
+#pragma once
+
+static inline uint32
+murmurhash32(uint32 data)
+{
+	uint32		h = data;
+
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
@@ -0,0 +1,13 @@
+/* Stand-in for PostgreSQL's common/pg_prng.h, see postgres.h */
+#pragma once
+
+typedef struct pg_prng_state
+{
+	uint64		s0,
+				s1;
+} pg_prng_state;
+
+extern pg_prng_state pg_global_prng_state;
+
+extern double pg_prng_double(pg_prng_state *state);
+extern uint32 pg_prng_uint32(pg_prng_state *state);
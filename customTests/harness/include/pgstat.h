@@ -0,0 +1,10 @@
+/* Stand-in for PostgreSQL's pgstat.h, see postgres.h */
+#pragma once
+
+typedef enum IOContext
+{
+	IOCONTEXT_BULKREAD,
+	IOCONTEXT_BULKWRITE,
+	IOCONTEXT_NORMAL,
+	IOCONTEXT_VACUUM,
+} IOContext;
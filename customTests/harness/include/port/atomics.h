@@ -0,0 +1,40 @@
+/*
+ * Stand-in for PostgreSQL's port/atomics.h, see postgres.h. The harness runs
+ * one backend, so these are plain reads and writes.
+ */
+#pragma once
+
+typedef struct pg_atomic_uint32
+{
+	volatile uint32 value;
+} pg_atomic_uint32;
+
+typedef struct pg_atomic_uint64
+{
+	volatile uint64 value;
+} pg_atomic_uint64;
+
+#define pg_read_barrier() ((void) 0)
+#define pg_write_barrier() ((void) 0)
+#define pg_memory_barrier() ((void) 0)
+
+extern void pg_atomic_init_u32(volatile pg_atomic_uint32 *ptr, uint32 val);
+extern uint32 pg_atomic_read_u32(volatile pg_atomic_uint32 *ptr);
+extern void pg_atomic_write_u32(volatile pg_atomic_uint32 *ptr, uint32 val);
+extern uint32 pg_atomic_fetch_add_u32(volatile pg_atomic_uint32 *ptr, int32 add_);
+extern uint32 pg_atomic_fetch_sub_u32(volatile pg_atomic_uint32 *ptr, int32 sub_);
+extern uint32 pg_atomic_add_fetch_u32(volatile pg_atomic_uint32 *ptr, int32 add_);
+extern uint32 pg_atomic_sub_fetch_u32(volatile pg_atomic_uint32 *ptr, int32 sub_);
+extern uint32 pg_atomic_fetch_or_u32(volatile pg_atomic_uint32 *ptr, uint32 or_);
+extern uint32 pg_atomic_fetch_and_u32(volatile pg_atomic_uint32 *ptr, uint32 and_);
+extern uint32 pg_atomic_exchange_u32(volatile pg_atomic_uint32 *ptr, uint32 newval);
+extern bool pg_atomic_compare_exchange_u32(volatile pg_atomic_uint32 *ptr, uint32 *expected, uint32 newval);
+
+extern void pg_atomic_init_u64(volatile pg_atomic_uint64 *ptr, uint64 val);
+extern uint64 pg_atomic_read_u64(volatile pg_atomic_uint64 *ptr);
+extern void pg_atomic_write_u64(volatile pg_atomic_uint64 *ptr, uint64 val);
+extern uint64 pg_atomic_fetch_add_u64(volatile pg_atomic_uint64 *ptr, int64 add_);
+extern uint64 pg_atomic_add_fetch_u64(volatile pg_atomic_uint64 *ptr, int64 add_);
+extern uint64 pg_atomic_fetch_or_u64(volatile pg_atomic_uint64 *ptr, uint64 or_);
+extern uint64 pg_atomic_exchange_u64(volatile pg_atomic_uint64 *ptr, uint64 newval);
+extern bool pg_atomic_compare_exchange_u64(volatile pg_atomic_uint64 *ptr, uint64 *expected, uint64 newval);
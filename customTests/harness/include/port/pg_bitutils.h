@@ -0,0 +1,12 @@
+/* Stand-in for PostgreSQL's port/pg_bitutils.h, see postgres.h */
+#pragma once
+
+static inline uint32
+pg_nextpower2_32(uint32 num)
+{
+	uint32		result = 1;
+
+	while (result < num)
+		result <<= 1;
+	return result;
+}
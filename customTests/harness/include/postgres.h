@@ -0,0 +1,83 @@
+/*
+ * Stand-in for PostgreSQL's postgres.h: just enough of it, and of what it
+ * pulls in, to compile the freelist_*.c engines outside a PostgreSQL tree.
+ * See customTests/harness/README.md.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef int8_t int8;
+typedef uint8_t uint8;
+typedef int16_t int16;
+typedef uint16_t uint16;
+typedef int32_t int32;
+typedef uint32_t uint32;
+typedef int64_t int64;
+typedef uint64_t uint64;
+typedef size_t Size;
+typedef uintptr_t Datum;
+typedef unsigned int Oid;
+typedef uint32 BlockNumber;
+
+#define PG_UINT32_MAX UINT32_MAX
+#define PG_INT32_MAX INT32_MAX
+#define PG_UINT64_MAX UINT64_MAX
+#define UINT64CONST(x) ((uint64) x##ULL)
+#define INT64_FORMAT "%ld"
+#define UINT64_FORMAT "%lu"
+#define BLCKSZ 8192
+
+#define MAXALIGN(x) (((uintptr_t) (x) + 7) & ~(uintptr_t) 7)
+#define CACHELINEALIGN(x) (((uintptr_t) (x) + 63) & ~(uintptr_t) 63)
+#define PG_CACHE_LINE_SIZE 64
+#define FLEXIBLE_ARRAY_MEMBER
+#define PGDLLIMPORT
+
+#define Assert(condition) ((void) 0)
+#define AssertArg(condition) ((void) 0)
+#define StaticAssertStmt(condition, message) _Static_assert(condition, message)
+#define StaticAssertDecl(condition, message) _Static_assert(condition, message)
+#define Min(x, y) ((x) < (y) ? (x) : (y))
+#define Max(x, y) ((x) > (y) ? (x) : (y))
+#define lengthof(array) (sizeof(array) / sizeof((array)[0]))
+#define MemSet(start, val, len) memset(start, val, len)
+#define likely(x) __builtin_expect((x) != 0, 1)
+#define unlikely(x) __builtin_expect((x) != 0, 0)
+#define pg_unreachable() __builtin_unreachable()
+#define pg_attribute_unused() __attribute__((unused))
+#define CHECK_FOR_INTERRUPTS() ((void) 0)
+
+#define DEBUG1 14
+#define LOG 15
+#define NOTICE 18
+#define WARNING 19
+#define ERROR 21
+
+/* elog(ERROR, ...) longjmps back to the harness, see stubs.c */
+extern void elog_fn(int elevel, const char *fmt,...) __attribute__((format(printf, 2, 3)));
+#define elog(elevel, ...) \
+	do { \
+		elog_fn(elevel, __VA_ARGS__); \
+		if ((elevel) >= ERROR) \
+			pg_unreachable(); \
+	} while(0)
+
+extern void *palloc(Size size);
+extern void *palloc0(Size size);
+extern void pfree(void *pointer);
+extern Size add_size(Size s1, Size s2);
+extern Size mul_size(Size s1, Size s2);
+extern void *ShmemInitStruct(const char *name, Size size, bool *foundPtr);
+
+extern uint32 hash_bytes(const unsigned char *k, int keylen);
+extern uint32 hash_bytes_uint32(uint32 k);
+
+extern int	NBuffers;
+extern int	MyProcNumber;
+extern int	MyBackendId;
+
+#include "storage/s_lock.h"
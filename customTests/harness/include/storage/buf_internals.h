@@ -0,0 +1,84 @@
+/*
+ * Stand-in for PostgreSQL's storage/buf_internals.h, see postgres.h, with the
+ * prototypes bufmgr.patch adds.
+ */
+#pragma once
+
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+
+typedef int Buffer;
+
+#define InvalidBuffer 0
+
+typedef struct BufferTag
+{
+	Oid			spcOid;
+	Oid			dbOid;
+	Oid			relNumber;
+	int			forkNum;
+	BlockNumber blockNum;
+} BufferTag;
+
+typedef struct BufferDesc
+{
+	BufferTag	tag;
+	int			buf_id;
+	pg_atomic_uint32 state;
+	int			wait_backend_pgprocno;
+	int			freeNext;
+} BufferDesc;
+
+#define BUF_REFCOUNT_ONE 1
+#define BUF_REFCOUNT_MASK ((1U << 18) - 1)
+#define BUF_USAGECOUNT_MASK 0x003C0000U
+#define BUF_USAGECOUNT_ONE (1U << 18)
+#define BUF_USAGECOUNT_SHIFT 18
+#define BUF_FLAG_MASK 0xFFC00000U
+
+#define BUF_STATE_GET_REFCOUNT(state) ((state) & BUF_REFCOUNT_MASK)
+#define BUF_STATE_GET_USAGECOUNT(state) (((state) & BUF_USAGECOUNT_MASK) >> BUF_USAGECOUNT_SHIFT)
+
+#define BM_LOCKED (1U << 22)
+#define BM_DIRTY (1U << 23)
+#define BM_VALID (1U << 24)
+#define BM_TAG_VALID (1U << 25)
+#define BM_IO_IN_PROGRESS (1U << 26)
+#define BM_PERMANENT (1U << 31)
+
+#define BM_MAX_USAGE_COUNT 5
+
+#define FREENEXT_END_OF_LIST (-1)
+#define FREENEXT_NOT_IN_LIST (-2)
+
+#define NUM_BUFFER_PARTITIONS 128
+
+#define BufferDescriptorGetBuffer(bdesc) ((bdesc)->buf_id + 1)
+
+extern BufferDesc *GetBufferDescriptor(uint32 id);
+extern uint32 LockBufHdr(BufferDesc *desc);
+extern void UnlockBufHdr(BufferDesc *desc, uint32 buf_state);
+
+extern bool BufferTagsEqual(const BufferTag *tag1, const BufferTag *tag2);
+extern void ClearBufferTag(BufferTag *tag);
+
+/* freelist.c */
+typedef struct BufferAccessStrategyData *BufferAccessStrategy;
+
+extern BufferDesc *StrategyGetBuffer(BufferAccessStrategy strategy,
+									 uint32 *buf_state, bool *from_ring);
+extern void StrategyFreeBuffer(BufferDesc *buf);
+extern int	StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc);
+extern Size StrategyShmemSize(void);
+extern void StrategyInitialize(bool init);
+
+/* CS3223: see bufmgr.patch */
+extern void StrategyAccessBuffer(int buf_id, bool delete);
+extern void StrategyAccessPinnedBuffer(int buf_id);
+extern void StrategyRefillVictimQueue(void);
+extern int	StrategySyncVictims(int *buf_ids, int max_buffers);
+
+/* buf_table.c */
+extern Size BufTableShmemSize(int size);
+extern void InitBufTable(int size);
+extern uint32 BufTableHashCode(BufferTag *tagPtr);
@@ -0,0 +1,47 @@
+/* Stand-in for PostgreSQL's storage/bufmgr.h, see postgres.h */
+#pragma once
+
+typedef enum BufferAccessStrategyType
+{
+	BAS_NORMAL,
+	BAS_BULKREAD,
+	BAS_BULKWRITE,
+	BAS_VACUUM,
+} BufferAccessStrategyType;
+
+typedef struct BufferAccessStrategyData *BufferAccessStrategy;
+
+extern BufferAccessStrategy GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb);
+
+/* The engines' GUCs, defined in stubs.c as bufmgr.patch defines them in bufmgr.c */
+extern PGDLLIMPORT int lru_num_partitions;
+extern PGDLLIMPORT int lru_access_ring_size;
+extern PGDLLIMPORT int lru_promotion_filter;
+extern PGDLLIMPORT int lru_promotion_probability;
+extern PGDLLIMPORT int lru_victim_queue_size;
+extern PGDLLIMPORT int lru_dirty_lookahead;
+extern PGDLLIMPORT int lru_dirty_age_tolerance;
+extern PGDLLIMPORT int lru_old_percent;
+extern PGDLLIMPORT int lru_old_dwell_ms;
+extern PGDLLIMPORT bool lru_admission_filter;
+extern PGDLLIMPORT int lru_admission_lookahead;
+extern PGDLLIMPORT int elru_b2_bucket_width;
+extern PGDLLIMPORT int elru_num_partitions;
+extern PGDLLIMPORT int elru_access_ring_size;
+extern PGDLLIMPORT int elru_clock_batch;
+extern PGDLLIMPORT int elru_promotion_filter;
+extern PGDLLIMPORT int elru_promotion_probability;
+extern PGDLLIMPORT int elru_correlated_period;
+extern PGDLLIMPORT int elru_victim_queue_size;
+extern PGDLLIMPORT int elru_dirty_lookahead;
+extern PGDLLIMPORT int elru_dirty_age_tolerance;
+extern PGDLLIMPORT bool elru_admission_filter;
+extern PGDLLIMPORT int elru_k;
+extern PGDLLIMPORT int elru_history_percent;
+extern PGDLLIMPORT int elru_retained_period;
+extern PGDLLIMPORT int twoq_a1in_percent;
+extern PGDLLIMPORT int twoq_a1out_percent;
+extern PGDLLIMPORT int lirs_hir_percent;
+extern PGDLLIMPORT int lirs_nonresident_percent;
+extern PGDLLIMPORT int s3fifo_small_percent;
+extern PGDLLIMPORT int s3fifo_ghost_percent;
@@ -0,0 +1,35 @@
+/*
+ * Stand-in for PostgreSQL's storage/lwlock.h, see postgres.h. The harness
+ * aborts on an LWLock taken under a spinlock or a buffer header lock, or
+ * taken twice, see stubs.c.
+ */
+#pragma once
+
+#include "port/atomics.h"
+
+typedef struct LWLock
+{
+	uint16		tranche;
+	pg_atomic_uint32 state;
+} LWLock;
+
+typedef union LWLockPadded
+{
+	LWLock		lock;
+	char		pad[128];
+} LWLockPadded;
+
+typedef enum LWLockMode
+{
+	LW_EXCLUSIVE,
+	LW_SHARED,
+} LWLockMode;
+
+extern bool LWLockAcquire(LWLock *lock, LWLockMode mode);
+extern bool LWLockConditionalAcquire(LWLock *lock, LWLockMode mode);
+extern void LWLockRelease(LWLock *lock);
+extern bool LWLockHeldByMe(LWLock *lock);
+extern bool LWLockHeldByMeInMode(LWLock *lock, LWLockMode mode);
+extern void LWLockInitialize(LWLock *lock, int tranche_id);
+extern int	LWLockNewTrancheId(void);
+extern void LWLockRegisterTranche(int tranche_id, const char *tranche_name);
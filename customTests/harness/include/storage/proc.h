@@ -0,0 +1,24 @@
+/* Stand-in for PostgreSQL's storage/proc.h, see postgres.h */
+#pragma once
+
+typedef struct Latch
+{
+	int			is_set;
+} Latch;
+
+typedef struct PGPROC
+{
+	Latch		procLatch;
+	int			pgprocno;
+} PGPROC;
+
+typedef struct PROC_HDR
+{
+	PGPROC	   *allProcs;
+} PROC_HDR;
+
+extern PGPROC *MyProc;
+extern PROC_HDR *ProcGlobal;
+extern int	MaxBackends;
+
+extern void SetLatch(Latch *latch);
@@ -0,0 +1,11 @@
+/*
+ * Stand-in for PostgreSQL's storage/s_lock.h, see postgres.h. The harness
+ * aborts on a spinlock taken twice, see stubs.c.
+ */
+#pragma once
+
+typedef unsigned char slock_t;
+
+extern void SpinLockInit(volatile slock_t *lock);
+extern void SpinLockAcquire(volatile slock_t *lock);
+extern void SpinLockRelease(volatile slock_t *lock);
@@ -0,0 +1,6 @@
+/* Stand-in for PostgreSQL's utils/timestamp.h, see postgres.h */
+#pragma once
+
+typedef int64 TimestampTz;
+
+extern TimestampTz GetCurrentTimestamp(void);
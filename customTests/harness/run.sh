@@ -0,0 +1,46 @@
+#!/bin/sh
+# Runs every line of tests.txt and compares the output with expected/.
+# Usage: ./run.sh [-u]    (-u rewrites expected/ instead)
+
+HARNESS_DIR=$(cd "$(dirname "$0")" && pwd)
+ASSIGN_DIR=${HARNESS_DIR}/../..
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf ${BUILD_DIR}' EXIT
+
+UPDATE=0
+if [ "$1" = "-u" ]; then
+	UPDATE=1
+fi
+
+cd ${HARNESS_DIR}
+mkdir -p expected
+
+# Each line is: engine testcase [guc=value ...]
+grep -v '^#' tests.txt | grep -v '^ *$' | while read ENGINE TESTCASE GUCS; do
+	NAME=${ENGINE}-${TESTCASE}
+	GUC_SETUP=""
+	for GUC in ${GUCS}; do
+		GUC_SETUP="${GUC_SETUP} ${GUC%%=*} = ${GUC#*=};"
+	done
+
+	if ! gcc -std=gnu99 -Wall -Wno-unused-function -Iinclude \
+		-DTESTCASE="\"../${TESTCASE}.c\"" -DGUC_SETUP="${GUC_SETUP}" \
+		-o ${BUILD_DIR}/${NAME} test_bufmgr.c stubs.c ${ASSIGN_DIR}/freelist_${ENGINE}.c \
+		2> ${BUILD_DIR}/${NAME}.log; then
+		cat ${BUILD_DIR}/${NAME}.log
+		echo "FAIL ${NAME} (build)"
+		continue
+	fi
+
+	${BUILD_DIR}/${NAME} > ${BUILD_DIR}/${NAME}.out 2>&1
+	if [ ${UPDATE} -eq 1 ]; then
+		cp ${BUILD_DIR}/${NAME}.out expected/${NAME}.out
+		echo "updated ${NAME}"
+	elif diff -u expected/${NAME}.out ${BUILD_DIR}/${NAME}.out; then
+		echo "ok ${NAME}"
+	else
+		echo "FAIL ${NAME}"
+	fi
+done | tee ${BUILD_DIR}/summary
+
+! grep -q '^FAIL' ${BUILD_DIR}/summary
@@ -0,0 +1,544 @@
+/*
+ * stubs.c
+ *	  The parts of the PostgreSQL backend that the freelist_*.c engines call,
+ *	  for one backend and no shared memory. See README.md.
+ *
+ * The lock stubs check the rules the engines rely on: an LWLock is never
+ * taken while a spinlock or a buffer header lock is held, and no lock is
+ * taken twice. A violation aborts the harness.
+ */
+#include "postgres.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "access/xact.h"
+#include "common/pg_prng.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/proc.h"
+#include "utils/timestamp.h"
+
+#include "stubs.h"
+
+#define MAX_BUFFERS 1024
+#define MAX_SHMEM_STRUCTS 64
+#define MAX_HELD_LWLOCKS 64
+
+int			NBuffers = 16;
+int			MaxBackends = 1;
+int			MyProcNumber = 0;
+int			MyBackendId = 1;
+pg_prng_state pg_global_prng_state;
+
+/* The engines' GUCs, with the defaults of bufmgr.patch */
+int			lru_num_partitions = 1;
+int			lru_access_ring_size = 0;
+int			lru_promotion_filter = 0;
+int			lru_promotion_probability = 0;
+int			lru_victim_queue_size = 0;
+int			lru_dirty_lookahead = 0;
+int			lru_dirty_age_tolerance = 10;
+int			lru_old_percent = 0;
+int			lru_old_dwell_ms = 1000;
+bool		lru_admission_filter = false;
+int			lru_admission_lookahead = 8;
+int			elru_b2_bucket_width = 0;
+int			elru_num_partitions = 1;
+int			elru_access_ring_size = 0;
+int			elru_clock_batch = 1;
+int			elru_promotion_filter = 0;
+int			elru_promotion_probability = 0;
+int			elru_correlated_period = 0;
+int			elru_victim_queue_size = 0;
+int			elru_dirty_lookahead = 0;
+int			elru_dirty_age_tolerance = 10;
+bool		elru_admission_filter = false;
+int			elru_k = 2;
+int			elru_history_percent = 0;
+int			elru_retained_period = 0;
+int			twoq_a1in_percent = 25;
+int			twoq_a1out_percent = 50;
+int			lirs_hir_percent = 1;
+int			lirs_nonresident_percent = 100;
+int			s3fifo_small_percent = 10;
+int			s3fifo_ghost_percent = 90;
+
+jmp_buf		elog_jmp;
+int			lwlock_acquisitions = 0;
+
+static TimestampTz currentTimestamp = 5000000000LL;
+
+static BufferDesc bufferDescriptors[MAX_BUFFERS];
+
+static struct
+{
+	const char *name;
+	void	   *ptr;
+}			shmemStructs[MAX_SHMEM_STRUCTS];
+static int	numShmemStructs = 0;
+
+static int	heldSpinlocks = 0;
+static int	heldBufHdrLocks = 0;
+static LWLock *heldLWLocks[MAX_HELD_LWLOCKS];
+static int	numHeldLWLocks = 0;
+
+static PGPROC procs[1];
+static PROC_HDR procHdr = {procs};
+PGPROC	   *MyProc = &procs[0];
+PROC_HDR   *ProcGlobal = &procHdr;
+
+static void
+harness_abort(const char *message, int buf_id)
+{
+	fprintf(stderr, "harness: %s", message);
+	if (buf_id >= 0)
+		fprintf(stderr, " (bufid %d)", buf_id);
+	fprintf(stderr, "\n");
+	abort();
+}
+
+/* As InitBufferPool does: every buffer on the freelist, in buf_id order */
+void
+init_buffer_pool(void)
+{
+	if (NBuffers > MAX_BUFFERS)
+		harness_abort("too many buffers", -1);
+
+	for (int i = 0; i < NBuffers; i++)
+	{
+		memset(&bufferDescriptors[i], 0, sizeof(BufferDesc));
+		bufferDescriptors[i].buf_id = i;
+		bufferDescriptors[i].freeNext = (i == NBuffers - 1) ? FREENEXT_END_OF_LIST : i + 1;
+	}
+}
+
+void
+elog_fn(int elevel, const char *fmt,...)
+{
+	va_list		args;
+
+	if (elevel < ERROR)
+		return;
+
+	va_start(args, fmt);
+	printf("ERROR:  ");
+	vprintf(fmt, args);
+	printf("\n");
+	va_end(args);
+	longjmp(elog_jmp, 1);
+}
+
+void *
+palloc(Size size)
+{
+	return malloc(size);
+}
+
+void *
+palloc0(Size size)
+{
+	return calloc(1, size);
+}
+
+void
+pfree(void *pointer)
+{
+	free(pointer);
+}
+
+Size
+add_size(Size s1, Size s2)
+{
+	return s1 + s2;
+}
+
+Size
+mul_size(Size s1, Size s2)
+{
+	return s1 * s2;
+}
+
+void *
+ShmemInitStruct(const char *name, Size size, bool *foundPtr)
+{
+	for (int i = 0; i < numShmemStructs; i++)
+	{
+		if (strcmp(shmemStructs[i].name, name) == 0)
+		{
+			*foundPtr = true;
+			return shmemStructs[i].ptr;
+		}
+	}
+
+	if (numShmemStructs == MAX_SHMEM_STRUCTS)
+		harness_abort("too many shared memory structs", -1);
+
+	shmemStructs[numShmemStructs].name = name;
+	shmemStructs[numShmemStructs].ptr = calloc(1, size + PG_CACHE_LINE_SIZE);
+	*foundPtr = false;
+	return shmemStructs[numShmemStructs++].ptr;
+}
+
+uint32
+hash_bytes(const unsigned char *k, int keylen)
+{
+	uint32		hash = 2166136261u;
+
+	for (int i = 0; i < keylen; i++)
+	{
+		hash ^= k[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+uint32
+hash_bytes_uint32(uint32 k)
+{
+	return hash_bytes((const unsigned char *) &k, sizeof(k));
+}
+
+/* Deterministic, so that a testcase's output does not change from run to run */
+double
+pg_prng_double(pg_prng_state *state)
+{
+	state->s0 = state->s0 * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (double) (state->s0 >> 11) / (double) (1ULL << 53);
+}
+
+uint32
+pg_prng_uint32(pg_prng_state *state)
+{
+	state->s0 = state->s0 * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (uint32) (state->s0 >> 32);
+}
+
+/* Time stands still in the harness, unless a testcase calls sleep_ms */
+TimestampTz
+GetCurrentTimestamp(void)
+{
+	return currentTimestamp;
+}
+
+void
+advance_time(int ms)
+{
+	currentTimestamp += (TimestampTz) ms * 1000;
+}
+
+void
+RegisterXactCallback(XactCallback callback, void *arg)
+{
+}
+
+void
+SetLatch(Latch *latch)
+{
+	latch->is_set = 1;
+}
+
+void
+SpinLockInit(volatile slock_t *lock)
+{
+	*lock = 0;
+}
+
+void
+SpinLockAcquire(volatile slock_t *lock)
+{
+	if (*lock)
+		harness_abort("spinlock taken twice", -1);
+	*lock = 1;
+	heldSpinlocks++;
+}
+
+void
+SpinLockRelease(volatile slock_t *lock)
+{
+	if (!*lock)
+		harness_abort("spinlock released but not held", -1);
+	*lock = 0;
+	heldSpinlocks--;
+}
+
+bool
+LWLockAcquire(LWLock *lock, LWLockMode mode)
+{
+	if (heldSpinlocks > 0 || heldBufHdrLocks > 0)
+		harness_abort("LWLock taken under a spinlock or buffer header lock", -1);
+	if (LWLockHeldByMe(lock))
+		harness_abort("LWLock taken twice", -1);
+	if (numHeldLWLocks == MAX_HELD_LWLOCKS)
+		harness_abort("too many LWLocks held", -1);
+
+	heldLWLocks[numHeldLWLocks++] = lock;
+	lwlock_acquisitions++;
+	return true;
+}
+
+bool
+LWLockConditionalAcquire(LWLock *lock, LWLockMode mode)
+{
+	return LWLockAcquire(lock, mode);
+}
+
+void
+LWLockRelease(LWLock *lock)
+{
+	for (int i = 0; i < numHeldLWLocks; i++)
+	{
+		if (heldLWLocks[i] == lock)
+		{
+			heldLWLocks[i] = heldLWLocks[--numHeldLWLocks];
+			return;
+		}
+	}
+	harness_abort("LWLock released but not held", -1);
+}
+
+bool
+LWLockHeldByMe(LWLock *lock)
+{
+	for (int i = 0; i < numHeldLWLocks; i++)
+	{
+		if (heldLWLocks[i] == lock)
+			return true;
+	}
+	return false;
+}
+
+bool
+LWLockHeldByMeInMode(LWLock *lock, LWLockMode mode)
+{
+	return LWLockHeldByMe(lock);
+}
+
+void
+LWLockInitialize(LWLock *lock, int tranche_id)
+{
+	lock->tranche = tranche_id;
+}
+
+int
+LWLockNewTrancheId(void)
+{
+	return 100;
+}
+
+void
+LWLockRegisterTranche(int tranche_id, const char *tranche_name)
+{
+}
+
+/* All atomics are plain reads and writes: there is one backend */
+
+void
+pg_atomic_init_u32(volatile pg_atomic_uint32 *ptr, uint32 val)
+{
+	ptr->value = val;
+}
+
+uint32
+pg_atomic_read_u32(volatile pg_atomic_uint32 *ptr)
+{
+	return ptr->value;
+}
+
+void
+pg_atomic_write_u32(volatile pg_atomic_uint32 *ptr, uint32 val)
+{
+	ptr->value = val;
+}
+
+uint32
+pg_atomic_fetch_add_u32(volatile pg_atomic_uint32 *ptr, int32 add_)
+{
+	uint32		old = ptr->value;
+
+	ptr->value += add_;
+	return old;
+}
+
+uint32
+pg_atomic_fetch_sub_u32(volatile pg_atomic_uint32 *ptr, int32 sub_)
+{
+	uint32		old = ptr->value;
+
+	ptr->value -= sub_;
+	return old;
+}
+
+uint32
+pg_atomic_add_fetch_u32(volatile pg_atomic_uint32 *ptr, int32 add_)
+{
+	ptr->value += add_;
+	return ptr->value;
+}
+
+uint32
+pg_atomic_sub_fetch_u32(volatile pg_atomic_uint32 *ptr, int32 sub_)
+{
+	ptr->value -= sub_;
+	return ptr->value;
+}
+
+uint32
+pg_atomic_fetch_or_u32(volatile pg_atomic_uint32 *ptr, uint32 or_)
+{
+	uint32		old = ptr->value;
+
+	ptr->value |= or_;
+	return old;
+}
+
+uint32
+pg_atomic_fetch_and_u32(volatile pg_atomic_uint32 *ptr, uint32 and_)
+{
+	uint32		old = ptr->value;
+
+	ptr->value &= and_;
+	return old;
+}
+
+uint32
+pg_atomic_exchange_u32(volatile pg_atomic_uint32 *ptr, uint32 newval)
+{
+	uint32		old = ptr->value;
+
+	ptr->value = newval;
+	return old;
+}
+
+bool
+pg_atomic_compare_exchange_u32(volatile pg_atomic_uint32 *ptr, uint32 *expected, uint32 newval)
+{
+	if (ptr->value == *expected)
+	{
+		ptr->value = newval;
+		return true;
+	}
+	*expected = ptr->value;
+	return false;
+}
+
+void
+pg_atomic_init_u64(volatile pg_atomic_uint64 *ptr, uint64 val)
+{
+	ptr->value = val;
+}
+
+uint64
+pg_atomic_read_u64(volatile pg_atomic_uint64 *ptr)
+{
+	return ptr->value;
+}
+
+void
+pg_atomic_write_u64(volatile pg_atomic_uint64 *ptr, uint64 val)
+{
+	ptr->value = val;
+}
+
+uint64
+pg_atomic_fetch_add_u64(volatile pg_atomic_uint64 *ptr, int64 add_)
+{
+	uint64		old = ptr->value;
+
+	ptr->value += add_;
+	return old;
+}
+
+uint64
+pg_atomic_add_fetch_u64(volatile pg_atomic_uint64 *ptr, int64 add_)
+{
+	ptr->value += add_;
+	return ptr->value;
+}
+
+uint64
+pg_atomic_fetch_or_u64(volatile pg_atomic_uint64 *ptr, uint64 or_)
+{
+	uint64		old = ptr->value;
+
+	ptr->value |= or_;
+	return old;
+}
+
+uint64
+pg_atomic_exchange_u64(volatile pg_atomic_uint64 *ptr, uint64 newval)
+{
+	uint64		old = ptr->value;
+
+	ptr->value = newval;
+	return old;
+}
+
+bool
+pg_atomic_compare_exchange_u64(volatile pg_atomic_uint64 *ptr, uint64 *expected, uint64 newval)
+{
+	if (ptr->value == *expected)
+	{
+		ptr->value = newval;
+		return true;
+	}
+	*expected = ptr->value;
+	return false;
+}
+
+BufferDesc *
+GetBufferDescriptor(uint32 id)
+{
+	if (id >= (uint32) NBuffers)
+		harness_abort("buffer id out of range", (int) id);
+	return &bufferDescriptors[id];
+}
+
+uint32
+LockBufHdr(BufferDesc *desc)
+{
+	if (pg_atomic_read_u32(&desc->state) & BM_LOCKED)
+		harness_abort("buffer header locked twice", desc->buf_id);
+	heldBufHdrLocks++;
+	return pg_atomic_fetch_or_u32(&desc->state, BM_LOCKED) | BM_LOCKED;
+}
+
+void
+UnlockBufHdr(BufferDesc *desc, uint32 buf_state)
+{
+	if (!(pg_atomic_read_u32(&desc->state) & BM_LOCKED))
+		harness_abort("buffer header unlocked but not locked", desc->buf_id);
+	heldBufHdrLocks--;
+	pg_atomic_write_u32(&desc->state, buf_state & ~BM_LOCKED);
+}
+
+bool
+BufferTagsEqual(const BufferTag *tag1, const BufferTag *tag2)
+{
+	return memcmp(tag1, tag2, sizeof(BufferTag)) == 0;
+}
+
+void
+ClearBufferTag(BufferTag *tag)
+{
+	memset(tag, 0, sizeof(BufferTag));
+}
+
+Size
+BufTableShmemSize(int size)
+{
+	return 0;
+}
+
+void
+InitBufTable(int size)
+{
+}
+
+uint32
+BufTableHashCode(BufferTag *tagPtr)
+{
+	return hash_bytes((const unsigned char *) tagPtr, sizeof(BufferTag));
+}
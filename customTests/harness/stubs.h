@@ -0,0 +1,10 @@
+/* What stubs.c offers the harness besides the backend functions it stands in for */
+#pragma once
+
+#include <setjmp.h>
+
+extern jmp_buf elog_jmp;			/* elog(ERROR, ...) jumps here */
+extern int	lwlock_acquisitions;	/* LWLockAcquire calls so far */
+
+extern void init_buffer_pool(void);
+extern void advance_time(int ms);	/* GetCurrentTimestamp moves on by 'ms' */
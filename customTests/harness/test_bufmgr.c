@@ -0,0 +1,321 @@
+/*
+ * test_bufmgr.c
+ *	  Runs a customTests testcase against one of the freelist_*.c engines,
+ *	  without PostgreSQL. See README.md.
+ *
+ * The testcase is compiled in as TESTCASE, and calls read_pin_block,
+ * read_unpin_block and unpin_block as it does in the test_bufmgr extension.
+ * Blocks are read into a pool of NBuffers buffers the way BufferAlloc does,
+ * with the calls bufmgr.patch adds: a hit is reported to the engine by
+ * StrategyAccessBuffer, or by StrategyAccessPinnedBuffer if this backend had
+ * the buffer pinned already, and a miss takes the buffer StrategyGetBuffer
+ * returns. Like PinBuffer, only a backend's first pin of a buffer shows in
+ * its shared refcount and usage count.
+ *
+ * Every call prints one line: the buffer the block is in, whether it was a
+ * hit, a repin or a miss, the block a miss evicted, and the number of
+ * LWLocks the engine took. run.sh compares that with expected/.
+ */
+#include "postgres.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+
+#include "stubs.h"
+
+#define MAX_BLOCKS 1024
+#define MAX_BUFFERS_IN_TEST 1024
+#define RING_BUFFERS 2
+
+/* Only some engines have these, see print_engine_state */
+extern void StrategyArcTarget(int *p, int *t1_size, int *t2_size, int *b1_size, int *b2_size) __attribute__((weak));
+extern void StrategyCorrelationStats(uint64 *correlated_references) __attribute__((weak));
+extern void StrategyClockProStats(int *hot_frames, int *cold_target, uint64 *shadow_hits, uint64 *shadow_misses) __attribute__((weak));
+
+static int	bufferOfBlock[MAX_BLOCKS];	/* -1 if the block is not in the pool */
+static int	blockOfBuffer[MAX_BUFFERS_IN_TEST];
+static int	privateRefCount[MAX_BUFFERS_IN_TEST];	/* This backend's pins */
+static long numHits = 0;
+static long numMisses = 0;
+
+static void
+stop(const char *fmt, BlockNumber blkno)
+{
+	printf("ERROR:  ");
+	printf(fmt, blkno);
+	printf("\n");
+	longjmp(elog_jmp, 1);
+}
+
+static void
+print_engine_state(void)
+{
+	int			p,
+				t1_size,
+				t2_size,
+				b1_size,
+				b2_size;
+	int			hot_frames,
+				cold_target;
+	uint64		shadow_hits,
+				shadow_misses;
+
+	if (StrategyArcTarget)
+	{
+		StrategyArcTarget(&p, &t1_size, &t2_size, &b1_size, &b2_size);
+		printf(" p %d", p);
+	}
+	if (StrategyClockProStats)
+	{
+		StrategyClockProStats(&hot_frames, &cold_target, &shadow_hits, &shadow_misses);
+		printf(" hot %d cold target %d", hot_frames, cold_target);
+	}
+}
+
+/*
+ * BufferAlloc and PinBuffer, with 'strategy' or NULL. Returns the buffer
+ * holding 'blkno', pinned.
+ */
+static int
+read_block(const char *caller, BlockNumber blkno, BufferAccessStrategy strategy)
+{
+	int			buf_id;
+	BufferDesc *buf;
+	uint32		buf_state;
+	bool		from_ring;
+	int			evicted = -1;
+	bool		evicted_dirty = false;
+	int			locks_before = lwlock_acquisitions;
+	const char *how;
+
+	if (blkno >= MAX_BLOCKS)
+		stop("block %u is out of range", blkno);
+
+	buf_id = bufferOfBlock[blkno];
+	if (buf_id >= 0)
+	{
+		buf = GetBufferDescriptor(buf_id);
+		numHits++;
+
+		if (privateRefCount[buf_id]++ > 0)
+		{
+			how = "repin";
+			StrategyAccessPinnedBuffer(buf_id);
+		}
+		else
+		{
+			how = "hit";
+			buf_state = pg_atomic_read_u32(&buf->state) + BUF_REFCOUNT_ONE;
+			/* A strategy's pin only raises a usage count of 0 */
+			if (strategy == NULL ? BUF_STATE_GET_USAGECOUNT(buf_state) < BM_MAX_USAGE_COUNT
+				: BUF_STATE_GET_USAGECOUNT(buf_state) == 0)
+				buf_state += BUF_USAGECOUNT_ONE;
+			pg_atomic_write_u32(&buf->state, buf_state);
+			StrategyAccessBuffer(buf_id, false);
+		}
+	}
+	else
+	{
+		how = "miss";
+		numMisses++;
+
+		buf = StrategyGetBuffer(strategy, &buf_state, &from_ring);
+		if (from_ring)
+			how = "miss from ring";
+		buf_id = buf->buf_id;
+
+		if (buf_state & BM_TAG_VALID)
+		{
+			evicted = blockOfBuffer[buf_id];
+			evicted_dirty = (buf_state & BM_DIRTY) != 0;
+			bufferOfBlock[evicted] = -1;
+		}
+
+		buf->tag.relNumber = 1;
+		buf->tag.blockNum = blkno;
+		/* FlushBuffer wrote out a dirty victim */
+		buf_state &= ~(BUF_REFCOUNT_MASK | BUF_USAGECOUNT_MASK | BM_DIRTY);
+		buf_state |= BM_TAG_VALID | BM_VALID | BUF_REFCOUNT_ONE | BUF_USAGECOUNT_ONE;
+		UnlockBufHdr(buf, buf_state);
+
+		bufferOfBlock[blkno] = buf_id;
+		blockOfBuffer[buf_id] = blkno;
+		privateRefCount[buf_id] = 1;
+	}
+
+	printf("%s blkno %u bufid %d %s", caller, blkno, buf_id, how);
+	if (evicted >= 0)
+		printf(" evicts %sblkno %d", evicted_dirty ? "dirty " : "", evicted);
+	printf(" lwlocks %d", lwlock_acquisitions - locks_before);
+	print_engine_state();
+	printf("\n");
+
+	return buf_id;
+}
+
+/* UnpinBuffer */
+static void
+release_block(BlockNumber blkno)
+{
+	int			buf_id = (blkno < MAX_BLOCKS) ? bufferOfBlock[blkno] : -1;
+
+	if (buf_id < 0 || privateRefCount[buf_id] == 0)
+		stop("block %u is not pinned", blkno);
+
+	if (--privateRefCount[buf_id] == 0)
+		pg_atomic_fetch_sub_u32(&GetBufferDescriptor(buf_id)->state, BUF_REFCOUNT_ONE);
+}
+
+static void
+read_pin_block(BlockNumber blkno)
+{
+	(void) read_block("read_pin_block", blkno, NULL);
+}
+
+static void
+read_unpin_block(BlockNumber blkno)
+{
+	(void) read_block("read_unpin_block", blkno, NULL);
+	release_block(blkno);
+}
+
+/*
+ * read_unpin_block through a BAS_BULKREAD ring of RING_BUFFERS buffers (the
+ * most 16 buffers allow), as a sequential scan of a large table reads. The
+ * harness has this besides the calls of the test_bufmgr extension.
+ */
+static void
+read_unpin_ring_block(BlockNumber blkno)
+{
+	static BufferAccessStrategy strategy = NULL;
+
+	if (strategy == NULL)
+		strategy = GetAccessStrategyWithSize(BAS_BULKREAD, RING_BUFFERS * (BLCKSZ / 1024));
+
+	(void) read_block("read_unpin_ring_block", blkno, strategy);
+	release_block(blkno);
+}
+
+static void
+unpin_block(BlockNumber blkno)
+{
+	int			buf_id = (blkno < MAX_BLOCKS) ? bufferOfBlock[blkno] : -1;
+
+	release_block(blkno);
+	printf("unpin_block blkno %u bufid %d\n", blkno, buf_id);
+}
+
+/*
+ * InvalidateBuffer, as DROP TABLE does to an unpinned buffer. The harness
+ * has this besides the calls of the test_bufmgr extension.
+ */
+static void
+drop_block(BlockNumber blkno)
+{
+	int			buf_id = (blkno < MAX_BLOCKS) ? bufferOfBlock[blkno] : -1;
+	BufferDesc *buf;
+	uint32		buf_state;
+	int			locks_before = lwlock_acquisitions;
+
+	if (buf_id < 0 || privateRefCount[buf_id] > 0)
+		stop("block %u is not in the pool unpinned", blkno);
+
+	buf = GetBufferDescriptor(buf_id);
+	buf_state = LockBufHdr(buf);
+	ClearBufferTag(&buf->tag);
+	buf_state &= ~(BUF_FLAG_MASK | BUF_USAGECOUNT_MASK);
+	UnlockBufHdr(buf, buf_state);
+	StrategyFreeBuffer(buf);
+
+	bufferOfBlock[blkno] = -1;
+	printf("drop_block blkno %u bufid %d lwlocks %d\n", blkno, buf_id, lwlock_acquisitions - locks_before);
+}
+
+/*
+ * MarkBufferDirty, for a block the backend has pinned. The harness has this
+ * besides the calls of the test_bufmgr extension.
+ */
+static void
+dirty_block(BlockNumber blkno)
+{
+	int			buf_id = (blkno < MAX_BLOCKS) ? bufferOfBlock[blkno] : -1;
+
+	if (buf_id < 0 || privateRefCount[buf_id] == 0)
+		stop("block %u is not pinned", blkno);
+
+	pg_atomic_fetch_or_u32(&GetBufferDescriptor(buf_id)->state, BM_DIRTY);
+	printf("dirty_block blkno %u bufid %d\n", blkno, buf_id);
+}
+
+/* pg_sleep. The harness has this besides the calls of the test_bufmgr extension. */
+static void
+sleep_ms(int ms)
+{
+	advance_time(ms);
+	printf("sleep_ms %d\n", ms);
+}
+
+/*
+ * What BgBufferSync does for the engine on every round of the bgwriter.
+ * The harness has this besides the calls of the test_bufmgr extension.
+ */
+static void
+bgwriter_round(void)
+{
+	int			locks_before = lwlock_acquisitions;
+
+	StrategyRefillVictimQueue();
+	printf("bgwriter_round lwlocks %d\n", lwlock_acquisitions - locks_before);
+}
+
+static void
+run_testcase(void)
+{
+#include TESTCASE
+}
+
+int
+main(void)
+{
+	uint64		correlated_references;
+	int			hot_frames,
+				cold_target;
+	uint64		shadow_hits,
+				shadow_misses;
+
+#ifdef GUC_SETUP
+	GUC_SETUP
+#endif
+
+	if (NBuffers > MAX_BUFFERS_IN_TEST)
+	{
+		fprintf(stderr, "harness: too many buffers\n");
+		return 1;
+	}
+
+	for (int i = 0; i < MAX_BLOCKS; i++)
+		bufferOfBlock[i] = -1;
+
+	init_buffer_pool();
+	StrategyInitialize(true);
+
+	if (setjmp(elog_jmp) == 0)
+		run_testcase();
+
+	printf("hits %ld misses %ld\n", numHits, numMisses);
+	if (StrategyCorrelationStats)
+	{
+		StrategyCorrelationStats(&correlated_references);
+		printf("correlated references " UINT64_FORMAT "\n", correlated_references);
+	}
+	if (StrategyClockProStats)
+	{
+		StrategyClockProStats(&hot_frames, &cold_target, &shadow_hits, &shadow_misses);
+		printf("shadow hits " UINT64_FORMAT " misses " UINT64_FORMAT "\n", shadow_hits, shadow_misses);
+	}
+
+	return 0;
+}
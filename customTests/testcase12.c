@@ -0,0 +1,28 @@
+read_pin_block(1);
+read_pin_block(2);
+read_pin_block(3);
+read_pin_block(4);
+read_pin_block(5);
+read_pin_block(6);
+read_pin_block(7);
+read_pin_block(8);
+read_pin_block(9);
+read_pin_block(10);
+read_pin_block(11);
+read_pin_block(12);
+read_pin_block(13);
+read_pin_block(14);
+read_pin_block(15);
+read_pin_block(16);
+// All 16 buffer pages are pinned and full now, and all of them are in B1
+
+read_unpin_block(1);
+// Block 1 is pinned by this backend already, so this is a repin: bufmgr reports it to StrategyAccessPinnedBuffer
+// and block 1 stays in B1
+
+unpin_block(1);
+unpin_block(2);
+// Blocks 1 and 2 are the only unpinned pages, both in B1, and block 1 is the least recently used
+
+read_pin_block(17);
+// This should evict block 1. Had the repin been a second reference, block 1 would be in B2 and block 2 would go
@@ -0,0 +1,73 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// A1in holds all 16 pages, Am is empty
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+// A1in holds more than Kin (25%, 4 frames): blocks 1 to 4 are evicted from its tail, and A1out remembers them
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+// Blocks 1 to 4 are loaded again, evicting 5 to 8, and their first hits find them in A1out: they move to Am
+
+read_unpin_block(100);
+read_unpin_block(101);
+read_unpin_block(102);
+read_unpin_block(103);
+read_unpin_block(104);
+read_unpin_block(105);
+read_unpin_block(106);
+read_unpin_block(107);
+read_unpin_block(108);
+read_unpin_block(109);
+read_unpin_block(110);
+read_unpin_block(111);
+read_unpin_block(112);
+read_unpin_block(113);
+read_unpin_block(114);
+read_unpin_block(115);
+read_unpin_block(116);
+read_unpin_block(117);
+read_unpin_block(118);
+read_unpin_block(119);
+read_unpin_block(120);
+read_unpin_block(121);
+read_unpin_block(122);
+read_unpin_block(123);
+read_unpin_block(124);
+read_unpin_block(125);
+read_unpin_block(126);
+read_unpin_block(127);
+read_unpin_block(128);
+read_unpin_block(129);
+read_unpin_block(130);
+read_unpin_block(131);
+// A scan of 32 blocks, twice the pool, only ever evicts from A1in
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+// All hits: the scan did not evict Am
@@ -0,0 +1,49 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// T1 holds all 16 pages, p is 0
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+// Blocks 1 to 15 are referenced again and move to T2, block 16 is the only page left in T1
+
+read_unpin_block(17);
+read_unpin_block(18);
+// T1 holds more than p frames: blocks 16 and 17 are evicted from it, and B1 remembers them
+
+read_unpin_block(16);
+read_unpin_block(16);
+// Block 16 is loaded again, evicting 18, and its first hit finds it in B1: p grows to 1 and block 16 moves to T2
+
+read_unpin_block(19);
+// T1 is empty, so block 1 is evicted from the tail of T2, and B2 remembers it
+
+read_unpin_block(1);
+read_unpin_block(1);
+// Block 1 is loaded again, evicting 2 from T2, and its first hit finds it in B2: p shrinks back to 0
@@ -0,0 +1,58 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+read_unpin_block(17);
+// Blocks 1 to 15 become LIR pages (the LIR set holds all but Lhirs, 1% of the pool, at least 1 frame).
+// The single HIR frame holds block 16, then block 17
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+read_unpin_block(17);
+// A loop over 17 blocks, one more than the pool: blocks 1 to 15 are hits, only 16 and 17 take turns in the HIR frame
+// (LRU, and 2Q, miss on every block)
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+read_unpin_block(17);
+// Same again: the LIR pages stay resident
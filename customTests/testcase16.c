@@ -0,0 +1,27 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// The queue holds all 16 pages, block 1 at its tail
+
+read_unpin_block(1);
+// A hit only sets the frame's visited bit: no LWLock, and block 1 stays at the tail
+
+read_unpin_block(17);
+read_unpin_block(18);
+// The hand starts at the tail: it clears block 1's visited bit and passes it, then evicts blocks 2 and 3
+
+read_unpin_block(1);
+// Block 1 is still resident, and again takes no LWLock
@@ -0,0 +1,36 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// small holds all 16 pages, block 1 at its tail
+
+read_unpin_block(1);
+// The first hit of a newly loaded page takes the list lock, to look block 1 up in the ghost queue
+
+read_unpin_block(1);
+// Any later hit only bumps the frame's frequency: no LWLock, and block 1 stays at the tail of small
+
+read_unpin_block(3);
+// First hit of block 3
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+// small holds more than its share (10%, 1 frame), so eviction starts at its tail: blocks 1 and 3 were hit and move
+// to main, blocks 2, 4 and 5 were not and are evicted
+
+read_unpin_block(1);
+read_unpin_block(3);
+// Hits in main, which take no LWLock either
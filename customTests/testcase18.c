@@ -0,0 +1,50 @@
+read_unpin_block(1);
+read_unpin_block(1);
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(2);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(3);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(4);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(5);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(6);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(7);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(8);
+read_unpin_block(8);
+// Blocks 1 to 8 are accessed three times each, and are in B2
+
+read_unpin_block(9);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(15);
+read_unpin_block(16);
+read_unpin_block(16);
+// Blocks 9 to 16 are accessed twice each, later, and are in B2 as well. B1 is empty
+
+read_unpin_block(17);
+// With elru_k = 3, B2 is ordered by the third last access. Blocks 9 to 16 have none, so this evicts block 9,
+// the least recently used of them (with K = 2, block 1 would go: its second last access is the oldest)
+
+read_unpin_block(1);
+// Block 1 is still resident
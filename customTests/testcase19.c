@@ -0,0 +1,42 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// B1 holds all 16 pages
+
+read_unpin_block(16);
+// With elru_correlated_period = 25, a reference within 4 clock ticks of the last access is correlated with it:
+// it is counted, but block 16 stays in B1
+
+read_unpin_block(1);
+// Block 1 was accessed longer ago than that, so it moves to B2
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(23);
+read_unpin_block(24);
+read_unpin_block(25);
+read_unpin_block(26);
+read_unpin_block(27);
+read_unpin_block(28);
+read_unpin_block(29);
+read_unpin_block(30);
+read_unpin_block(31);
+// Blocks 2 to 15 are evicted from the tail of B1, then block 16 (with elru_correlated_period = 0, block 16 would be
+// in B2 and block 17 would go)
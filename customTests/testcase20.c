@@ -0,0 +1,66 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool from the freelist. Every frame is cold, fresh and in its test period, and the cold
+// target starts at half the pool (8 frames)
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+// Blocks 1 to 4 are hit within their test period
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(23);
+read_unpin_block(24);
+read_unpin_block(25);
+read_unpin_block(26);
+read_unpin_block(27);
+read_unpin_block(28);
+read_unpin_block(29);
+read_unpin_block(30);
+read_unpin_block(31);
+read_unpin_block(32);
+read_unpin_block(33);
+read_unpin_block(34);
+read_unpin_block(35);
+read_unpin_block(36);
+read_unpin_block(37);
+read_unpin_block(38);
+read_unpin_block(39);
+read_unpin_block(40);
+// A scan of 24 blocks. The hand turns blocks 1 to 4 hot on its first pass, as they were hit in their test period,
+// and evicts only cold frames: each scan page is evicted before it is hit, and leaves a shadow entry
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+// Blocks 1 to 4 are still hits
+
+read_unpin_block(28);
+read_unpin_block(28);
+// Block 28 was evicted by the last of the scan's misses and comes back: its first hit finds its shadow entry
+// within the hot target's worth of evictions, so the frame turns hot at once and the cold target grows
+
+read_unpin_block(17);
+read_unpin_block(17);
+// Block 17 comes back much later than that: it stays cold and the cold target shrinks
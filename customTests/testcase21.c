@@ -0,0 +1,43 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool, block 1 at the LRU end
+
+read_unpin_block(8);
+read_unpin_block(3);
+read_unpin_block(16);
+// Hits in the middle of the list, and at the MRU end, find their frames by buf_id and move them to the MRU end
+
+drop_block(12);
+// Unlinks block 12's frame from the middle of the list, also by buf_id, and frees its buffer
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(23);
+read_unpin_block(24);
+read_unpin_block(25);
+read_unpin_block(26);
+read_unpin_block(27);
+read_unpin_block(28);
+read_unpin_block(29);
+read_unpin_block(30);
+// Block 17 takes the freed buffer. The other misses evict blocks 1, 2, 4 to 7, 9 to 11 and 13 to 15, in the order they
+// were loaded. Then LRU evicts block 8, the first of the blocks hit, while ELRU keeps the blocks hit in B2 and evicts
+// block 17 from B1
@@ -0,0 +1,65 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 are in B1
+
+read_unpin_block(16);
+read_unpin_block(15);
+read_unpin_block(14);
+read_unpin_block(13);
+read_unpin_block(12);
+read_unpin_block(11);
+read_unpin_block(10);
+read_unpin_block(9);
+read_unpin_block(8);
+read_unpin_block(7);
+read_unpin_block(6);
+read_unpin_block(5);
+read_unpin_block(4);
+read_unpin_block(3);
+read_unpin_block(2);
+read_unpin_block(1);
+// Hit from block 16 down to block 1, so they go to B2 in that order. Their 2nd last access is still their load
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+// Hit again, blocks 1 to 12 take their previous hit as their 2nd last access. B2 now orders blocks 13 to 16 first,
+// then 12 down to 1
+
+read_unpin_block(17);
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(22);
+// B1 is empty, so every miss evicts the B2 frame at the top of the heap: blocks 13 to 16, then 12 and 11. Each new
+// block is hit at once, so it goes to B2 too, behind them
@@ -0,0 +1,59 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 are in B1. Every miss takes two clock ticks, so they were loaded at ticks 2, 4, ... 32
+
+read_unpin_block(16);
+read_unpin_block(15);
+read_unpin_block(14);
+read_unpin_block(13);
+read_unpin_block(12);
+read_unpin_block(11);
+read_unpin_block(10);
+read_unpin_block(9);
+read_unpin_block(8);
+read_unpin_block(7);
+read_unpin_block(6);
+read_unpin_block(5);
+read_unpin_block(4);
+read_unpin_block(3);
+read_unpin_block(2);
+read_unpin_block(1);
+// Hit from block 16 down to block 1, so they go to B2 in that order. With 8 ticks to a bucket, their 2nd last access
+// (the load) puts blocks 1 to 3 in the oldest bucket, blocks 4 to 7 in the next, then blocks 8 to 11
+
+read_unpin_block(17);
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(22);
+read_unpin_block(23);
+read_unpin_block(23);
+read_unpin_block(24);
+read_unpin_block(24);
+read_unpin_block(25);
+read_unpin_block(25);
+read_unpin_block(26);
+read_unpin_block(26);
+// Every miss evicts from the oldest bucket that is not empty, the frame that went into it first: blocks 3 to 1, 7 to 4,
+// then 11 to 9. The B2 heap evicts blocks 1 to 10, in the order of their 2nd last access
@@ -0,0 +1,37 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool. Buffer b is in partition b % 4, so partition 0 holds blocks 1, 5, 9 and 13
+
+read_unpin_block(1);
+read_unpin_block(2);
+// Each hit takes only the locks of its own partition, and moves the frame to the head of that partition
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(23);
+read_unpin_block(24);
+read_unpin_block(25);
+read_unpin_block(26);
+read_unpin_block(27);
+read_unpin_block(28);
+// Victim search starts at the next partition every time, so evictions go round the partitions, each from its own tail:
+// blocks 5, 6, 3, 4, then 9, 10, 7, 8, then 13, 14, 11, 12. Blocks 1 and 2 stay, as each is at the head of its
+// partition
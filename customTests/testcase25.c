@@ -0,0 +1,35 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+// The hits on blocks 1 to 3 are only recorded in the backend's access ring and take no LWLock. The hit on block 4
+// fills the ring of 4, and all four are applied in one go, under one round of locking
+
+read_unpin_block(5);
+read_unpin_block(5);
+read_unpin_block(6);
+// A hit on the frame recorded last is not recorded again, so the ring holds blocks 5 and 6
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+// Victim search applies the ring first, so blocks 5 and 6 are not evicted: the misses evict blocks 7 to 10
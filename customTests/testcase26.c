@@ -0,0 +1,29 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool
+
+read_unpin_block(16);
+read_unpin_block(14);
+read_unpin_block(1);
+// LRU: blocks 16 and 14 are within 25% of the head (4 promotions), so their hits take no LWLock and leave them where
+// they are. Block 1 is at the tail and moves to the head. ELRU: every first hit moves the frame from B1 to B2
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(1);
+// Block 1 has just been moved, so hitting it again takes no LWLock, even after block 2 moved in front of it. ELRU
+// skips the re-reference in B2 the same way, as it comes within 25% of NBuffers clock ticks of the last one
@@ -0,0 +1,43 @@
+read_pin_block(1);
+read_pin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool, and the backend keeps blocks 1 and 2 pinned at the LRU end
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+// The walk from the tail passes over the pinned frames under the shared list lock. It moves the first unpinned one
+// under the exclusive lock, and only locks its buffer header once no list lock is held: the misses evict blocks 3, 4
+// and 5
+
+read_pin_block(6);
+read_pin_block(7);
+read_pin_block(8);
+read_pin_block(9);
+read_pin_block(10);
+read_pin_block(11);
+read_pin_block(12);
+read_pin_block(13);
+read_pin_block(14);
+read_pin_block(15);
+read_pin_block(16);
+read_pin_block(17);
+read_pin_block(18);
+read_pin_block(19);
+// Every buffer is pinned now
+
+read_pin_block(20);
+// The walk finds no unpinned frame and fails
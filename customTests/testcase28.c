@@ -0,0 +1,33 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool
+
+bgwriter_round();
+// The bgwriter picks the 4 victims at the LRU end in advance: blocks 1 to 4
+
+read_unpin_block(2);
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+// The misses pop victims from the queue instead of walking the list. Block 2 was hit after the queue was filled, so the
+// miss that pops it finds the frame moved and takes the next entry, block 3. Once the queue is empty, the last miss
+// walks the list and evicts block 5
+
+bgwriter_round();
+read_unpin_block(21);
+// The next round refills the queue from the LRU end: blocks 6 to 9
@@ -0,0 +1,29 @@
+read_pin_block(1);
+dirty_block(1);
+unpin_block(1);
+read_pin_block(2);
+dirty_block(2);
+unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool, and blocks 1 and 2 at the LRU end are dirty
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+// The first candidate of every miss is dirty block 1, so victim search looks at up to 3 more for a clean one, which
+// must not be more than 25% younger (of the partition for LRU, of NBuffers clock ticks for ELRU). The clean blocks
+// behind blocks 1 and 2 are evicted in their place until the next one is too young, and then the dirty block goes
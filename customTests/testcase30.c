@@ -0,0 +1,35 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool
+
+read_unpin_ring_block(101);
+read_unpin_ring_block(102);
+read_unpin_ring_block(103);
+read_unpin_ring_block(104);
+read_unpin_ring_block(105);
+read_unpin_ring_block(106);
+read_unpin_ring_block(107);
+read_unpin_ring_block(108);
+// A scan through a ring of 2 buffers. Its first miss evicts block 1, and the frame goes to the LRU end instead of the
+// head. So the next miss, with a ring slot still empty, evicts that same frame, and from then on the ring recycles it
+// without taking an LWLock: the whole scan goes through one buffer
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+// The scan's last block is the first to go, and the rest of the pool is evicted in LRU order, from block 2
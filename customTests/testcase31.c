@@ -0,0 +1,51 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool. Each enters at the head of the old sublist, the tail half of the list, and the sublist
+// boundary moves along as the list grows: blocks 1, 3, ... 15 end up young, and blocks 2, 4, ... 16 old
+
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+// Blocks 1 and 3 are young and move to the head. Blocks 2 and 4 went into the old sublist less than lru_old_dwell_ms
+// (1 second) ago, so their hits take no LWLock and leave them where they are
+
+sleep_ms(1000);
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+// A second later, the hits on blocks 2 and 4 move them to the head as well
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(23);
+read_unpin_block(24);
+read_unpin_block(25);
+read_unpin_block(26);
+read_unpin_block(27);
+read_unpin_block(28);
+read_unpin_block(29);
+read_unpin_block(30);
+read_unpin_block(31);
+read_unpin_block(32);
+// A scan. Its pages enter the old sublist, so once the old blocks 6, 8, ... 16 and blocks 15 and 13 (which age out of
+// the young sublist) are evicted, the scan evicts its own pages, blocks 17 to 24. Blocks 1 to 5, 7, 9 and 11 stay
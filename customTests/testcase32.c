@@ -0,0 +1,49 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill the pool. A newly loaded page is on probation until it is hit
+
+read_unpin_block(1);
+read_unpin_block(1);
+read_unpin_block(1);
+read_unpin_block(1);
+read_unpin_block(16);
+// Block 1 is hit 4 times and block 16 once, which the admission sketch counts
+
+drop_block(1);
+read_unpin_block(1);
+read_unpin_block(16);
+// Block 1 is dropped and read again: it is on probation once more, but the sketch still remembers its hits. Block 16
+// is hit again, so it is newer than block 1
+
+read_unpin_block(17);
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(23);
+read_unpin_block(24);
+read_unpin_block(25);
+read_unpin_block(26);
+read_unpin_block(27);
+read_unpin_block(28);
+read_unpin_block(29);
+read_unpin_block(30);
+read_unpin_block(31);
+// Blocks 2 to 15 were never hit, so they are evicted without a contest. Then block 1 comes up for eviction: it is
+// more popular than block 16, the frame evicted after it (LRU) or the B2 victim (ELRU), so it is admitted and block 16
+// is evicted in its place
@@ -0,0 +1,42 @@
+read_unpin_block(1);
+read_unpin_block(2);
+read_unpin_block(3);
+read_unpin_block(4);
+read_unpin_block(5);
+read_unpin_block(6);
+read_unpin_block(7);
+read_unpin_block(8);
+read_unpin_block(9);
+read_unpin_block(10);
+read_unpin_block(11);
+read_unpin_block(12);
+read_unpin_block(13);
+read_unpin_block(14);
+read_unpin_block(15);
+read_unpin_block(16);
+// Blocks 1 to 16 fill B1
+
+read_unpin_block(17);
+read_unpin_block(1);
+// Block 17 evicts block 1, whose load is retained beyond its eviction. Block 1 is read again at once, so it has been
+// accessed twice, but the new frame only knows of the second access
+
+read_unpin_block(18);
+read_unpin_block(19);
+read_unpin_block(20);
+read_unpin_block(21);
+read_unpin_block(22);
+read_unpin_block(23);
+read_unpin_block(24);
+read_unpin_block(25);
+read_unpin_block(26);
+read_unpin_block(27);
+read_unpin_block(28);
+read_unpin_block(29);
+read_unpin_block(30);
+read_unpin_block(31);
+read_unpin_block(32);
+read_unpin_block(33);
+// A scan. When block 1 comes up for eviction, its retained history is looked up: with its earlier load, it has had
+// K = 2 accesses, so it goes to B2 and the scan evicts block 18 instead. Without elru_history_percent, block 1 is
+// evicted
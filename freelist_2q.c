@@ -0,0 +1,1285 @@
+/*-------------------------------------------------------------------------
+ *
+ * freelist.c
+ *	  routines for managing the buffer pool's replacement strategy.
+ *
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/freelist.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "port/pg_bitutils.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/proc.h"
+
+#include <assert.h>
+
+#define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
+
+/*********************************************/
+// CS3223 - Data Structure declarations
+
+// 2Q (Johnson & Shasha) keeps every resident frame in one of two lists:
+//   A1in - FIFO of pages referenced once; further references to them are taken to be correlated and change nothing
+//   Am   - LRU of pages referenced again after they had left A1in
+// and remembers the tags of pages recently evicted from A1in in A1out, a FIFO of ghosts that holds no frames.
+// A page whose tag is still in A1out when it is referenced again has proven to be reused over a longer period than
+// A1in covers, and goes to Am. Victims come from the tail of A1in while A1in holds more than its share of the pool,
+// from the tail of Am otherwise. A scan's pages only ever pass through A1in, so Am (the working set) is left alone.
+//
+// StrategyGetBuffer does not know which page the victim will hold, so a newly loaded page always enters A1in (as a
+// fresh frame), and A1out is looked up on its first re-reference, or when it comes up for eviction if it has none,
+// instead of when it is loaded.
+
+// List membership tag for every node, so a frame can be found by buf_id in O(1)
+#define LIST_NONE 0
+#define LIST_A1IN 1
+#define LIST_AM 2
+
+// Nodes are linked by buf_id (32 bits) instead of by pointer. NIL_FRAME also ends the A1out hash chains.
+#define NIL_FRAME (-1)
+#define FRAME_ID(frame) ((int32) ((frame) - doubleLinkedList))
+
+typedef struct node {
+	int32 prev;                        // buf_id of the previous node, or NIL_FRAME
+	int32 next;                        // buf_id of the next node, or NIL_FRAME
+	uint8 list;                        // LIST_NONE, LIST_A1IN or LIST_AM
+	bool fresh;                        // In A1in and not referenced since its page was loaded
+} node;
+
+typedef struct info {
+	int32 head;                        // buf_id of the head node, or NIL_FRAME
+	int32 tail;                        // buf_id of the tail node, or NIL_FRAME
+	int size;
+} info;
+
+// A1out entry. Ghosts are kept in a ring of slots in FIFO order; a slot is reused once the ring comes round to it
+// again, which drops the oldest ghost. Ghosts are also chained by hash of their tag, so a lookup is O(1).
+typedef struct ghost_entry {
+	BufferTag tag;
+	int32 hash_next;                   // Slot of the next ghost in the same hash bucket, or NIL_FRAME
+	bool valid;                        // False while the slot is unused, or once its ghost was referenced
+} ghost_entry;
+
+typedef struct twoq_info {
+	info a1in;                         // Head is the most recently loaded page
+	info am;                           // Head is the most recently used page
+	int a1in_target;                   // Kin: A1in is evicted from first while it holds more frames than this
+	int a1out_capacity;                // Kout: number of ghost slots, 0 if A1out is off
+	int a1out_next;                    // Slot the next ghost goes into
+	int a1out_size;                    // Valid ghosts
+	uint32 num_buckets;                // Power of two, at least a1out_capacity
+	LWLock twoQ_lock;                  // Exclusive to change A1in, Am or A1out, shared to walk A1in or Am
+} twoq_info;
+
+static node* doubleLinkedList = NULL;         // Indexed by buf_id, NBuffers nodes shared by A1in and Am
+static twoq_info* twoQ = NULL;
+static ghost_entry* ghosts = NULL;            // A1out, a1out_capacity slots
+static int32* ghostBuckets = NULL;            // A1out hash buckets, num_buckets heads of slot chains
+
+// CS3223: The GUCs below are defined in bufmgr.c, see the GUCs in freelist_lru.c
+
+// CS3223 - GUC (PGC_POSTMASTER): percentage of NBuffers that A1in may hold before victims are taken from it rather than
+// from Am (Kin). The 2Q paper recommends 25.
+extern PGDLLIMPORT int twoq_a1in_percent;
+
+// CS3223 - GUC (PGC_POSTMASTER): number of ghosts A1out remembers, as a percentage of NBuffers (Kout). The 2Q paper
+// recommends 50. 0 turns A1out off, and then no page ever gets to Am.
+extern PGDLLIMPORT int twoq_a1out_percent;
+
+int twoq_a1in_target(void);
+int twoq_a1out_capacity(void);
+uint32 twoq_num_buckets(int capacity);
+void unlink_frame(info* list_info, node* frame);
+void insert_at_head(info* list_info, node* frame);
+info* list_of(node* frame);
+uint32 ghost_bucket_of(const BufferTag* tag);
+void ghost_unlink(int slot);
+void ghost_insert(const BufferTag* tag);
+bool ghost_remove(const BufferTag* tag);
+bool claim_victim(int32 frame_id, uint32* buf_state);
+int sync_victims_from(info* list_info, int32* frame_id, int* buf_ids, int num_buffers, int max_buffers);
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions);
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions);
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections);
+
+/*********************************************/
+// CS3223 - Function definitions
+
+// Kin, twoq_a1in_percent of NBuffers, at least 1
+int twoq_a1in_target(void) {
+	return Max((int) ((int64) NBuffers * Min(Max(twoq_a1in_percent, 0), 100) / 100), 1);
+}
+
+// Kout, twoq_a1out_percent of NBuffers. A1out may remember more pages than fit in the pool, up to 4 times NBuffers.
+int twoq_a1out_capacity(void) {
+	return (int) ((int64) NBuffers * Min(Max(twoq_a1out_percent, 0), 400) / 100);
+}
+
+uint32 twoq_num_buckets(int capacity) {
+	return pg_nextpower2_32((uint32) Max(capacity, 1));
+}
+
+// Unlink a frame from A1in or Am in O(1)
+void unlink_frame(info* list_info, node* frame) {
+	if (frame->prev != NIL_FRAME) {
+		doubleLinkedList[frame->prev].next = frame->next;
+	} else {
+		list_info->head = frame->next;
+	}
+
+	if (frame->next != NIL_FRAME) {
+		doubleLinkedList[frame->next].prev = frame->prev;
+	} else {
+		list_info->tail = frame->prev;
+	}
+
+	frame->prev = NIL_FRAME;
+	frame->next = NIL_FRAME;
+	frame->list = LIST_NONE;
+	frame->fresh = false;
+	list_info->size--;
+}
+
+// Link a frame (which must not be in A1in or Am) at the head of A1in or Am
+void insert_at_head(info* list_info, node* frame) {
+	Assert(frame->list == LIST_NONE);
+
+	frame->prev = NIL_FRAME;
+	frame->next = list_info->head;
+	if (list_info->head != NIL_FRAME) { // Check if list is not empty
+		doubleLinkedList[list_info->head].prev = FRAME_ID(frame);
+	}
+	list_info->head = FRAME_ID(frame);
+
+	if (list_info->tail == NIL_FRAME) { // If list was empty, update tail as well
+		list_info->tail = FRAME_ID(frame);
+	}
+
+	frame->list = (list_info == &twoQ->a1in) ? LIST_A1IN : LIST_AM;
+	list_info->size++;
+}
+
+info* list_of(node* frame) {
+	return (frame->list == LIST_A1IN) ? &twoQ->a1in : &twoQ->am;
+}
+
+// A1out - Function definitions. All of them are called with twoQ_lock held exclusively.
+
+uint32 ghost_bucket_of(const BufferTag* tag) {
+	return BufTableHashCode((BufferTag*) tag) & (twoQ->num_buckets - 1);
+}
+
+// Take the ghost in 'slot' off its hash chain. Chains are about one ghost long, as there are at least as many buckets
+// as slots.
+void ghost_unlink(int slot) {
+	int32* link = &ghostBuckets[ghost_bucket_of(&ghosts[slot].tag)];
+
+	while (*link != slot) {
+		Assert(*link != NIL_FRAME);
+		link = &ghosts[*link].hash_next;
+	}
+
+	*link = ghosts[slot].hash_next;
+	ghosts[slot].valid = false;
+	twoQ->a1out_size--;
+}
+
+// Remember the tag of a page evicted from A1in, dropping the oldest ghost if A1out is full. The page may already have
+// a ghost, if it was loaded again and evicted before its first reference; that ghost is dropped in favour of the new
+// one.
+void ghost_insert(const BufferTag* tag) {
+	int slot;
+	uint32 bucket;
+
+	if (twoQ->a1out_capacity == 0) {
+		return;
+	}
+
+	(void) ghost_remove(tag);
+
+	slot = twoQ->a1out_next;
+	twoQ->a1out_next = (slot + 1) % twoQ->a1out_capacity;
+
+	if (ghosts[slot].valid) {
+		ghost_unlink(slot);
+	}
+
+	bucket = ghost_bucket_of(tag);
+	ghosts[slot].tag = *tag;
+	ghosts[slot].valid = true;
+	ghosts[slot].hash_next = ghostBuckets[bucket];
+	ghostBuckets[bucket] = slot;
+	twoQ->a1out_size++;
+}
+
+// Look up a page in A1out. A ghost that is found is removed, as its page is resident again.
+bool ghost_remove(const BufferTag* tag) {
+	if (twoQ->a1out_capacity == 0) {
+		return false;
+	}
+
+	for (int32 slot = ghostBuckets[ghost_bucket_of(tag)]; slot != NIL_FRAME; slot = ghosts[slot].hash_next) {
+		if (BufferTagsEqual(&ghosts[slot].tag, tag)) {
+			ghost_unlink(slot);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Try to evict 'frame_id' from the tail end of A1in or Am. Called with twoQ_lock held exclusively, which the caller
+// keeps; the buffer header may be locked under it (an LWLock may be held across a buffer header lock, never the
+// other way round). The refcount is peeked at first, so a pinned frame costs no header lock. A fresh frame whose page
+// had a ghost in A1out was loaded again while remembered there, so it goes to the head of Am instead of being
+// evicted, and false is returned. Otherwise, if the frame is unpinned, the tag of a page leaving A1in goes to A1out
+// (read under the header lock, as only that keeps it stable), the frame becomes a fresh frame at the head of A1in,
+// and true is returned with the buffer header locked.
+bool claim_victim(int32 frame_id, uint32* buf_state) {
+	node* frame = &doubleLinkedList[frame_id];
+	BufferDesc* buf = GetBufferDescriptor(frame_id);
+	uint32 local_buf_state;
+
+	if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf->state)) != 0) {
+		return false;
+	}
+
+	local_buf_state = LockBufHdr(buf);
+
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0) {
+		UnlockBufHdr(buf, local_buf_state);
+		return false;
+	}
+
+	if (frame->fresh && (local_buf_state & BM_TAG_VALID) && ghost_remove(&buf->tag)) {
+		UnlockBufHdr(buf, local_buf_state);
+		unlink_frame(&twoQ->a1in, frame);
+		insert_at_head(&twoQ->am, frame);
+		return false;
+	}
+
+	if (frame->list == LIST_A1IN && (local_buf_state & BM_TAG_VALID)) {
+		ghost_insert(&buf->tag);
+	}
+
+	unlink_frame(list_of(frame), frame);
+	insert_at_head(&twoQ->a1in, frame);
+	frame->fresh = true;
+
+	*buf_state = local_buf_state;
+	return true;
+}
+
+// Called by StrategySyncVictims with twoQ_lock held in shared mode. Walks 'list_info' from '*frame_id' towards the
+// head and appends unpinned frames to 'buf_ids' until it holds 'max_buffers' of them. '*frame_id' is left where the
+// walk stopped, so that it can be resumed. Returns the new number of buffers in 'buf_ids'.
+int sync_victims_from(info* list_info, int32* frame_id, int* buf_ids, int num_buffers, int max_buffers) {
+	while (*frame_id != NIL_FRAME && num_buffers < max_buffers) {
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&GetBufferDescriptor(*frame_id)->state)) == 0) {
+			buf_ids[num_buffers++] = *frame_id;
+		}
+		*frame_id = doubleLinkedList[*frame_id].prev;
+	}
+
+	return num_buffers;
+}
+
+/*********************************************/
+
+
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/* Spinlock: protects the values below */
+	slock_t		buffer_strategy_lock;
+
+	/*
+	 * Clock sweep hand: index of next buffer to consider grabbing. Note that
+	 * this isn't a concrete buffer - we only ever increase the value. So, to
+	 * get an actual buffer, it needs to be used modulo NBuffers.
+	 */
+	pg_atomic_uint32 nextVictimBuffer;
+
+	int			firstFreeBuffer;	/* Head of list of unused buffers */
+	int			lastFreeBuffer; /* Tail of list of unused buffers */
+
+	/*
+	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
+	 * when the list is empty)
+	 */
+
+	/*
+	 * Statistics.  These counters should be wide enough that they can't
+	 * overflow during a single bgwriter cycle.
+	 */
+	uint32		completePasses; /* Complete cycles of the clock sweep */
+	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
+
+	/*
+	 * Bgworker process to be notified upon activity or -1 if none. See
+	 * StrategyNotifyBgWriter.
+	 */
+	int			bgwprocno;
+
+	/*
+	 * CS3223: LWLock tranche of twoQ_lock, so waits on it show up as
+	 * "2QList" in pg_stat_activity.
+	 */
+	int			listLockTrancheId;
+
+	/*
+	 * CS3223: Buffers recycled by BufferAccessStrategy rings, against
+	 * victims evicted from A1in or Am for a ring and for everybody else.
+	 * Freelist allocations are not counted.
+	 */
+	pg_atomic_uint64 ringReuses;
+	pg_atomic_uint64 ringEvictions;
+	pg_atomic_uint64 poolEvictions;
+} BufferStrategyControl;
+
+/* Pointers to shared state */
+static BufferStrategyControl *StrategyControl = NULL;
+
+/*
+ * Private (non-shared) state for managing a ring of shared buffers to re-use.
+ * This is currently the only kind of BufferAccessStrategy object, but someday
+ * we might have more kinds.
+ */
+typedef struct BufferAccessStrategyData
+{
+	/* Overall strategy type */
+	BufferAccessStrategyType btype;
+	/* Number of elements in buffers[] array */
+	int			nbuffers;
+
+	/*
+	 * Index of the "current" slot in the ring, ie, the one most recently
+	 * returned by GetBufferFromRing.
+	 */
+	int			current;
+
+	/*
+	 * Array of buffer numbers.  InvalidBuffer (that is, zero) indicates we
+	 * have not yet selected a buffer for this ring slot.  For allocation
+	 * simplicity this is palloc'd together with the fixed fields of the
+	 * struct.
+	 */
+	Buffer		buffers[FLEXIBLE_ARRAY_MEMBER];
+}			BufferAccessStrategyData;
+
+
+void StrategyAccessBuffer(int buf_id, bool delete); /* cs3223 */
+
+/* Prototypes for internal functions */
+static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
+									 uint32 *buf_state);
+static void AddBufferToRing(BufferAccessStrategy strategy,
+							BufferDesc *buf);
+
+/*
+ * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ *
+ * Move the clock hand one buffer ahead of its current position and return the
+ * id of the buffer now under the hand.
+ */
+static inline uint32
+ClockSweepTick(void)
+{
+	uint32		victim;
+
+	/*
+	 * Atomically move hand ahead one buffer - if there's several processes
+	 * doing this, this can lead to buffers being returned slightly out of
+	 * apparent order.
+	 */
+	victim =
+		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+
+	if (victim >= NBuffers)
+	{
+		uint32		originalVictim = victim;
+
+		/* always wrap what we look up in BufferDescriptors */
+		victim = victim % NBuffers;
+
+		/*
+		 * If we're the one that just caused a wraparound, force
+		 * completePasses to be incremented while holding the spinlock. We
+		 * need the spinlock so StrategySyncStart() can return a consistent
+		 * value consisting of nextVictimBuffer and completePasses.
+		 */
+		if (victim == 0)
+		{
+			uint32		expected;
+			uint32		wrapped;
+			bool		success = false;
+
+			expected = originalVictim + 1;
+
+			while (!success)
+			{
+				/*
+				 * Acquire the spinlock while increasing completePasses. That
+				 * allows other readers to read nextVictimBuffer and
+				 * completePasses in a consistent manner which is required for
+				 * StrategySyncStart().  In theory delaying the increment
+				 * could lead to an overflow of nextVictimBuffers, but that's
+				 * highly unlikely and wouldn't be particularly harmful.
+				 */
+				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+				wrapped = expected % NBuffers;
+
+				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+														 &expected, wrapped);
+				if (success)
+					StrategyControl->completePasses++;
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+			}
+		}
+	}
+	return victim;
+}
+
+/*
+ * have_free_buffer -- a lockless check to see if there is a free buffer in
+ *					   buffer pool.
+ *
+ * If the result is true that will become stale once free buffers are moved out
+ * by other operations, so the caller who strictly want to use a free buffer
+ * should not call this.
+ */
+bool
+have_free_buffer(void)
+{
+	if (StrategyControl->firstFreeBuffer >= 0)
+		return true;
+	else
+		return false;
+}
+
+
+
+// cs3223
+// StrategyAccessBuffer 
+// Called by bufmgr when a buffer page is accessed.
+// Applies the 2Q rules to buffer buf_id if delete is false; otherwise, removes buffer buf_id from A1in or Am.
+// Takes twoQ_lock, so the caller must not hold a buffer header lock or any other spinlock.
+void
+StrategyAccessBuffer(int buf_id, bool delete)
+{
+	node* frame = &doubleLinkedList[buf_id];
+	BufferDesc* buf = GetBufferDescriptor(buf_id);
+
+	// CS3223: Once its first reference has been looked up in A1out, a page in A1in is left alone until it is evicted
+	// (further references are correlated), and so is the page at the head of Am. The unlocked look is only a hint: at
+	// worst a reference is lost, or the lock is taken for nothing.
+	if (!delete) {
+		if (frame->list == LIST_A1IN && !frame->fresh) {
+			return;
+		}
+		if (frame->list == LIST_AM && INT_ACCESS_ONCE(twoQ->am.head) == buf_id) {
+			return;
+		}
+	}
+
+	LWLockAcquire(&twoQ->twoQ_lock, LW_EXCLUSIVE);
+
+	if (delete) {
+		if (frame->list != LIST_NONE) {
+			unlink_frame(list_of(frame), frame);
+		}
+	} else if (frame->list == LIST_AM) {
+		unlink_frame(&twoQ->am, frame);
+		insert_at_head(&twoQ->am, frame);
+	} else if (frame->list == LIST_A1IN) {
+		// First reference to the page since it was loaded. The caller has it pinned, so its tag is stable.
+		if (frame->fresh) {
+			frame->fresh = false;
+			if (ghost_remove(&buf->tag)) {
+				unlink_frame(&twoQ->a1in, frame);
+				insert_at_head(&twoQ->am, frame);
+			}
+		}
+	} else {
+		// Not in A1in or Am: a buffer just taken from the freelist
+		insert_at_head(&twoQ->a1in, frame);
+		frame->fresh = true;
+	}
+
+	LWLockRelease(&twoQ->twoQ_lock);
+}
+
+// CS3223 - StrategyAccessPinnedBuffer
+// Called by bufmgr in place of StrategyAccessBuffer for a hit on a buffer the backend already has pinned.
+// 2Q treats it as any other hit.
+void
+StrategyAccessPinnedBuffer(int buf_id)
+{
+	StrategyAccessBuffer(buf_id, false);
+}
+
+/*
+ * StrategyGetBuffer
+ *
+ *	Called by the bufmgr to get the next candidate buffer to use in
+ *	BufferAlloc(). The only hard requirement BufferAlloc() has is that
+ *	the selected buffer must not currently be pinned by anyone.
+ *
+ *	strategy is a BufferAccessStrategy object, or NULL for default strategy.
+ *
+ *	To ensure that no one else can pin the buffer before we do, we must
+ *	return the buffer with the buffer header spinlock still held.
+ */
+BufferDesc *
+StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_ring)
+{
+	BufferDesc *buf;
+	int			bgwprocno;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+	// CS3223
+	info* lists[2];
+	int32 traversal_frame_id;
+	int32 next_frame_id;
+
+	*from_ring = false;
+
+	/*
+	 * If given a strategy object, see whether it can select a buffer. We
+	 * assume strategy objects don't need buffer_strategy_lock.
+	 */
+
+	// CS3223: A recycled ring buffer stays wherever it is. Its new page has had no reference yet, and the ring's
+	// pages are evicted from A1in without reaching Am unless something else references them.
+	if (strategy != NULL)
+	{
+		buf = GetBufferFromRing(strategy, buf_state);
+		if (buf != NULL)
+		{
+			*from_ring = true;
+			pg_atomic_fetch_add_u64(&StrategyControl->ringReuses, 1);
+			return buf;
+		}
+	}
+
+	/*
+	 * If asked, we need to waken the bgwriter. Since we don't want to rely on
+	 * a spinlock for this we force a read from shared memory once, and then
+	 * set the latch based on that value. We need to go through that length
+	 * because otherwise bgwprocno might be reset while/after we check because
+	 * the compiler might just reread from memory.
+	 *
+	 * This can possibly set the latch of the wrong process if the bgwriter
+	 * dies in the wrong moment. But since PGPROC->procLatch is never
+	 * deallocated the worst consequence of that is that we set the latch of
+	 * some arbitrary process.
+	 */
+	bgwprocno = INT_ACCESS_ONCE(StrategyControl->bgwprocno);
+	if (bgwprocno != -1)
+	{
+		/* reset bgwprocno first, before setting the latch */
+		StrategyControl->bgwprocno = -1;
+
+		/*
+		 * Not acquiring ProcArrayLock here which is slightly icky. It's
+		 * actually fine because procLatch isn't ever freed, so we just can
+		 * potentially set the wrong process' (or no process') latch.
+		 */
+		SetLatch(&ProcGlobal->allProcs[bgwprocno].procLatch);
+	}
+
+	/*
+	 * We count buffer allocation requests so that the bgwriter can estimate
+	 * the rate of buffer consumption.  Note that buffers recycled by a
+	 * strategy object are intentionally not counted here.
+	 */
+	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
+
+	/*
+	 * First check, without acquiring the lock, whether there's buffers in the
+	 * freelist. Since we otherwise don't require the spinlock in every
+	 * StrategyGetBuffer() invocation, it'd be sad to acquire it here -
+	 * uselessly in most cases. That obviously leaves a race where a buffer is
+	 * put on the freelist but we don't see the store yet - but that's pretty
+	 * harmless, it'll just get used during the next buffer acquisition.
+	 *
+	 * If there's buffers on the freelist, acquire the spinlock to pop one
+	 * buffer of the freelist. Then check whether that buffer is usable and
+	 * repeat if not.
+	 *
+	 * Note that the freeNext fields are considered to be protected by the
+	 * buffer_strategy_lock not the individual buffer spinlocks, so it's OK to
+	 * manipulate them without holding the spinlock.
+	 */
+	if (StrategyControl->firstFreeBuffer >= 0)
+	{
+		while (true)
+		{
+			/* Acquire the spinlock to remove element from the freelist */
+			SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+			if (StrategyControl->firstFreeBuffer < 0)
+			{
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+				break;
+			}
+
+			buf = GetBufferDescriptor(StrategyControl->firstFreeBuffer);
+			Assert(buf->freeNext != FREENEXT_NOT_IN_LIST);
+
+			/* Unconditionally remove buffer from freelist */
+			StrategyControl->firstFreeBuffer = buf->freeNext;
+			buf->freeNext = FREENEXT_NOT_IN_LIST;
+
+			/*
+			 * Release the lock so someone else can access the freelist while
+			 * we check out this buffer.
+			 */
+			SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+			//CS3223: Add buffer to the head of A1in. This has to happen before the buffer header is locked, as
+			// twoQ_lock is an LWLock. If the buffer turns out to be unusable below, somebody is using it and it
+			// belongs in A1in anyway.
+			StrategyAccessBuffer(buf->buf_id, false);                      // Case 2
+
+			/*
+			 * If the buffer is pinned or has a nonzero usage_count, we cannot
+			 * use it; discard it and retry.  (This can only happen if VACUUM
+			 * put a valid buffer in the freelist and then someone else used
+			 * it before we got to it.  It's probably impossible altogether as
+			 * of 8.3, but we'd better check anyway.)
+			 */
+			local_buf_state = LockBufHdr(buf);
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+				&& BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
+			{
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				*buf_state = local_buf_state;
+				return buf;
+			}
+			UnlockBufHdr(buf, local_buf_state);
+		}
+	}
+
+	// CS3223: Counts evictions for the bgwriter's pacing, see StrategySyncStart
+	(void) ClockSweepTick();
+	pg_atomic_fetch_add_u64(strategy != NULL ? &StrategyControl->ringEvictions : &StrategyControl->poolEvictions, 1);
+
+	// Case 3
+	// CS3223: Evict from the tail of A1in while it holds more than Kin frames, or when Am is empty; from the tail of
+	// Am otherwise. If every frame of that list is pinned, fall back to the other one. The victim is moved to the
+	// head of A1in, as it is about to hold a newly loaded page. A fresh frame found in A1out moves to Am on the way (see
+	// claim_victim), so the walk remembers where to go next before trying a frame. twoQ_lock is held exclusively
+	// throughout, as the victim has to be relinked without letting go of its buffer header lock.
+	LWLockAcquire(&twoQ->twoQ_lock, LW_EXCLUSIVE);
+
+	if (twoQ->a1in.size > twoQ->a1in_target || twoQ->am.size == 0) {
+		lists[0] = &twoQ->a1in;
+		lists[1] = &twoQ->am;
+	} else {
+		lists[0] = &twoQ->am;
+		lists[1] = &twoQ->a1in;
+	}
+
+	for (int l = 0; l < 2; l++) {
+		for (traversal_frame_id = lists[l]->tail; traversal_frame_id != NIL_FRAME; traversal_frame_id = next_frame_id) {
+			next_frame_id = doubleLinkedList[traversal_frame_id].prev;
+			if (claim_victim(traversal_frame_id, buf_state)) {
+				LWLockRelease(&twoQ->twoQ_lock);
+
+				buf = GetBufferDescriptor(traversal_frame_id);
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				return buf;
+			}
+		}
+	}
+
+	LWLockRelease(&twoQ->twoQ_lock);
+
+	/*
+	 * We've scanned all the buffers without making any state changes, so
+	 * all the buffers are pinned (or were when we looked at them). We could
+	 * hope that someone will free one eventually, but it's probably better
+	 * to fail than to risk getting stuck in an infinite loop.
+	 */
+	elog(ERROR, "no unpinned buffers available");
+}
+
+/*
+ * StrategyFreeBuffer: put a buffer on the freelist
+ */
+void
+StrategyFreeBuffer(BufferDesc *buf)
+{
+	// Case 4
+	// CS3223: Unlink the frame before it becomes visible on the freelist. The list lock is an LWLock, which
+	// must not be taken while holding buffer_strategy_lock.
+	StrategyAccessBuffer(buf->buf_id, true);
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+	/*
+	 * It is possible that we are told to put something in the freelist that
+	 * is already in it; don't screw up the list if so.
+	 */
+	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
+	{
+		buf->freeNext = StrategyControl->firstFreeBuffer;
+		if (buf->freeNext < 0)
+			StrategyControl->lastFreeBuffer = buf->buf_id;
+		StrategyControl->firstFreeBuffer = buf->buf_id;
+	}
+
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+/*
+ * StrategySyncStart -- tell BufferSync where to start syncing
+ *
+ * The result is the buffer index of the best buffer to sync first.
+ * BufferSync() will proceed circularly around the buffer array from there.
+ *
+ * In addition, we return the completed-pass count (which is effectively
+ * the higher-order bits of nextVictimBuffer) and the count of recent buffer
+ * allocs if non-NULL pointers are passed.  The alloc count is reset after
+ * being read.
+ *
+ * CS3223: Here the clock hand only counts evictions from the list (see
+ * StrategyGetBuffer), so the result and pass count tell the bgwriter how
+ * far eviction has got but not which buffers come next; BgBufferSync gets
+ * those from StrategySyncVictims.
+ */
+int
+StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
+{
+	uint32		nextVictimBuffer;
+	int			result;
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
+	result = nextVictimBuffer % NBuffers;
+
+	if (complete_passes)
+	{
+		*complete_passes = StrategyControl->completePasses;
+
+		/*
+		 * Additionally add the number of wraparounds that happened before
+		 * completePasses could be incremented. C.f. ClockSweepTick().
+		 */
+		*complete_passes += nextVictimBuffer / NBuffers;
+	}
+
+	if (num_buf_alloc)
+	{
+		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
+	}
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+	return result;
+}
+
+
+// CS3223: No victim queue (see freelist_lru.c), the victims are at the tails of A1in and Am already
+void StrategyRefillVictimQueue(void) {
+}
+
+// CS3223: See StrategySyncVictims in freelist_lru.c. The order is the frames A1in holds beyond Kin, then Am, then the
+// rest of A1in, all from the tail.
+int StrategySyncVictims(int* buf_ids, int max_buffers) {
+	int num_buffers = 0;
+	int32 a1in_frame_id;
+	int32 am_frame_id;
+
+	if (max_buffers <= 0) {
+		return 0;
+	}
+
+	LWLockAcquire(&twoQ->twoQ_lock, LW_SHARED);
+
+	a1in_frame_id = twoQ->a1in.tail;
+	am_frame_id = twoQ->am.tail;
+
+	num_buffers = sync_victims_from(&twoQ->a1in, &a1in_frame_id, buf_ids, num_buffers,
+									Min(max_buffers, Max(twoQ->a1in.size - twoQ->a1in_target, 0)));
+	num_buffers = sync_victims_from(&twoQ->am, &am_frame_id, buf_ids, num_buffers, max_buffers);
+	num_buffers = sync_victims_from(&twoQ->a1in, &a1in_frame_id, buf_ids, num_buffers, max_buffers);
+
+	LWLockRelease(&twoQ->twoQ_lock);
+
+	return num_buffers;
+}
+
+// CS3223: 2Q does no dirty look-ahead, see lru_dirty_lookahead
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions) {
+	*clean_substitutions = 0;
+	*dirty_evictions = 0;
+}
+
+// CS3223: Ring reuse against main pool evictions, see StrategyRingStats in freelist_lru.c
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions) {
+	*ring_reuses = pg_atomic_read_u64(&StrategyControl->ringReuses);
+	*ring_evictions = pg_atomic_read_u64(&StrategyControl->ringEvictions);
+	*pool_evictions = pg_atomic_read_u64(&StrategyControl->poolEvictions);
+}
+
+// CS3223: 2Q has no admission filter, see lru_admission_filter
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections) {
+	*admissions = 0;
+	*rejections = 0;
+}
+
+/*
+ * StrategyNotifyBgWriter -- set or clear allocation notification latch
+ *
+ * If bgwprocno isn't -1, the next invocation of StrategyGetBuffer will
+ * set that latch.  Pass -1 to clear the pending notification before it
+ * happens.  This feature is used by the bgwriter process to wake itself up
+ * from hibernation, and is not meant for anybody else to use.
+ */
+void
+StrategyNotifyBgWriter(int bgwprocno)
+{
+	/*
+	 * We acquire buffer_strategy_lock just to ensure that the store appears
+	 * atomic to StrategyGetBuffer.  The bgwriter should call this rather
+	 * infrequently, so there's no performance penalty from being safe.
+	 */
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	StrategyControl->bgwprocno = bgwprocno;
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+
+/*
+ * StrategyShmemSize
+ *
+ * estimate the size of shared memory used by the freelist-related structures.
+ *
+ * Note: for somewhat historical reasons, the buffer lookup hashtable size
+ * is also determined here.
+ */
+Size
+StrategyShmemSize(void)
+{
+	Size		size = 0;
+
+	/* size of lookup hash table ... see comment in StrategyInitialize */
+	size = add_size(size, BufTableShmemSize(NBuffers + NUM_BUFFER_PARTITIONS));
+
+	/* size of the shared replacement strategy control block */
+	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
+
+	// CS3223: Allocate size for our data structures in FREE-LIST, one node per buffer
+	size = add_size(size, mul_size(sizeof(node), NBuffers));
+
+	// Control information of A1in, Am and A1out
+	size = add_size(size, sizeof(twoq_info));
+
+	// A1out ghost slots and hash buckets
+	size = add_size(size, mul_size(sizeof(ghost_entry), twoq_a1out_capacity()));
+	size = add_size(size, mul_size(sizeof(int32), twoq_num_buckets(twoq_a1out_capacity())));
+
+	return size;
+}
+
+/*
+ * StrategyInitialize -- initialize the buffer cache replacement
+ *		strategy.
+ *
+ * Assumes: All of the buffers are already built into a linked list.
+ *		Only called by postmaster and only during initialization.
+ */
+void
+StrategyInitialize(bool init)
+{
+	bool		found;
+
+	// CS3223: Boolean values for if shared memory alloc is successful
+	bool is_dll_success = false;
+	bool is_twoq_success = false;
+	bool is_ghosts_success = false;
+	bool is_ghost_buckets_success = false;
+
+	// twoq_a1out_percent is PGC_POSTMASTER, so every backend arrives at the same A1out size
+	int a1out_capacity = twoq_a1out_capacity();
+	uint32 num_buckets = twoq_num_buckets(a1out_capacity);
+
+	/*
+	 * Initialize the shared buffer lookup hashtable.
+	 *
+	 * Since we can't tolerate running out of lookup table entries, we must be
+	 * sure to specify an adequate table size here.  The maximum steady-state
+	 * usage is of course NBuffers entries, but BufferAlloc() tries to insert
+	 * a new entry before deleting the old.  In principle this could be
+	 * happening in each partition concurrently, so we could need as many as
+	 * NBuffers + NUM_BUFFER_PARTITIONS entries.
+	 */
+	InitBufTable(NBuffers + NUM_BUFFER_PARTITIONS);
+
+	/*
+	 * Get or create the shared strategy control block
+	 */
+	StrategyControl = (BufferStrategyControl *)
+		ShmemInitStruct("Buffer Strategy Status",
+						sizeof(BufferStrategyControl),
+						&found);
+
+
+	// CS3223: Initialize space for our data structures
+	twoQ = (twoq_info *)ShmemInitStruct("2Q Info", sizeof(twoq_info), &is_twoq_success);
+
+	// Double Linked List itself
+	doubleLinkedList = (node *)ShmemInitStruct("Double Link List",
+														mul_size(sizeof(node), NBuffers),
+														&is_dll_success);
+
+	// A1out
+	ghosts = (ghost_entry *)ShmemInitStruct("2Q A1out",
+											mul_size(sizeof(ghost_entry), a1out_capacity),
+											&is_ghosts_success);
+	ghostBuckets = (int32 *)ShmemInitStruct("2Q A1out Buckets",
+											mul_size(sizeof(int32), num_buckets),
+											&is_ghost_buckets_success);
+
+	if (!found)
+	{
+		/*
+		 * Only done once, usually in postmaster
+		 */
+		Assert(init);
+
+		SpinLockInit(&StrategyControl->buffer_strategy_lock);
+
+		/*
+		 * Grab the whole linked list of free buffers for our strategy. We
+		 * assume it was previously set up by InitBufferPool().
+		 */
+		StrategyControl->firstFreeBuffer = 0;
+		StrategyControl->lastFreeBuffer = NBuffers - 1;
+
+		/* Initialize the clock sweep pointer */
+		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+
+		/* Clear statistics */
+		StrategyControl->completePasses = 0;
+		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
+
+		/* No pending notification */
+		StrategyControl->bgwprocno = -1;
+
+		/* CS3223: Clear ring statistics */
+		pg_atomic_init_u64(&StrategyControl->ringReuses, 0);
+		pg_atomic_init_u64(&StrategyControl->ringEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->poolEvictions, 0);
+
+		/* CS3223: Tranche of twoQ_lock */
+		StrategyControl->listLockTrancheId = LWLockNewTrancheId();
+	}
+	else
+		Assert(!init);
+
+	// CS3223: Tranche names are backend-local, so every backend registers it
+	LWLockRegisterTranche(StrategyControl->listLockTrancheId, "2QList");
+
+	// CS3223: A1in and Am start empty, and every node unlinked
+	if (!is_dll_success && !is_twoq_success) {
+		Assert (init);
+		LWLockInitialize(&twoQ->twoQ_lock, StrategyControl->listLockTrancheId);
+
+		twoQ->a1in.head = NIL_FRAME;
+		twoQ->a1in.tail = NIL_FRAME;
+		twoQ->a1in.size = 0;
+		twoQ->am.head = NIL_FRAME;
+		twoQ->am.tail = NIL_FRAME;
+		twoQ->am.size = 0;
+
+		// twoq_a1in_percent is PGC_POSTMASTER as well
+		twoQ->a1in_target = twoq_a1in_target();
+
+		// An all-zero node is a valid unlinked node (list is LIST_NONE, prev/next are only read while linked)
+		memset(doubleLinkedList, 0, mul_size(sizeof(node), NBuffers));
+	} else
+		Assert(!init);
+
+	// CS3223: A1out starts empty
+	if (!is_ghosts_success && !is_ghost_buckets_success) {
+		Assert (init);
+		twoQ->a1out_capacity = a1out_capacity;
+		twoQ->a1out_next = 0;
+		twoQ->a1out_size = 0;
+		twoQ->num_buckets = num_buckets;
+
+		for (int i = 0; i < a1out_capacity; i++) {
+			ghosts[i].valid = false;
+			ghosts[i].hash_next = NIL_FRAME;
+		}
+		for (uint32 b = 0; b < num_buckets; b++) {
+			ghostBuckets[b] = NIL_FRAME;
+		}
+	} else
+		Assert(!init);
+}
+
+/* ----------------------------------------------------------------
+ *				Backend-private buffer ring management
+ * ----------------------------------------------------------------
+ */
+
+
+/*
+ * GetAccessStrategy -- create a BufferAccessStrategy object
+ *
+ * The object is allocated in the current memory context.
+ */
+BufferAccessStrategy
+GetAccessStrategy(BufferAccessStrategyType btype)
+{
+	int			ring_size_kb;
+
+	/*
+	 * Select ring size to use.  See buffer/README for rationales.
+	 *
+	 * Note: if you change the ring size for BAS_BULKREAD, see also
+	 * SYNC_SCAN_REPORT_INTERVAL in access/heap/syncscan.c.
+	 */
+	switch (btype)
+	{
+		case BAS_NORMAL:
+			/* if someone asks for NORMAL, just give 'em a "default" object */
+			return NULL;
+
+		case BAS_BULKREAD:
+			ring_size_kb = 256;
+			break;
+		case BAS_BULKWRITE:
+			ring_size_kb = 16 * 1024;
+			break;
+		case BAS_VACUUM:
+			ring_size_kb = 256;
+			break;
+
+		default:
+			elog(ERROR, "unrecognized buffer access strategy: %d",
+				 (int) btype);
+			return NULL;		/* keep compiler quiet */
+	}
+
+	return GetAccessStrategyWithSize(btype, ring_size_kb);
+}
+
+/*
+ * GetAccessStrategyWithSize -- create a BufferAccessStrategy object with a
+ *		number of buffers equivalent to the passed in size.
+ *
+ * If the given ring size is 0, no BufferAccessStrategy will be created and
+ * the function will return NULL.  ring_size_kb must not be negative.
+ */
+BufferAccessStrategy
+GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb)
+{
+	int			ring_buffers;
+	BufferAccessStrategy strategy;
+
+	Assert(ring_size_kb >= 0);
+
+	/* Figure out how many buffers ring_size_kb is */
+	ring_buffers = ring_size_kb / (BLCKSZ / 1024);
+
+	/* 0 means unlimited, so no BufferAccessStrategy required */
+	if (ring_buffers == 0)
+		return NULL;
+
+	/* Cap to 1/8th of shared_buffers */
+	ring_buffers = Min(NBuffers / 8, ring_buffers);
+
+	/* NBuffers should never be less than 16, so this shouldn't happen */
+	Assert(ring_buffers > 0);
+
+	/* Allocate the object and initialize all elements to zeroes */
+	strategy = (BufferAccessStrategy)
+		palloc0(offsetof(BufferAccessStrategyData, buffers) +
+				ring_buffers * sizeof(Buffer));
+
+	/* Set fields that don't start out zero */
+	strategy->btype = btype;
+	strategy->nbuffers = ring_buffers;
+
+	return strategy;
+}
+
+/*
+ * GetAccessStrategyBufferCount -- an accessor for the number of buffers in
+ *		the ring
+ *
+ * Returns 0 on NULL input to match behavior of GetAccessStrategyWithSize()
+ * returning NULL with 0 size.
+ */
+int
+GetAccessStrategyBufferCount(BufferAccessStrategy strategy)
+{
+	if (strategy == NULL)
+		return 0;
+
+	return strategy->nbuffers;
+}
+
+/*
+ * FreeAccessStrategy -- release a BufferAccessStrategy object
+ *
+ * A simple pfree would do at the moment, but we would prefer that callers
+ * don't assume that much about the representation of BufferAccessStrategy.
+ */
+void
+FreeAccessStrategy(BufferAccessStrategy strategy)
+{
+	/* don't crash if called on a "default" strategy */
+	if (strategy != NULL)
+		pfree(strategy);
+}
+
+/*
+ * GetBufferFromRing -- returns a buffer from the ring, or NULL if the
+ *		ring is empty / not usable.
+ *
+ * The bufhdr spin lock is held on the returned buffer.
+ */
+static BufferDesc *
+GetBufferFromRing(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	Buffer		bufnum;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+
+	/* Advance to next ring slot */
+	if (++strategy->current >= strategy->nbuffers)
+		strategy->current = 0;
+
+	/*
+	 * If the slot hasn't been filled yet, tell the caller to allocate a new
+	 * buffer with the normal allocation strategy.  He will then fill this
+	 * slot by calling AddBufferToRing with the new buffer.
+	 */
+	bufnum = strategy->buffers[strategy->current];
+	if (bufnum == InvalidBuffer)
+		return NULL;
+
+	/*
+	 * If the buffer is pinned we cannot use it under any circumstances.
+	 *
+	 * If usage_count is 0 or 1 then the buffer is fair game (we expect 1,
+	 * since our own previous usage of the ring element would have left it
+	 * there, but it might've been decremented by clock sweep since then). A
+	 * higher usage_count indicates someone else has touched the buffer, so we
+	 * shouldn't re-use it.
+	 */
+	buf = GetBufferDescriptor(bufnum - 1);
+	local_buf_state = LockBufHdr(buf);
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+		&& BUF_STATE_GET_USAGECOUNT(local_buf_state) <= 1)
+	{
+		*buf_state = local_buf_state;
+		return buf;
+	}
+	UnlockBufHdr(buf, local_buf_state);
+
+	/*
+	 * Tell caller to allocate a new buffer with the normal allocation
+	 * strategy.  He'll then replace this ring element via AddBufferToRing.
+	 */
+	return NULL;
+}
+
+/*
+ * AddBufferToRing -- add a buffer to the buffer ring
+ *
+ * Caller must hold the buffer header spinlock on the buffer.  Since this
+ * is called with the spinlock held, it had better be quite cheap.
+ */
+static void
+AddBufferToRing(BufferAccessStrategy strategy, BufferDesc *buf)
+{
+	strategy->buffers[strategy->current] = BufferDescriptorGetBuffer(buf);
+}
+
+/*
+ * Utility function returning the IOContext of a given BufferAccessStrategy's
+ * strategy ring.
+ */
+IOContext
+IOContextForStrategy(BufferAccessStrategy strategy)
+{
+	if (!strategy)
+		return IOCONTEXT_NORMAL;
+
+	switch (strategy->btype)
+	{
+		case BAS_NORMAL:
+
+			/*
+			 * Currently, GetAccessStrategy() returns NULL for
+			 * BufferAccessStrategyType BAS_NORMAL, so this case is
+			 * unreachable.
+			 */
+			pg_unreachable();
+			return IOCONTEXT_NORMAL;
+		case BAS_BULKREAD:
+			return IOCONTEXT_BULKREAD;
+		case BAS_BULKWRITE:
+			return IOCONTEXT_BULKWRITE;
+		case BAS_VACUUM:
+			return IOCONTEXT_VACUUM;
+	}
+
+	elog(ERROR, "unrecognized BufferAccessStrategyType: %d", strategy->btype);
+	pg_unreachable();
+}
+
+/*
+ * StrategyRejectBuffer -- consider rejecting a dirty buffer
+ *
+ * When a nondefault strategy is used, the buffer manager calls this function
+ * when it turns out that the buffer selected by StrategyGetBuffer needs to
+ * be written out and doing so would require flushing WAL too.  This gives us
+ * a chance to choose a different victim.
+ *
+ * Returns true if buffer manager should ask for a new victim, and false
+ * if this buffer should be written and re-used.
+ */
+bool
+StrategyRejectBuffer(BufferAccessStrategy strategy, BufferDesc *buf, bool from_ring)
+{
+	/* We only do this in bulkread mode */
+	if (strategy->btype != BAS_BULKREAD)
+		return false;
+
+	/* Don't muck with behavior of normal buffer-replacement strategy */
+	if (!from_ring ||
+		strategy->buffers[strategy->current] != BufferDescriptorGetBuffer(buf))
+		return false;
+
+	/*
+	 * Remove the dirty buffer from the ring; necessary to prevent infinite
+	 * loop if all ring members are dirty.
+	 */
+	strategy->buffers[strategy->current] = InvalidBuffer;
+
+	return true;
+}
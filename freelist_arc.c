@@ -0,0 +1,1344 @@
+/*-------------------------------------------------------------------------
+ *
+ * freelist.c
+ *	  routines for managing the buffer pool's replacement strategy.
+ *
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/freelist.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "port/pg_bitutils.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/proc.h"
+
+#include <assert.h>
+
+#define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
+
+/*********************************************/
+// CS3223 - Data Structure declarations
+
+// ARC (Megiddo & Modha) keeps every resident frame in one of two LRU lists:
+//   T1 - pages referenced once since they were loaded
+//   T2 - pages referenced at least twice
+// and the tags of recently evicted pages in two ghost lists that hold no frames:
+//   B1 - pages evicted from T1
+//   B2 - pages evicted from T2
+// Victims come from the tail of T1 while T1 holds more than p frames, from the tail of T2 otherwise. The target p
+// adapts to the workload: a page found in B1 would still be resident had T1 been larger, so p grows, and a page found
+// in B2 makes it shrink. A recency-heavy workload thus moves p towards NBuffers and a frequency-heavy one towards 0,
+// with no knob to set. T1 plus B1 never hold more than NBuffers pages, nor do all four lists more than 2 * NBuffers.
+//
+// StrategyGetBuffer does not know which page the victim will hold, so a newly loaded page always enters T1 (as a
+// fresh frame), and B1/B2 are looked up on its first re-reference, or when it comes up for eviction if it has none,
+// instead of when it is loaded. Either way, the page then moves to T2.
+
+// List membership tag for every node and ghost, so either can be found in O(1)
+#define LIST_NONE 0
+#define LIST_T1 1
+#define LIST_T2 2
+#define LIST_B1 3
+#define LIST_B2 4
+
+// Nodes are linked by buf_id (32 bits) instead of by pointer, ghosts by slot. NIL_FRAME ends both.
+#define NIL_FRAME (-1)
+#define FRAME_ID(frame) ((int32) ((frame) - doubleLinkedList))
+
+typedef struct node {
+	int32 prev;                        // buf_id of the previous node, or NIL_FRAME
+	int32 next;                        // buf_id of the next node, or NIL_FRAME
+	uint8 list;                        // LIST_NONE, LIST_T1 or LIST_T2
+	bool fresh;                        // In T1 and not referenced since its page was loaded
+} node;
+
+typedef struct info {
+	int32 head;                        // buf_id (T1, T2) or slot (B1, B2) of the most recently used entry
+	int32 tail;                        // Least recently used entry, or NIL_FRAME
+	int size;
+} info;
+
+// B1 and B2 entry. A ghost is in B1, in B2 or on the free slot list, and is also chained by hash of its tag while it
+// is in B1 or B2, so a lookup is O(1).
+typedef struct ghost_entry {
+	BufferTag tag;
+	int32 prev;                        // Slot of the previous ghost in B1 or B2, or NIL_FRAME
+	int32 next;                        // Slot of the next ghost in B1 or B2 or on the free slot list, or NIL_FRAME
+	int32 hash_next;                   // Slot of the next ghost in the same hash bucket, or NIL_FRAME
+	uint8 list;                        // LIST_NONE (free), LIST_B1 or LIST_B2
+} ghost_entry;
+
+typedef struct arc_info {
+	info t1;
+	info t2;
+	info b1;
+	info b2;
+	int p;                             // Target size of T1, between 0 and NBuffers
+	int32 free_ghost;                  // Head of the free slot list
+	uint32 num_buckets;                // Power of two, at least NBuffers
+	LWLock arc_lock;                   // Exclusive to change any list or p, shared to walk T1 or T2
+} arc_info;
+
+static node* doubleLinkedList = NULL;         // Indexed by buf_id, NBuffers nodes shared by T1 and T2
+static arc_info* arc = NULL;
+static ghost_entry* ghosts = NULL;            // B1 and B2, NBuffers slots
+static int32* ghostBuckets = NULL;            // num_buckets heads of slot chains
+
+uint32 arc_num_buckets(void);
+void unlink_frame(info* list_info, node* frame);
+void insert_at_head(info* list_info, node* frame);
+info* list_of(node* frame);
+uint32 ghost_bucket_of(const BufferTag* tag);
+void ghost_remove(int32 slot);
+void ghost_insert(info* list_info, const BufferTag* tag);
+int32 ghost_lookup(const BufferTag* tag);
+void adapt_target(int32 slot);
+void trim_b1(void);
+bool claim_victim(int32 frame_id, uint32* buf_state);
+bool evict_from_t1(void);
+int sync_victims_from(info* list_info, int32* frame_id, int* buf_ids, int num_buffers, int max_buffers);
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions);
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions);
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections);
+void StrategyArcTarget(int* p, int* t1_size, int* t2_size, int* b1_size, int* b2_size);
+
+/*********************************************/
+// CS3223 - Function definitions
+
+uint32 arc_num_buckets(void) {
+	return pg_nextpower2_32((uint32) Max(NBuffers, 1));
+}
+
+// Unlink a frame from T1 or T2 in O(1)
+void unlink_frame(info* list_info, node* frame) {
+	if (frame->prev != NIL_FRAME) {
+		doubleLinkedList[frame->prev].next = frame->next;
+	} else {
+		list_info->head = frame->next;
+	}
+
+	if (frame->next != NIL_FRAME) {
+		doubleLinkedList[frame->next].prev = frame->prev;
+	} else {
+		list_info->tail = frame->prev;
+	}
+
+	frame->prev = NIL_FRAME;
+	frame->next = NIL_FRAME;
+	frame->list = LIST_NONE;
+	frame->fresh = false;
+	list_info->size--;
+}
+
+// Link a frame (which must not be in T1 or T2) at the head of T1 or T2
+void insert_at_head(info* list_info, node* frame) {
+	Assert(frame->list == LIST_NONE);
+
+	frame->prev = NIL_FRAME;
+	frame->next = list_info->head;
+	if (list_info->head != NIL_FRAME) { // Check if list is not empty
+		doubleLinkedList[list_info->head].prev = FRAME_ID(frame);
+	}
+	list_info->head = FRAME_ID(frame);
+
+	if (list_info->tail == NIL_FRAME) { // If list was empty, update tail as well
+		list_info->tail = FRAME_ID(frame);
+	}
+
+	frame->list = (list_info == &arc->t1) ? LIST_T1 : LIST_T2;
+	list_info->size++;
+}
+
+info* list_of(node* frame) {
+	return (frame->list == LIST_T1) ? &arc->t1 : &arc->t2;
+}
+
+// B1 and B2 - Function definitions. All of them are called with arc_lock held exclusively.
+
+uint32 ghost_bucket_of(const BufferTag* tag) {
+	return BufTableHashCode((BufferTag*) tag) & (arc->num_buckets - 1);
+}
+
+// Take the ghost in 'slot' off B1 or B2 and its hash chain, and put the slot on the free slot list. Chains are about
+// one ghost long, as there are at least as many buckets as slots.
+void ghost_remove(int32 slot) {
+	ghost_entry* ghost = &ghosts[slot];
+	info* list_info = (ghost->list == LIST_B1) ? &arc->b1 : &arc->b2;
+	int32* link = &ghostBuckets[ghost_bucket_of(&ghost->tag)];
+
+	Assert(ghost->list == LIST_B1 || ghost->list == LIST_B2);
+
+	while (*link != slot) {
+		Assert(*link != NIL_FRAME);
+		link = &ghosts[*link].hash_next;
+	}
+	*link = ghost->hash_next;
+
+	if (ghost->prev != NIL_FRAME) {
+		ghosts[ghost->prev].next = ghost->next;
+	} else {
+		list_info->head = ghost->next;
+	}
+
+	if (ghost->next != NIL_FRAME) {
+		ghosts[ghost->next].prev = ghost->prev;
+	} else {
+		list_info->tail = ghost->prev;
+	}
+	list_info->size--;
+
+	ghost->list = LIST_NONE;
+	ghost->prev = NIL_FRAME;
+	ghost->hash_next = NIL_FRAME;
+	ghost->next = arc->free_ghost;
+	arc->free_ghost = slot;
+}
+
+// Remember the tag of a page evicted from T1 (in B1) or T2 (in B2), at the head of the ghost list. The page may
+// already have a ghost, if it was loaded again and evicted before its first reference; that ghost is dropped in favour
+// of the new one. If every slot is taken, the oldest ghost of B2 (or of B1, if B2 is empty) makes room.
+void ghost_insert(info* list_info, const BufferTag* tag) {
+	int32 slot = ghost_lookup(tag);
+	ghost_entry* ghost;
+	uint32 bucket;
+
+	if (slot != NIL_FRAME) {
+		ghost_remove(slot);
+	}
+
+	if (arc->free_ghost == NIL_FRAME) {
+		ghost_remove(arc->b2.size > 0 ? arc->b2.tail : arc->b1.tail);
+	}
+
+	slot = arc->free_ghost;
+	ghost = &ghosts[slot];
+	arc->free_ghost = ghost->next;
+
+	bucket = ghost_bucket_of(tag);
+	ghost->tag = *tag;
+	ghost->hash_next = ghostBuckets[bucket];
+	ghostBuckets[bucket] = slot;
+
+	ghost->prev = NIL_FRAME;
+	ghost->next = list_info->head;
+	if (list_info->head != NIL_FRAME) {
+		ghosts[list_info->head].prev = slot;
+	}
+	list_info->head = slot;
+	if (list_info->tail == NIL_FRAME) {
+		list_info->tail = slot;
+	}
+	ghost->list = (list_info == &arc->b1) ? LIST_B1 : LIST_B2;
+	list_info->size++;
+}
+
+// Returns the slot of the ghost of 'tag' in B1 or B2, or NIL_FRAME
+int32 ghost_lookup(const BufferTag* tag) {
+	for (int32 slot = ghostBuckets[ghost_bucket_of(tag)]; slot != NIL_FRAME; slot = ghosts[slot].hash_next) {
+		if (BufferTagsEqual(&ghosts[slot].tag, tag)) {
+			return slot;
+		}
+	}
+
+	return NIL_FRAME;
+}
+
+// A page was referenced again while its ghost was in B1 or B2. Moves p towards the list that would have kept it
+// resident, by more the smaller that ghost list is compared with the other one.
+void adapt_target(int32 slot) {
+	if (ghosts[slot].list == LIST_B1) {
+		arc->p = Min(arc->p + Max(arc->b2.size / arc->b1.size, 1), NBuffers);
+	} else {
+		arc->p = Max(arc->p - Max(arc->b1.size / arc->b2.size, 1), 0);
+	}
+}
+
+// T1 has grown: drop the oldest ghosts of B1 until T1 and B1 together hold no more than NBuffers pages again
+void trim_b1(void) {
+	while (arc->b1.size > 0 && arc->t1.size + arc->b1.size > NBuffers) {
+		ghost_remove(arc->b1.tail);
+	}
+}
+
+// Try to evict 'frame_id' from the tail end of T1 or T2. Called with arc_lock held exclusively, which the caller keeps;
+// the buffer header may be locked under it (an LWLock may be held across a buffer header lock, never the other way
+// round). The refcount is peeked at first, so a pinned frame costs no header lock. A fresh frame whose page had a
+// ghost was loaded on a ghost hit, so p adapts and the frame goes to the head of T2 instead of being evicted, and
+// false is returned. Otherwise, if the frame is unpinned, the tag of its page goes to B1 or B2 (read under the header
+// lock, as only that keeps it stable), the frame becomes a fresh frame at the head of T1, and true is returned with
+// the buffer header locked.
+bool claim_victim(int32 frame_id, uint32* buf_state) {
+	node* frame = &doubleLinkedList[frame_id];
+	BufferDesc* buf = GetBufferDescriptor(frame_id);
+	uint32 local_buf_state;
+	info* list_info;
+	int32 slot;
+
+	if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf->state)) != 0) {
+		return false;
+	}
+
+	local_buf_state = LockBufHdr(buf);
+
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0) {
+		UnlockBufHdr(buf, local_buf_state);
+		return false;
+	}
+
+	if (frame->fresh && (local_buf_state & BM_TAG_VALID)) {
+		slot = ghost_lookup(&buf->tag);
+		if (slot != NIL_FRAME) {
+			UnlockBufHdr(buf, local_buf_state);
+			adapt_target(slot);
+			ghost_remove(slot);
+			unlink_frame(&arc->t1, frame);
+			insert_at_head(&arc->t2, frame);
+			return false;
+		}
+	}
+
+	list_info = list_of(frame);
+	unlink_frame(list_info, frame);
+	insert_at_head(&arc->t1, frame);
+	frame->fresh = true;
+
+	if (local_buf_state & BM_TAG_VALID) {
+		ghost_insert((list_info == &arc->t1) ? &arc->b1 : &arc->b2, &buf->tag);
+	}
+	trim_b1();
+
+	*buf_state = local_buf_state;
+	return true;
+}
+
+// ARC's REPLACE: evict from T1 while it holds more than p frames (or T2 is empty), from T2 otherwise. Called with
+// arc_lock held.
+bool evict_from_t1(void) {
+	return arc->t1.size > arc->p || arc->t2.size == 0;
+}
+
+// Called by StrategySyncVictims with arc_lock held in shared mode. Walks 'list_info' from '*frame_id' towards the
+// head and appends unpinned frames to 'buf_ids' until it holds 'max_buffers' of them. '*frame_id' is left where the
+// walk stopped, so that it can be resumed. Returns the new number of buffers in 'buf_ids'.
+int sync_victims_from(info* list_info, int32* frame_id, int* buf_ids, int num_buffers, int max_buffers) {
+	while (*frame_id != NIL_FRAME && num_buffers < max_buffers) {
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&GetBufferDescriptor(*frame_id)->state)) == 0) {
+			buf_ids[num_buffers++] = *frame_id;
+		}
+		*frame_id = doubleLinkedList[*frame_id].prev;
+	}
+
+	return num_buffers;
+}
+
+/*********************************************/
+
+
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/* Spinlock: protects the values below */
+	slock_t		buffer_strategy_lock;
+
+	/*
+	 * Clock sweep hand: index of next buffer to consider grabbing. Note that
+	 * this isn't a concrete buffer - we only ever increase the value. So, to
+	 * get an actual buffer, it needs to be used modulo NBuffers.
+	 */
+	pg_atomic_uint32 nextVictimBuffer;
+
+	int			firstFreeBuffer;	/* Head of list of unused buffers */
+	int			lastFreeBuffer; /* Tail of list of unused buffers */
+
+	/*
+	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
+	 * when the list is empty)
+	 */
+
+	/*
+	 * Statistics.  These counters should be wide enough that they can't
+	 * overflow during a single bgwriter cycle.
+	 */
+	uint32		completePasses; /* Complete cycles of the clock sweep */
+	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
+
+	/*
+	 * Bgworker process to be notified upon activity or -1 if none. See
+	 * StrategyNotifyBgWriter.
+	 */
+	int			bgwprocno;
+
+	/*
+	 * CS3223: LWLock tranche of arc_lock, so waits on it show up as
+	 * "ARCList" in pg_stat_activity.
+	 */
+	int			listLockTrancheId;
+
+	/*
+	 * CS3223: Buffers recycled by BufferAccessStrategy rings, against
+	 * victims evicted from T1 or T2 for a ring and for everybody else.
+	 * Freelist allocations are not counted.
+	 */
+	pg_atomic_uint64 ringReuses;
+	pg_atomic_uint64 ringEvictions;
+	pg_atomic_uint64 poolEvictions;
+} BufferStrategyControl;
+
+/* Pointers to shared state */
+static BufferStrategyControl *StrategyControl = NULL;
+
+/*
+ * Private (non-shared) state for managing a ring of shared buffers to re-use.
+ * This is currently the only kind of BufferAccessStrategy object, but someday
+ * we might have more kinds.
+ */
+typedef struct BufferAccessStrategyData
+{
+	/* Overall strategy type */
+	BufferAccessStrategyType btype;
+	/* Number of elements in buffers[] array */
+	int			nbuffers;
+
+	/*
+	 * Index of the "current" slot in the ring, ie, the one most recently
+	 * returned by GetBufferFromRing.
+	 */
+	int			current;
+
+	/*
+	 * Array of buffer numbers.  InvalidBuffer (that is, zero) indicates we
+	 * have not yet selected a buffer for this ring slot.  For allocation
+	 * simplicity this is palloc'd together with the fixed fields of the
+	 * struct.
+	 */
+	Buffer		buffers[FLEXIBLE_ARRAY_MEMBER];
+}			BufferAccessStrategyData;
+
+
+void StrategyAccessBuffer(int buf_id, bool delete); /* cs3223 */
+
+/* Prototypes for internal functions */
+static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
+									 uint32 *buf_state);
+static void AddBufferToRing(BufferAccessStrategy strategy,
+							BufferDesc *buf);
+
+/*
+ * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ *
+ * Move the clock hand one buffer ahead of its current position and return the
+ * id of the buffer now under the hand.
+ */
+static inline uint32
+ClockSweepTick(void)
+{
+	uint32		victim;
+
+	/*
+	 * Atomically move hand ahead one buffer - if there's several processes
+	 * doing this, this can lead to buffers being returned slightly out of
+	 * apparent order.
+	 */
+	victim =
+		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+
+	if (victim >= NBuffers)
+	{
+		uint32		originalVictim = victim;
+
+		/* always wrap what we look up in BufferDescriptors */
+		victim = victim % NBuffers;
+
+		/*
+		 * If we're the one that just caused a wraparound, force
+		 * completePasses to be incremented while holding the spinlock. We
+		 * need the spinlock so StrategySyncStart() can return a consistent
+		 * value consisting of nextVictimBuffer and completePasses.
+		 */
+		if (victim == 0)
+		{
+			uint32		expected;
+			uint32		wrapped;
+			bool		success = false;
+
+			expected = originalVictim + 1;
+
+			while (!success)
+			{
+				/*
+				 * Acquire the spinlock while increasing completePasses. That
+				 * allows other readers to read nextVictimBuffer and
+				 * completePasses in a consistent manner which is required for
+				 * StrategySyncStart().  In theory delaying the increment
+				 * could lead to an overflow of nextVictimBuffers, but that's
+				 * highly unlikely and wouldn't be particularly harmful.
+				 */
+				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+				wrapped = expected % NBuffers;
+
+				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+														 &expected, wrapped);
+				if (success)
+					StrategyControl->completePasses++;
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+			}
+		}
+	}
+	return victim;
+}
+
+/*
+ * have_free_buffer -- a lockless check to see if there is a free buffer in
+ *					   buffer pool.
+ *
+ * If the result is true that will become stale once free buffers are moved out
+ * by other operations, so the caller who strictly want to use a free buffer
+ * should not call this.
+ */
+bool
+have_free_buffer(void)
+{
+	if (StrategyControl->firstFreeBuffer >= 0)
+		return true;
+	else
+		return false;
+}
+
+
+
+// cs3223
+// StrategyAccessBuffer 
+// Called by bufmgr when a buffer page is accessed.
+// Applies the ARC rules to buffer buf_id if delete is false; otherwise, removes buffer buf_id from T1 or T2.
+// Takes arc_lock, so the caller must not hold a buffer header lock or any other spinlock.
+void
+StrategyAccessBuffer(int buf_id, bool delete)
+{
+	node* frame = &doubleLinkedList[buf_id];
+	BufferDesc* buf = GetBufferDescriptor(buf_id);
+	int32 slot;
+
+	// CS3223: The page at the head of T2 is where a hit would put it already. The unlocked look is only a hint: at
+	// worst a reference is lost, or the lock is taken for nothing.
+	if (!delete && frame->list == LIST_T2 && INT_ACCESS_ONCE(arc->t2.head) == buf_id) {
+		return;
+	}
+
+	LWLockAcquire(&arc->arc_lock, LW_EXCLUSIVE);
+
+	if (delete) {
+		if (frame->list != LIST_NONE) {
+			unlink_frame(list_of(frame), frame);
+		}
+	} else if (frame->list == LIST_NONE) {
+		// Not in T1 or T2: a buffer just taken from the freelist
+		insert_at_head(&arc->t1, frame);
+		frame->fresh = true;
+		trim_b1();
+	} else {
+		// First reference to the page since it was loaded: if it has a ghost, it was loaded on a ghost hit, which
+		// adapts p. The caller has it pinned, so its tag is stable.
+		if (frame->fresh) {
+			slot = ghost_lookup(&buf->tag);
+			if (slot != NIL_FRAME) {
+				adapt_target(slot);
+				ghost_remove(slot);
+			}
+		}
+
+		// A hit in T1 or T2 moves the page to the head of T2
+		unlink_frame(list_of(frame), frame);
+		insert_at_head(&arc->t2, frame);
+	}
+
+	LWLockRelease(&arc->arc_lock);
+}
+
+// CS3223 - StrategyAccessPinnedBuffer
+// Called by bufmgr in place of StrategyAccessBuffer for a hit on a buffer the backend already has pinned.
+// ARC treats it as any other hit.
+void
+StrategyAccessPinnedBuffer(int buf_id)
+{
+	StrategyAccessBuffer(buf_id, false);
+}
+
+/*
+ * StrategyGetBuffer
+ *
+ *	Called by the bufmgr to get the next candidate buffer to use in
+ *	BufferAlloc(). The only hard requirement BufferAlloc() has is that
+ *	the selected buffer must not currently be pinned by anyone.
+ *
+ *	strategy is a BufferAccessStrategy object, or NULL for default strategy.
+ *
+ *	To ensure that no one else can pin the buffer before we do, we must
+ *	return the buffer with the buffer header spinlock still held.
+ */
+BufferDesc *
+StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_ring)
+{
+	BufferDesc *buf;
+	int			bgwprocno;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+	// CS3223
+	info* lists[2];
+	int32 traversal_frame_id;
+	int32 next_frame_id;
+
+	*from_ring = false;
+
+	/*
+	 * If given a strategy object, see whether it can select a buffer. We
+	 * assume strategy objects don't need buffer_strategy_lock.
+	 */
+
+	// CS3223: A recycled ring buffer stays wherever it is, and its old page gets no ghost. The ring's pages are evicted
+	// from T1 without reaching T2 unless something else references them.
+	if (strategy != NULL)
+	{
+		buf = GetBufferFromRing(strategy, buf_state);
+		if (buf != NULL)
+		{
+			*from_ring = true;
+			pg_atomic_fetch_add_u64(&StrategyControl->ringReuses, 1);
+			return buf;
+		}
+	}
+
+	/*
+	 * If asked, we need to waken the bgwriter. Since we don't want to rely on
+	 * a spinlock for this we force a read from shared memory once, and then
+	 * set the latch based on that value. We need to go through that length
+	 * because otherwise bgwprocno might be reset while/after we check because
+	 * the compiler might just reread from memory.
+	 *
+	 * This can possibly set the latch of the wrong process if the bgwriter
+	 * dies in the wrong moment. But since PGPROC->procLatch is never
+	 * deallocated the worst consequence of that is that we set the latch of
+	 * some arbitrary process.
+	 */
+	bgwprocno = INT_ACCESS_ONCE(StrategyControl->bgwprocno);
+	if (bgwprocno != -1)
+	{
+		/* reset bgwprocno first, before setting the latch */
+		StrategyControl->bgwprocno = -1;
+
+		/*
+		 * Not acquiring ProcArrayLock here which is slightly icky. It's
+		 * actually fine because procLatch isn't ever freed, so we just can
+		 * potentially set the wrong process' (or no process') latch.
+		 */
+		SetLatch(&ProcGlobal->allProcs[bgwprocno].procLatch);
+	}
+
+	/*
+	 * We count buffer allocation requests so that the bgwriter can estimate
+	 * the rate of buffer consumption.  Note that buffers recycled by a
+	 * strategy object are intentionally not counted here.
+	 */
+	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
+
+	/*
+	 * First check, without acquiring the lock, whether there's buffers in the
+	 * freelist. Since we otherwise don't require the spinlock in every
+	 * StrategyGetBuffer() invocation, it'd be sad to acquire it here -
+	 * uselessly in most cases. That obviously leaves a race where a buffer is
+	 * put on the freelist but we don't see the store yet - but that's pretty
+	 * harmless, it'll just get used during the next buffer acquisition.
+	 *
+	 * If there's buffers on the freelist, acquire the spinlock to pop one
+	 * buffer of the freelist. Then check whether that buffer is usable and
+	 * repeat if not.
+	 *
+	 * Note that the freeNext fields are considered to be protected by the
+	 * buffer_strategy_lock not the individual buffer spinlocks, so it's OK to
+	 * manipulate them without holding the spinlock.
+	 */
+	if (StrategyControl->firstFreeBuffer >= 0)
+	{
+		while (true)
+		{
+			/* Acquire the spinlock to remove element from the freelist */
+			SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+			if (StrategyControl->firstFreeBuffer < 0)
+			{
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+				break;
+			}
+
+			buf = GetBufferDescriptor(StrategyControl->firstFreeBuffer);
+			Assert(buf->freeNext != FREENEXT_NOT_IN_LIST);
+
+			/* Unconditionally remove buffer from freelist */
+			StrategyControl->firstFreeBuffer = buf->freeNext;
+			buf->freeNext = FREENEXT_NOT_IN_LIST;
+
+			/*
+			 * Release the lock so someone else can access the freelist while
+			 * we check out this buffer.
+			 */
+			SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+			//CS3223: Add buffer to the head of T1. This has to happen before the buffer header is locked, as
+			// arc_lock is an LWLock. If the buffer turns out to be unusable below, somebody is using it and it
+			// belongs in T1 anyway.
+			StrategyAccessBuffer(buf->buf_id, false);                      // Case 2
+
+			/*
+			 * If the buffer is pinned or has a nonzero usage_count, we cannot
+			 * use it; discard it and retry.  (This can only happen if VACUUM
+			 * put a valid buffer in the freelist and then someone else used
+			 * it before we got to it.  It's probably impossible altogether as
+			 * of 8.3, but we'd better check anyway.)
+			 */
+			local_buf_state = LockBufHdr(buf);
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+				&& BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
+			{
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				*buf_state = local_buf_state;
+				return buf;
+			}
+			UnlockBufHdr(buf, local_buf_state);
+		}
+	}
+
+	// CS3223: Counts evictions for the bgwriter's pacing, see StrategySyncStart
+	(void) ClockSweepTick();
+	pg_atomic_fetch_add_u64(strategy != NULL ? &StrategyControl->ringEvictions : &StrategyControl->poolEvictions, 1);
+
+	// Case 3
+	// CS3223: Evict from the tail of T1 or T2 as evict_from_t1 decides. If every frame of that list is pinned, fall
+	// back to the other one. The victim is moved to the head of T1, as it is about to hold a newly loaded page. A fresh
+	// frame with a ghost moves to T2 on the way (see claim_victim), so the walk remembers where to go next before
+	// trying a frame. arc_lock is held exclusively throughout, as the victim has to be relinked without letting go of
+	// its buffer header lock.
+	LWLockAcquire(&arc->arc_lock, LW_EXCLUSIVE);
+
+	if (evict_from_t1()) {
+		lists[0] = &arc->t1;
+		lists[1] = &arc->t2;
+	} else {
+		lists[0] = &arc->t2;
+		lists[1] = &arc->t1;
+	}
+
+	for (int l = 0; l < 2; l++) {
+		for (traversal_frame_id = lists[l]->tail; traversal_frame_id != NIL_FRAME; traversal_frame_id = next_frame_id) {
+			next_frame_id = doubleLinkedList[traversal_frame_id].prev;
+			if (claim_victim(traversal_frame_id, buf_state)) {
+				LWLockRelease(&arc->arc_lock);
+
+				buf = GetBufferDescriptor(traversal_frame_id);
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				return buf;
+			}
+		}
+	}
+
+	LWLockRelease(&arc->arc_lock);
+
+	/*
+	 * We've scanned all the buffers without making any state changes, so
+	 * all the buffers are pinned (or were when we looked at them). We could
+	 * hope that someone will free one eventually, but it's probably better
+	 * to fail than to risk getting stuck in an infinite loop.
+	 */
+	elog(ERROR, "no unpinned buffers available");
+}
+
+/*
+ * StrategyFreeBuffer: put a buffer on the freelist
+ */
+void
+StrategyFreeBuffer(BufferDesc *buf)
+{
+	// Case 4
+	// CS3223: Unlink the frame before it becomes visible on the freelist. The list lock is an LWLock, which
+	// must not be taken while holding buffer_strategy_lock.
+	StrategyAccessBuffer(buf->buf_id, true);
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+	/*
+	 * It is possible that we are told to put something in the freelist that
+	 * is already in it; don't screw up the list if so.
+	 */
+	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
+	{
+		buf->freeNext = StrategyControl->firstFreeBuffer;
+		if (buf->freeNext < 0)
+			StrategyControl->lastFreeBuffer = buf->buf_id;
+		StrategyControl->firstFreeBuffer = buf->buf_id;
+	}
+
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+/*
+ * StrategySyncStart -- tell BufferSync where to start syncing
+ *
+ * The result is the buffer index of the best buffer to sync first.
+ * BufferSync() will proceed circularly around the buffer array from there.
+ *
+ * In addition, we return the completed-pass count (which is effectively
+ * the higher-order bits of nextVictimBuffer) and the count of recent buffer
+ * allocs if non-NULL pointers are passed.  The alloc count is reset after
+ * being read.
+ *
+ * CS3223: Here the clock hand only counts evictions from the list (see
+ * StrategyGetBuffer), so the result and pass count tell the bgwriter how
+ * far eviction has got but not which buffers come next; BgBufferSync gets
+ * those from StrategySyncVictims.
+ */
+int
+StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
+{
+	uint32		nextVictimBuffer;
+	int			result;
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
+	result = nextVictimBuffer % NBuffers;
+
+	if (complete_passes)
+	{
+		*complete_passes = StrategyControl->completePasses;
+
+		/*
+		 * Additionally add the number of wraparounds that happened before
+		 * completePasses could be incremented. C.f. ClockSweepTick().
+		 */
+		*complete_passes += nextVictimBuffer / NBuffers;
+	}
+
+	if (num_buf_alloc)
+	{
+		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
+	}
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+	return result;
+}
+
+
+// CS3223: No victim queue (see freelist_lru.c), the victims are at the tails of T1 and T2 already
+void StrategyRefillVictimQueue(void) {
+}
+
+// CS3223: See StrategySyncVictims in freelist_lru.c. The order, if p stays where it is, is the frames T1 holds beyond
+// p, then T2, then the rest of T1, all from the tail.
+int StrategySyncVictims(int* buf_ids, int max_buffers) {
+	int num_buffers = 0;
+	int32 t1_frame_id;
+	int32 t2_frame_id;
+
+	if (max_buffers <= 0) {
+		return 0;
+	}
+
+	LWLockAcquire(&arc->arc_lock, LW_SHARED);
+
+	t1_frame_id = arc->t1.tail;
+	t2_frame_id = arc->t2.tail;
+
+	num_buffers = sync_victims_from(&arc->t1, &t1_frame_id, buf_ids, num_buffers,
+									Min(max_buffers, Max(arc->t1.size - arc->p, 0)));
+	num_buffers = sync_victims_from(&arc->t2, &t2_frame_id, buf_ids, num_buffers, max_buffers);
+	num_buffers = sync_victims_from(&arc->t1, &t1_frame_id, buf_ids, num_buffers, max_buffers);
+
+	LWLockRelease(&arc->arc_lock);
+
+	return num_buffers;
+}
+
+// CS3223: ARC does no dirty look-ahead, see lru_dirty_lookahead
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions) {
+	*clean_substitutions = 0;
+	*dirty_evictions = 0;
+}
+
+// CS3223: Ring reuse against main pool evictions, see StrategyRingStats in freelist_lru.c
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions) {
+	*ring_reuses = pg_atomic_read_u64(&StrategyControl->ringReuses);
+	*ring_evictions = pg_atomic_read_u64(&StrategyControl->ringEvictions);
+	*pool_evictions = pg_atomic_read_u64(&StrategyControl->poolEvictions);
+}
+
+// CS3223: ARC has no admission filter, see lru_admission_filter
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections) {
+	*admissions = 0;
+	*rejections = 0;
+}
+
+// CS3223: Where ARC has settled, for debugging and for customTests/harness: the target size p of T1, and the sizes of
+// the four lists
+void StrategyArcTarget(int* p, int* t1_size, int* t2_size, int* b1_size, int* b2_size) {
+	LWLockAcquire(&arc->arc_lock, LW_SHARED);
+	*p = arc->p;
+	*t1_size = arc->t1.size;
+	*t2_size = arc->t2.size;
+	*b1_size = arc->b1.size;
+	*b2_size = arc->b2.size;
+	LWLockRelease(&arc->arc_lock);
+}
+
+/*
+ * StrategyNotifyBgWriter -- set or clear allocation notification latch
+ *
+ * If bgwprocno isn't -1, the next invocation of StrategyGetBuffer will
+ * set that latch.  Pass -1 to clear the pending notification before it
+ * happens.  This feature is used by the bgwriter process to wake itself up
+ * from hibernation, and is not meant for anybody else to use.
+ */
+void
+StrategyNotifyBgWriter(int bgwprocno)
+{
+	/*
+	 * We acquire buffer_strategy_lock just to ensure that the store appears
+	 * atomic to StrategyGetBuffer.  The bgwriter should call this rather
+	 * infrequently, so there's no performance penalty from being safe.
+	 */
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	StrategyControl->bgwprocno = bgwprocno;
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+
+/*
+ * StrategyShmemSize
+ *
+ * estimate the size of shared memory used by the freelist-related structures.
+ *
+ * Note: for somewhat historical reasons, the buffer lookup hashtable size
+ * is also determined here.
+ */
+Size
+StrategyShmemSize(void)
+{
+	Size		size = 0;
+
+	/* size of lookup hash table ... see comment in StrategyInitialize */
+	size = add_size(size, BufTableShmemSize(NBuffers + NUM_BUFFER_PARTITIONS));
+
+	/* size of the shared replacement strategy control block */
+	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
+
+	// CS3223: Allocate size for our data structures in FREE-LIST, one node per buffer
+	size = add_size(size, mul_size(sizeof(node), NBuffers));
+
+	// Control information of T1, T2, B1 and B2
+	size = add_size(size, sizeof(arc_info));
+
+	// Ghost slots and hash buckets of B1 and B2
+	size = add_size(size, mul_size(sizeof(ghost_entry), NBuffers));
+	size = add_size(size, mul_size(sizeof(int32), arc_num_buckets()));
+
+	return size;
+}
+
+/*
+ * StrategyInitialize -- initialize the buffer cache replacement
+ *		strategy.
+ *
+ * Assumes: All of the buffers are already built into a linked list.
+ *		Only called by postmaster and only during initialization.
+ */
+void
+StrategyInitialize(bool init)
+{
+	bool		found;
+
+	// CS3223: Boolean values for if shared memory alloc is successful
+	bool is_dll_success = false;
+	bool is_arc_success = false;
+	bool is_ghosts_success = false;
+	bool is_ghost_buckets_success = false;
+	uint32 num_buckets = arc_num_buckets();
+
+	/*
+	 * Initialize the shared buffer lookup hashtable.
+	 *
+	 * Since we can't tolerate running out of lookup table entries, we must be
+	 * sure to specify an adequate table size here.  The maximum steady-state
+	 * usage is of course NBuffers entries, but BufferAlloc() tries to insert
+	 * a new entry before deleting the old.  In principle this could be
+	 * happening in each partition concurrently, so we could need as many as
+	 * NBuffers + NUM_BUFFER_PARTITIONS entries.
+	 */
+	InitBufTable(NBuffers + NUM_BUFFER_PARTITIONS);
+
+	/*
+	 * Get or create the shared strategy control block
+	 */
+	StrategyControl = (BufferStrategyControl *)
+		ShmemInitStruct("Buffer Strategy Status",
+						sizeof(BufferStrategyControl),
+						&found);
+
+
+	// CS3223: Initialize space for our data structures
+	arc = (arc_info *)ShmemInitStruct("ARC Info", sizeof(arc_info), &is_arc_success);
+
+	// Double Linked List itself
+	doubleLinkedList = (node *)ShmemInitStruct("Double Link List",
+														mul_size(sizeof(node), NBuffers),
+														&is_dll_success);
+
+	// B1 and B2
+	ghosts = (ghost_entry *)ShmemInitStruct("ARC Ghosts",
+											mul_size(sizeof(ghost_entry), NBuffers),
+											&is_ghosts_success);
+	ghostBuckets = (int32 *)ShmemInitStruct("ARC Ghost Buckets",
+											mul_size(sizeof(int32), num_buckets),
+											&is_ghost_buckets_success);
+
+	if (!found)
+	{
+		/*
+		 * Only done once, usually in postmaster
+		 */
+		Assert(init);
+
+		SpinLockInit(&StrategyControl->buffer_strategy_lock);
+
+		/*
+		 * Grab the whole linked list of free buffers for our strategy. We
+		 * assume it was previously set up by InitBufferPool().
+		 */
+		StrategyControl->firstFreeBuffer = 0;
+		StrategyControl->lastFreeBuffer = NBuffers - 1;
+
+		/* Initialize the clock sweep pointer */
+		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+
+		/* Clear statistics */
+		StrategyControl->completePasses = 0;
+		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
+
+		/* No pending notification */
+		StrategyControl->bgwprocno = -1;
+
+		/* CS3223: Clear ring statistics */
+		pg_atomic_init_u64(&StrategyControl->ringReuses, 0);
+		pg_atomic_init_u64(&StrategyControl->ringEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->poolEvictions, 0);
+
+		/* CS3223: Tranche of arc_lock */
+		StrategyControl->listLockTrancheId = LWLockNewTrancheId();
+	}
+	else
+		Assert(!init);
+
+	// CS3223: Tranche names are backend-local, so every backend registers it
+	LWLockRegisterTranche(StrategyControl->listLockTrancheId, "ARCList");
+
+	// CS3223: T1 and T2 start empty, every node unlinked, and p at 0
+	if (!is_dll_success && !is_arc_success) {
+		Assert (init);
+		LWLockInitialize(&arc->arc_lock, StrategyControl->listLockTrancheId);
+
+		arc->t1.head = NIL_FRAME;
+		arc->t1.tail = NIL_FRAME;
+		arc->t1.size = 0;
+		arc->t2.head = NIL_FRAME;
+		arc->t2.tail = NIL_FRAME;
+		arc->t2.size = 0;
+		arc->p = 0;
+
+		// An all-zero node is a valid unlinked node (list is LIST_NONE, prev/next are only read while linked)
+		memset(doubleLinkedList, 0, mul_size(sizeof(node), NBuffers));
+	} else
+		Assert(!init);
+
+	// CS3223: B1 and B2 start empty, with every slot on the free slot list
+	if (!is_ghosts_success && !is_ghost_buckets_success) {
+		Assert (init);
+		arc->b1.head = NIL_FRAME;
+		arc->b1.tail = NIL_FRAME;
+		arc->b1.size = 0;
+		arc->b2.head = NIL_FRAME;
+		arc->b2.tail = NIL_FRAME;
+		arc->b2.size = 0;
+		arc->num_buckets = num_buckets;
+
+		for (int i = 0; i < NBuffers; i++) {
+			ghosts[i].list = LIST_NONE;
+			ghosts[i].prev = NIL_FRAME;
+			ghosts[i].hash_next = NIL_FRAME;
+			ghosts[i].next = (i + 1 < NBuffers) ? i + 1 : NIL_FRAME;
+		}
+		arc->free_ghost = 0;
+
+		for (uint32 b = 0; b < num_buckets; b++) {
+			ghostBuckets[b] = NIL_FRAME;
+		}
+	} else
+		Assert(!init);
+}
+
+
+/* ----------------------------------------------------------------
+ *				Backend-private buffer ring management
+ * ----------------------------------------------------------------
+ */
+
+
+/*
+ * GetAccessStrategy -- create a BufferAccessStrategy object
+ *
+ * The object is allocated in the current memory context.
+ */
+BufferAccessStrategy
+GetAccessStrategy(BufferAccessStrategyType btype)
+{
+	int			ring_size_kb;
+
+	/*
+	 * Select ring size to use.  See buffer/README for rationales.
+	 *
+	 * Note: if you change the ring size for BAS_BULKREAD, see also
+	 * SYNC_SCAN_REPORT_INTERVAL in access/heap/syncscan.c.
+	 */
+	switch (btype)
+	{
+		case BAS_NORMAL:
+			/* if someone asks for NORMAL, just give 'em a "default" object */
+			return NULL;
+
+		case BAS_BULKREAD:
+			ring_size_kb = 256;
+			break;
+		case BAS_BULKWRITE:
+			ring_size_kb = 16 * 1024;
+			break;
+		case BAS_VACUUM:
+			ring_size_kb = 256;
+			break;
+
+		default:
+			elog(ERROR, "unrecognized buffer access strategy: %d",
+				 (int) btype);
+			return NULL;		/* keep compiler quiet */
+	}
+
+	return GetAccessStrategyWithSize(btype, ring_size_kb);
+}
+
+/*
+ * GetAccessStrategyWithSize -- create a BufferAccessStrategy object with a
+ *		number of buffers equivalent to the passed in size.
+ *
+ * If the given ring size is 0, no BufferAccessStrategy will be created and
+ * the function will return NULL.  ring_size_kb must not be negative.
+ */
+BufferAccessStrategy
+GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb)
+{
+	int			ring_buffers;
+	BufferAccessStrategy strategy;
+
+	Assert(ring_size_kb >= 0);
+
+	/* Figure out how many buffers ring_size_kb is */
+	ring_buffers = ring_size_kb / (BLCKSZ / 1024);
+
+	/* 0 means unlimited, so no BufferAccessStrategy required */
+	if (ring_buffers == 0)
+		return NULL;
+
+	/* Cap to 1/8th of shared_buffers */
+	ring_buffers = Min(NBuffers / 8, ring_buffers);
+
+	/* NBuffers should never be less than 16, so this shouldn't happen */
+	Assert(ring_buffers > 0);
+
+	/* Allocate the object and initialize all elements to zeroes */
+	strategy = (BufferAccessStrategy)
+		palloc0(offsetof(BufferAccessStrategyData, buffers) +
+				ring_buffers * sizeof(Buffer));
+
+	/* Set fields that don't start out zero */
+	strategy->btype = btype;
+	strategy->nbuffers = ring_buffers;
+
+	return strategy;
+}
+
+/*
+ * GetAccessStrategyBufferCount -- an accessor for the number of buffers in
+ *		the ring
+ *
+ * Returns 0 on NULL input to match behavior of GetAccessStrategyWithSize()
+ * returning NULL with 0 size.
+ */
+int
+GetAccessStrategyBufferCount(BufferAccessStrategy strategy)
+{
+	if (strategy == NULL)
+		return 0;
+
+	return strategy->nbuffers;
+}
+
+/*
+ * FreeAccessStrategy -- release a BufferAccessStrategy object
+ *
+ * A simple pfree would do at the moment, but we would prefer that callers
+ * don't assume that much about the representation of BufferAccessStrategy.
+ */
+void
+FreeAccessStrategy(BufferAccessStrategy strategy)
+{
+	/* don't crash if called on a "default" strategy */
+	if (strategy != NULL)
+		pfree(strategy);
+}
+
+/*
+ * GetBufferFromRing -- returns a buffer from the ring, or NULL if the
+ *		ring is empty / not usable.
+ *
+ * The bufhdr spin lock is held on the returned buffer.
+ */
+static BufferDesc *
+GetBufferFromRing(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	Buffer		bufnum;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+
+	/* Advance to next ring slot */
+	if (++strategy->current >= strategy->nbuffers)
+		strategy->current = 0;
+
+	/*
+	 * If the slot hasn't been filled yet, tell the caller to allocate a new
+	 * buffer with the normal allocation strategy.  He will then fill this
+	 * slot by calling AddBufferToRing with the new buffer.
+	 */
+	bufnum = strategy->buffers[strategy->current];
+	if (bufnum == InvalidBuffer)
+		return NULL;
+
+	/*
+	 * If the buffer is pinned we cannot use it under any circumstances.
+	 *
+	 * If usage_count is 0 or 1 then the buffer is fair game (we expect 1,
+	 * since our own previous usage of the ring element would have left it
+	 * there, but it might've been decremented by clock sweep since then). A
+	 * higher usage_count indicates someone else has touched the buffer, so we
+	 * shouldn't re-use it.
+	 */
+	buf = GetBufferDescriptor(bufnum - 1);
+	local_buf_state = LockBufHdr(buf);
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+		&& BUF_STATE_GET_USAGECOUNT(local_buf_state) <= 1)
+	{
+		*buf_state = local_buf_state;
+		return buf;
+	}
+	UnlockBufHdr(buf, local_buf_state);
+
+	/*
+	 * Tell caller to allocate a new buffer with the normal allocation
+	 * strategy.  He'll then replace this ring element via AddBufferToRing.
+	 */
+	return NULL;
+}
+
+/*
+ * AddBufferToRing -- add a buffer to the buffer ring
+ *
+ * Caller must hold the buffer header spinlock on the buffer.  Since this
+ * is called with the spinlock held, it had better be quite cheap.
+ */
+static void
+AddBufferToRing(BufferAccessStrategy strategy, BufferDesc *buf)
+{
+	strategy->buffers[strategy->current] = BufferDescriptorGetBuffer(buf);
+}
+
+/*
+ * Utility function returning the IOContext of a given BufferAccessStrategy's
+ * strategy ring.
+ */
+IOContext
+IOContextForStrategy(BufferAccessStrategy strategy)
+{
+	if (!strategy)
+		return IOCONTEXT_NORMAL;
+
+	switch (strategy->btype)
+	{
+		case BAS_NORMAL:
+
+			/*
+			 * Currently, GetAccessStrategy() returns NULL for
+			 * BufferAccessStrategyType BAS_NORMAL, so this case is
+			 * unreachable.
+			 */
+			pg_unreachable();
+			return IOCONTEXT_NORMAL;
+		case BAS_BULKREAD:
+			return IOCONTEXT_BULKREAD;
+		case BAS_BULKWRITE:
+			return IOCONTEXT_BULKWRITE;
+		case BAS_VACUUM:
+			return IOCONTEXT_VACUUM;
+	}
+
+	elog(ERROR, "unrecognized BufferAccessStrategyType: %d", strategy->btype);
+	pg_unreachable();
+}
+
+/*
+ * StrategyRejectBuffer -- consider rejecting a dirty buffer
+ *
+ * When a nondefault strategy is used, the buffer manager calls this function
+ * when it turns out that the buffer selected by StrategyGetBuffer needs to
+ * be written out and doing so would require flushing WAL too.  This gives us
+ * a chance to choose a different victim.
+ *
+ * Returns true if buffer manager should ask for a new victim, and false
+ * if this buffer should be written and re-used.
+ */
+bool
+StrategyRejectBuffer(BufferAccessStrategy strategy, BufferDesc *buf, bool from_ring)
+{
+	/* We only do this in bulkread mode */
+	if (strategy->btype != BAS_BULKREAD)
+		return false;
+
+	/* Don't muck with behavior of normal buffer-replacement strategy */
+	if (!from_ring ||
+		strategy->buffers[strategy->current] != BufferDescriptorGetBuffer(buf))
+		return false;
+
+	/*
+	 * Remove the dirty buffer from the ring; necessary to prevent infinite
+	 * loop if all ring members are dirty.
+	 */
+	strategy->buffers[strategy->current] = InvalidBuffer;
+
+	return true;
+}
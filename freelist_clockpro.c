@@ -0,0 +1,1151 @@
+/*-------------------------------------------------------------------------
+ *
+ * freelist.c
+ *	  routines for managing the buffer pool's replacement strategy.
+ *
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/freelist.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "port/pg_bitutils.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/proc.h"
+
+#include <assert.h>
+
+#define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
+
+/*********************************************/
+// CS3223 - Data Structure declarations
+
+// CLOCK-Pro (Jiang, Chen & Zhang) on top of the original clock sweep. The hand (ClockSweepTick) still picks victims
+// with nothing but the buffer header spinlock, but every frame is now either
+//   hot  - part of the working set; the hand only ages it (decrements its usage count) or demotes it to cold, and
+//          never evicts it
+//   cold - a victim candidate. A cold frame is also in its test period while its page has yet to prove itself: if
+//          the page is referenced again before the hand comes back, it turns hot.
+// A scan's pages enter cold and leave cold, so the hot frames (the working set) survive it, and a loop larger than
+// the pool keeps some of its pages hot instead of missing on all of them.
+//
+// The test period outlives the page: an evicted cold page leaves a shadow entry, which records the hash of its tag and
+// the eviction count at the time. When the page is loaded again, the number of evictions since is how long it was
+// gone. The hand demotes unreferenced hot frames only while there are more of them than the hot target, NBuffers less
+// the cold target, and a test period lasts about as long as the hand takes to pass that many. A page back within that
+// many evictions would still have been resident with more room for cold pages, so it comes back hot and the cold
+// target grows; later than that, it comes back cold and the cold target shrinks.
+//
+// Shadow entries are a lossy table of 64-bit atomics, indexed by the hash of the tag: a collision overwrites an older
+// shadow, and a hash match is taken on trust. The class of a frame is a word of flags beside the buffer state word.
+// The hand changes it only under the buffer header lock on unpinned frames, and StrategyAccessBuffer only on frames
+// its caller has pinned, so neither needs a lock of its own.
+//
+// StrategyGetBuffer does not know which page the victim will hold, so a newly loaded page is checked against the
+// shadow table on its first hit instead of when it is loaded. Until then it is cold and fresh, and the usage count
+// its load gave it does not count as a reference.
+
+// Frame class flags. A frame with neither CLOCKPRO_HOT nor CLOCKPRO_TEST is cold and out of its test period.
+#define CLOCKPRO_HOT 0x01
+#define CLOCKPRO_TEST 0x02                    // Cold and in its test period
+#define CLOCKPRO_FRESH 0x04                   // No hit since its page was loaded
+
+// A shadow entry holds the hash of the evicted page's tag in its high half and the eviction count in its low half.
+// 0 is an empty entry.
+#define SHADOW_ENTRY(hash, evictions) (((uint64) (hash) << 32) | (uint64) (evictions))
+#define SHADOW_HASH(entry) ((uint32) ((entry) >> 32))
+#define SHADOW_EVICTIONS(entry) ((uint32) (entry))
+
+typedef struct clockpro_info {
+	pg_atomic_uint32 numHot;           // Hot frames
+	pg_atomic_uint32 coldTarget;       // Frames the hand leaves cold before it demotes hot ones, 1 to NBuffers - 1
+	pg_atomic_uint32 evictions;        // Frames evicted by the hand, the clock of the shadow entries
+	pg_atomic_uint64 shadowHits;       // Pages back within their test period
+	pg_atomic_uint64 shadowMisses;     // Pages back later than that
+} clockpro_info;
+
+static clockpro_info* clockPro = NULL;
+static pg_atomic_uint32* frameClass = NULL;   // Indexed by buf_id, CLOCKPRO_* flags
+static pg_atomic_uint64* shadows = NULL;      // numShadows entries
+static uint32 numShadows;                     // Power of two, at least NBuffers
+
+uint32 clockpro_num_shadows(void);
+uint32 change_class(int buf_id, uint32 clear, uint32 set);
+bool too_many_hot(void);
+void adjust_cold_target(int delta);
+void remember_evicted(BufferDesc* buf, uint32 evictions);
+bool check_shadow(BufferDesc* buf);
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions);
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions);
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections);
+void StrategyClockProStats(int* hot_frames, int* cold_target, uint64* shadow_hits, uint64* shadow_misses);
+
+
+/*********************************************/
+// CS3223 - Function definitions
+
+uint32 clockpro_num_shadows(void) {
+	return pg_nextpower2_32((uint32) Max(NBuffers, 1));
+}
+
+// Clears the 'clear' flags and sets the 'set' flags in the class of frame buf_id, and keeps the hot frame count in
+// step. Returns the old class. Called by the hand under the buffer header lock of an unpinned frame, and by
+// StrategyAccessBuffer for a frame its caller has pinned; the CAS loop is for backends that pinned the same frame.
+uint32 change_class(int buf_id, uint32 clear, uint32 set) {
+	pg_atomic_uint32* frame_class = &frameClass[buf_id];
+	uint32 old_class = pg_atomic_read_u32(frame_class);
+	uint32 new_class;
+
+	do {
+		new_class = (old_class & ~clear) | set;
+	} while (!pg_atomic_compare_exchange_u32(frame_class, &old_class, new_class));
+
+	if ((old_class & CLOCKPRO_HOT) && !(new_class & CLOCKPRO_HOT)) {
+		pg_atomic_fetch_sub_u32(&clockPro->numHot, 1);
+	} else if (!(old_class & CLOCKPRO_HOT) && (new_class & CLOCKPRO_HOT)) {
+		pg_atomic_fetch_add_u32(&clockPro->numHot, 1);
+	}
+
+	return old_class;
+}
+
+// Whether the hand should demote the unreferenced hot frames it passes: there are more of them than NBuffers less
+// the cold target
+bool too_many_hot(void) {
+	return pg_atomic_read_u32(&clockPro->numHot) > (uint32) NBuffers - pg_atomic_read_u32(&clockPro->coldTarget);
+}
+
+// Move the cold target by 'delta', keeping it between 1 and NBuffers - 1
+void adjust_cold_target(int delta) {
+	uint32 old_target = pg_atomic_read_u32(&clockPro->coldTarget);
+	uint32 new_target;
+
+	do {
+		new_target = (uint32) Min(Max((int) old_target + delta, 1), Max(NBuffers - 1, 1));
+		if (new_target == old_target) {
+			return;
+		}
+	} while (!pg_atomic_compare_exchange_u32(&clockPro->coldTarget, &old_target, new_target));
+}
+
+// Called by the hand with the buffer header of 'buf' locked, as it evicts a cold page in its test period, with the
+// eviction count that eviction brought it to. Leaves a shadow entry, which overwrites whatever shadow shared its slot.
+void remember_evicted(BufferDesc* buf, uint32 evictions) {
+	uint32 hash = BufTableHashCode(&buf->tag);
+
+	pg_atomic_write_u64(&shadows[hash & (numShadows - 1)], SHADOW_ENTRY(hash, evictions));
+}
+
+// Called on the first hit of a newly loaded page, which the caller has pinned, so its tag is stable. Looks for the
+// page's shadow entry and consumes it. Returns true if the page was evicted no more than the hot target's worth of
+// evictions ago, which also raises the cold target; a later return lowers it.
+bool check_shadow(BufferDesc* buf) {
+	uint32 hash = BufTableHashCode(&buf->tag);
+	pg_atomic_uint64* shadow = &shadows[hash & (numShadows - 1)];
+	uint64 entry = pg_atomic_read_u64(shadow);
+	uint32 distance;
+
+	if (entry == 0 || SHADOW_HASH(entry) != hash) {
+		return false;
+	}
+
+	// Somebody else consumed it first, or a newer shadow took the slot
+	if (!pg_atomic_compare_exchange_u64(shadow, &entry, 0)) {
+		return false;
+	}
+
+	distance = pg_atomic_read_u32(&clockPro->evictions) - SHADOW_EVICTIONS(entry);
+	if (distance <= (uint32) NBuffers - pg_atomic_read_u32(&clockPro->coldTarget)) {
+		adjust_cold_target(1);
+		pg_atomic_fetch_add_u64(&clockPro->shadowHits, 1);
+		return true;
+	}
+
+	adjust_cold_target(-1);
+	pg_atomic_fetch_add_u64(&clockPro->shadowMisses, 1);
+	return false;
+}
+/*********************************************/
+
+
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/* Spinlock: protects the values below */
+	slock_t		buffer_strategy_lock;
+
+	/*
+	 * Clock sweep hand: index of next buffer to consider grabbing. Note that
+	 * this isn't a concrete buffer - we only ever increase the value. So, to
+	 * get an actual buffer, it needs to be used modulo NBuffers.
+	 */
+	pg_atomic_uint32 nextVictimBuffer;
+
+	int			firstFreeBuffer;	/* Head of list of unused buffers */
+	int			lastFreeBuffer; /* Tail of list of unused buffers */
+
+	/*
+	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
+	 * when the list is empty)
+	 */
+
+	/*
+	 * Statistics.  These counters should be wide enough that they can't
+	 * overflow during a single bgwriter cycle.
+	 */
+	uint32		completePasses; /* Complete cycles of the clock sweep */
+	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
+
+	/*
+	 * Bgworker process to be notified upon activity or -1 if none. See
+	 * StrategyNotifyBgWriter.
+	 */
+	int			bgwprocno;
+
+	/*
+	 * CS3223: Buffers recycled by BufferAccessStrategy rings, against
+	 * victims evicted by the hand for a ring and for everybody else.
+	 * Freelist allocations are not counted.
+	 */
+	pg_atomic_uint64 ringReuses;
+	pg_atomic_uint64 ringEvictions;
+	pg_atomic_uint64 poolEvictions;
+} BufferStrategyControl;
+/* Pointers to shared state */
+static BufferStrategyControl *StrategyControl = NULL;
+
+/*
+ * Private (non-shared) state for managing a ring of shared buffers to re-use.
+ * This is currently the only kind of BufferAccessStrategy object, but someday
+ * we might have more kinds.
+ */
+typedef struct BufferAccessStrategyData
+{
+	/* Overall strategy type */
+	BufferAccessStrategyType btype;
+	/* Number of elements in buffers[] array */
+	int			nbuffers;
+
+	/*
+	 * Index of the "current" slot in the ring, ie, the one most recently
+	 * returned by GetBufferFromRing.
+	 */
+	int			current;
+
+	/*
+	 * Array of buffer numbers.  InvalidBuffer (that is, zero) indicates we
+	 * have not yet selected a buffer for this ring slot.  For allocation
+	 * simplicity this is palloc'd together with the fixed fields of the
+	 * struct.
+	 */
+	Buffer		buffers[FLEXIBLE_ARRAY_MEMBER];
+}			BufferAccessStrategyData;
+
+
+void StrategyAccessBuffer(int buf_id, bool delete); /* cs3223 */
+
+/* Prototypes for internal functions */
+static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
+									 uint32 *buf_state);
+static void AddBufferToRing(BufferAccessStrategy strategy,
+							BufferDesc *buf);
+
+/*
+ * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ *
+ * Move the clock hand one buffer ahead of its current position and return the
+ * id of the buffer now under the hand.
+ */
+static inline uint32
+ClockSweepTick(void)
+{
+	uint32		victim;
+
+	/*
+	 * Atomically move hand ahead one buffer - if there's several processes
+	 * doing this, this can lead to buffers being returned slightly out of
+	 * apparent order.
+	 */
+	victim =
+		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+
+	if (victim >= NBuffers)
+	{
+		uint32		originalVictim = victim;
+
+		/* always wrap what we look up in BufferDescriptors */
+		victim = victim % NBuffers;
+
+		/*
+		 * If we're the one that just caused a wraparound, force
+		 * completePasses to be incremented while holding the spinlock. We
+		 * need the spinlock so StrategySyncStart() can return a consistent
+		 * value consisting of nextVictimBuffer and completePasses.
+		 */
+		if (victim == 0)
+		{
+			uint32		expected;
+			uint32		wrapped;
+			bool		success = false;
+
+			expected = originalVictim + 1;
+
+			while (!success)
+			{
+				/*
+				 * Acquire the spinlock while increasing completePasses. That
+				 * allows other readers to read nextVictimBuffer and
+				 * completePasses in a consistent manner which is required for
+				 * StrategySyncStart().  In theory delaying the increment
+				 * could lead to an overflow of nextVictimBuffers, but that's
+				 * highly unlikely and wouldn't be particularly harmful.
+				 */
+				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+				wrapped = expected % NBuffers;
+
+				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+														 &expected, wrapped);
+				if (success)
+					StrategyControl->completePasses++;
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+			}
+		}
+	}
+	return victim;
+}
+
+/*
+ * have_free_buffer -- a lockless check to see if there is a free buffer in
+ *					   buffer pool.
+ *
+ * If the result is true that will become stale once free buffers are moved out
+ * by other operations, so the caller who strictly want to use a free buffer
+ * should not call this.
+ */
+bool
+have_free_buffer(void)
+{
+	if (StrategyControl->firstFreeBuffer >= 0)
+		return true;
+	else
+		return false;
+}
+
+
+// cs3223
+// StrategyAccessBuffer 
+// Called by bufmgr when a buffer page is accessed.
+// The usage count bump of the pin is the reference bit the hand looks at, so only the first hit of a newly loaded
+// page does anything here: it looks for the page's shadow entry, and turns the frame hot if it finds a recent one.
+// If delete is true, the buffer is going to the freelist and becomes a plain cold frame.
+// Takes no lock.
+void
+StrategyAccessBuffer(int buf_id, bool delete)
+{
+	if (delete) {
+		(void) change_class(buf_id, ~0, 0);
+		return;
+	}
+
+	if (!(pg_atomic_read_u32(&frameClass[buf_id]) & CLOCKPRO_FRESH)) {
+		return;
+	}
+
+	// Another backend that pinned the same page may be here too; only the one that clears the flag goes on
+	if (!(change_class(buf_id, CLOCKPRO_FRESH, 0) & CLOCKPRO_FRESH)) {
+		return;
+	}
+
+	if (check_shadow(GetBufferDescriptor(buf_id))) {
+		(void) change_class(buf_id, CLOCKPRO_TEST, CLOCKPRO_HOT);
+	}
+}
+
+// CS3223 - StrategyAccessPinnedBuffer
+// Called by bufmgr in place of StrategyAccessBuffer for a hit on a buffer the backend already has pinned.
+// CLOCK-Pro treats it as any other hit.
+void
+StrategyAccessPinnedBuffer(int buf_id)
+{
+	StrategyAccessBuffer(buf_id, false);
+}
+
+/*
+ * StrategyGetBuffer
+ *
+ *	Called by the bufmgr to get the next candidate buffer to use in
+ *	BufferAlloc(). The only hard requirement BufferAlloc() has is that
+ *	the selected buffer must not currently be pinned by anyone.
+ *
+ *	strategy is a BufferAccessStrategy object, or NULL for default strategy.
+ *
+ *	To ensure that no one else can pin the buffer before we do, we must
+ *	return the buffer with the buffer header spinlock still held.
+ */
+BufferDesc *
+StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_ring)
+{
+	BufferDesc *buf;
+	int			bgwprocno;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+	// CS3223
+	int			trycounter;
+	uint32		frame_class;
+	uint32		evictions;
+	bool		hot_skipped = false;
+	bool		force_demotion = false;
+
+	*from_ring = false;
+
+	/*
+	 * If given a strategy object, see whether it can select a buffer. We
+	 * assume strategy objects don't need buffer_strategy_lock.
+	 */
+
+	// CS3223: A recycled ring buffer is cold and out of its test period, so the hand evicts it at its first touch
+	// unless something other than the ring references it, and its page leaves no shadow entry.
+	if (strategy != NULL)
+	{
+		buf = GetBufferFromRing(strategy, buf_state);
+		if (buf != NULL)
+		{
+			(void) change_class(buf->buf_id, ~0, CLOCKPRO_FRESH);
+			*from_ring = true;
+			pg_atomic_fetch_add_u64(&StrategyControl->ringReuses, 1);
+			return buf;
+		}
+	}
+
+	/*
+	 * If asked, we need to waken the bgwriter. Since we don't want to rely on
+	 * a spinlock for this we force a read from shared memory once, and then
+	 * set the latch based on that value. We need to go through that length
+	 * because otherwise bgwprocno might be reset while/after we check because
+	 * the compiler might just reread from memory.
+	 *
+	 * This can possibly set the latch of the wrong process if the bgwriter
+	 * dies in the wrong moment. But since PGPROC->procLatch is never
+	 * deallocated the worst consequence of that is that we set the latch of
+	 * some arbitrary process.
+	 */
+	bgwprocno = INT_ACCESS_ONCE(StrategyControl->bgwprocno);
+	if (bgwprocno != -1)
+	{
+		/* reset bgwprocno first, before setting the latch */
+		StrategyControl->bgwprocno = -1;
+
+		/*
+		 * Not acquiring ProcArrayLock here which is slightly icky. It's
+		 * actually fine because procLatch isn't ever freed, so we just can
+		 * potentially set the wrong process' (or no process') latch.
+		 */
+		SetLatch(&ProcGlobal->allProcs[bgwprocno].procLatch);
+	}
+
+	/*
+	 * We count buffer allocation requests so that the bgwriter can estimate
+	 * the rate of buffer consumption.  Note that buffers recycled by a
+	 * strategy object are intentionally not counted here.
+	 */
+	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
+
+	/*
+	 * First check, without acquiring the lock, whether there's buffers in the
+	 * freelist. Since we otherwise don't require the spinlock in every
+	 * StrategyGetBuffer() invocation, it'd be sad to acquire it here -
+	 * uselessly in most cases. That obviously leaves a race where a buffer is
+	 * put on the freelist but we don't see the store yet - but that's pretty
+	 * harmless, it'll just get used during the next buffer acquisition.
+	 *
+	 * If there's buffers on the freelist, acquire the spinlock to pop one
+	 * buffer of the freelist. Then check whether that buffer is usable and
+	 * repeat if not.
+	 *
+	 * Note that the freeNext fields are considered to be protected by the
+	 * buffer_strategy_lock not the individual buffer spinlocks, so it's OK to
+	 * manipulate them without holding the spinlock.
+	 */
+	if (StrategyControl->firstFreeBuffer >= 0)
+	{
+		while (true)
+		{
+			/* Acquire the spinlock to remove element from the freelist */
+			SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+			if (StrategyControl->firstFreeBuffer < 0)
+			{
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+				break;
+			}
+
+			buf = GetBufferDescriptor(StrategyControl->firstFreeBuffer);
+			Assert(buf->freeNext != FREENEXT_NOT_IN_LIST);
+
+			/* Unconditionally remove buffer from freelist */
+			StrategyControl->firstFreeBuffer = buf->freeNext;
+			buf->freeNext = FREENEXT_NOT_IN_LIST;
+
+			/*
+			 * Release the lock so someone else can access the freelist while
+			 * we check out this buffer.
+			 */
+			SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+			/*
+			 * If the buffer is pinned or has a nonzero usage_count, we cannot
+			 * use it; discard it and retry.  (This can only happen if VACUUM
+			 * put a valid buffer in the freelist and then someone else used
+			 * it before we got to it.  It's probably impossible altogether as
+			 * of 8.3, but we'd better check anyway.)
+			 */
+			local_buf_state = LockBufHdr(buf);
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+				&& BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
+			{
+				// CS3223: Case 2 - a newly loaded page is cold, and in its test period unless it is a ring's
+				(void) change_class(buf->buf_id, ~0, CLOCKPRO_FRESH | (strategy == NULL ? CLOCKPRO_TEST : 0));
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				*buf_state = local_buf_state;
+				return buf;
+			}
+			UnlockBufHdr(buf, local_buf_state);
+		}
+	}
+
+	/* Nothing on the freelist, so run the "clock sweep" algorithm */
+	// CS3223: Case 3 - the CLOCK-Pro hand. It ages hot frames, and demotes unreferenced ones while there are too many,
+	// or once it has gone round without finding anything else to change (every unpinned frame is hot). A referenced
+	// cold frame turns hot if it is in its test period, and starts one otherwise. An unreferenced cold frame is the
+	// victim. The usage count is the reference bit; for a fresh frame, the count its load gave it does not count.
+	trycounter = NBuffers;
+	for (;;)
+	{
+		buf = GetBufferDescriptor(ClockSweepTick());
+
+		/*
+		 * If the buffer is pinned or has a nonzero usage_count, we cannot use
+		 * it; decrement the usage_count (unless pinned) and keep scanning.
+		 */
+		local_buf_state = LockBufHdr(buf);
+
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+		{
+			frame_class = pg_atomic_read_u32(&frameClass[buf->buf_id]);
+
+			if (frame_class & CLOCKPRO_HOT)
+			{
+				if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
+				{
+					local_buf_state -= BUF_USAGECOUNT_ONE;
+
+					trycounter = NBuffers;
+				}
+				else if (force_demotion || too_many_hot())
+				{
+					(void) change_class(buf->buf_id, CLOCKPRO_HOT, 0);
+
+					trycounter = NBuffers;
+				}
+				else
+				{
+					hot_skipped = true;
+					--trycounter;
+				}
+			}
+			else if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0
+					 && !(frame_class & CLOCKPRO_FRESH))
+			{
+				local_buf_state &= ~BUF_USAGECOUNT_MASK;
+				if (frame_class & CLOCKPRO_TEST)
+					(void) change_class(buf->buf_id, CLOCKPRO_TEST, CLOCKPRO_HOT);
+				else
+					(void) change_class(buf->buf_id, 0, CLOCKPRO_TEST);
+
+				trycounter = NBuffers;
+			}
+			else
+			{
+				/* Found a usable buffer */
+				evictions = pg_atomic_add_fetch_u32(&clockPro->evictions, 1);
+				if ((frame_class & CLOCKPRO_TEST) && (local_buf_state & BM_TAG_VALID))
+					remember_evicted(buf, evictions);
+				(void) change_class(buf->buf_id, ~0, CLOCKPRO_FRESH | (strategy == NULL ? CLOCKPRO_TEST : 0));
+
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				pg_atomic_fetch_add_u64(strategy != NULL ? &StrategyControl->ringEvictions : &StrategyControl->poolEvictions, 1);
+				*buf_state = local_buf_state;
+				return buf;
+			}
+		}
+		else
+			--trycounter;
+
+		if (trycounter == 0)
+		{
+			if (!hot_skipped)
+			{
+				/*
+				 * We've scanned all the buffers without making any state
+				 * changes, so all the buffers are pinned (or were when we
+				 * looked at them). We could hope that someone will free one
+				 * eventually, but it's probably better to fail than to risk
+				 * getting stuck in an infinite loop.
+				 */
+				UnlockBufHdr(buf, local_buf_state);
+				elog(ERROR, "no unpinned buffers available");
+			}
+
+			// CS3223: A round without any state change, but past unreferenced hot frames: every unpinned frame is
+			// hot, or was when we looked. Demote them regardless of the hot target from now on.
+			force_demotion = true;
+			hot_skipped = false;
+			trycounter = NBuffers;
+		}
+		UnlockBufHdr(buf, local_buf_state);
+	}
+}
+
+/*
+ * StrategyFreeBuffer: put a buffer on the freelist
+ */
+void
+StrategyFreeBuffer(BufferDesc *buf)
+{
+	// Case 4
+	// CS3223: Reset the frame's class before it becomes visible on the freelist
+	StrategyAccessBuffer(buf->buf_id, true);
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+	/*
+	 * It is possible that we are told to put something in the freelist that
+	 * is already in it; don't screw up the list if so.
+	 */
+	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
+	{
+		buf->freeNext = StrategyControl->firstFreeBuffer;
+		if (buf->freeNext < 0)
+			StrategyControl->lastFreeBuffer = buf->buf_id;
+		StrategyControl->firstFreeBuffer = buf->buf_id;
+	}
+
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+/*
+ * StrategySyncStart -- tell BufferSync where to start syncing
+ *
+ * The result is the buffer index of the best buffer to sync first.
+ * BufferSync() will proceed circularly around the buffer array from there.
+ *
+ * In addition, we return the completed-pass count (which is effectively
+ * the higher-order bits of nextVictimBuffer) and the count of recent buffer
+ * allocs if non-NULL pointers are passed.  The alloc count is reset after
+ * being read.
+ */
+int
+StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
+{
+	uint32		nextVictimBuffer;
+	int			result;
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
+	result = nextVictimBuffer % NBuffers;
+
+	if (complete_passes)
+	{
+		*complete_passes = StrategyControl->completePasses;
+
+		/*
+		 * Additionally add the number of wraparounds that happened before
+		 * completePasses could be incremented. C.f. ClockSweepTick().
+		 */
+		*complete_passes += nextVictimBuffer / NBuffers;
+	}
+
+	if (num_buf_alloc)
+	{
+		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
+	}
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+	return result;
+}
+
+
+// CS3223: No victim queue (see freelist_lru.c), the hand finds victims without a lock
+void StrategyRefillVictimQueue(void) {
+}
+
+// CS3223: See StrategySyncVictims in freelist_lru.c. Here it looks ahead of the hand, without locking anything, at no
+// more than NBuffers frames, for the ones the hand will evict when it gets to them (unreferenced or fresh cold frames).
+int StrategySyncVictims(int* buf_ids, int max_buffers) {
+	int num_buffers = 0;
+	uint32 next_frame_id = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer) % NBuffers;
+	uint32 buf_state;
+	uint32 frame_class;
+
+	for (int i = 0; i < NBuffers && num_buffers < max_buffers; i++) {
+		buf_state = pg_atomic_read_u32(&GetBufferDescriptor(next_frame_id)->state);
+		frame_class = pg_atomic_read_u32(&frameClass[next_frame_id]);
+
+		if (BUF_STATE_GET_REFCOUNT(buf_state) == 0 && !(frame_class & CLOCKPRO_HOT)
+			&& (BUF_STATE_GET_USAGECOUNT(buf_state) == 0 || (frame_class & CLOCKPRO_FRESH))) {
+			buf_ids[num_buffers++] = next_frame_id;
+		}
+
+		next_frame_id = (next_frame_id + 1) % NBuffers;
+	}
+
+	return num_buffers;
+}
+
+// CS3223: CLOCK-Pro does no dirty look-ahead, see lru_dirty_lookahead
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions) {
+	*clean_substitutions = 0;
+	*dirty_evictions = 0;
+}
+
+// CS3223: Ring reuse against main pool evictions, see StrategyRingStats in freelist_lru.c
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions) {
+	*ring_reuses = pg_atomic_read_u64(&StrategyControl->ringReuses);
+	*ring_evictions = pg_atomic_read_u64(&StrategyControl->ringEvictions);
+	*pool_evictions = pg_atomic_read_u64(&StrategyControl->poolEvictions);
+}
+
+// CS3223: CLOCK-Pro has no admission filter, see lru_admission_filter
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections) {
+	*admissions = 0;
+	*rejections = 0;
+}
+
+// CS3223: Where CLOCK-Pro has settled, for debugging and for customTests/harness: the hot frames and the cold target,
+// and how many evicted pages came back within their test period and after it
+void StrategyClockProStats(int* hot_frames, int* cold_target, uint64* shadow_hits, uint64* shadow_misses) {
+	*hot_frames = (int) pg_atomic_read_u32(&clockPro->numHot);
+	*cold_target = (int) pg_atomic_read_u32(&clockPro->coldTarget);
+	*shadow_hits = pg_atomic_read_u64(&clockPro->shadowHits);
+	*shadow_misses = pg_atomic_read_u64(&clockPro->shadowMisses);
+}
+
+/*
+ * StrategyNotifyBgWriter -- set or clear allocation notification latch
+ *
+ * If bgwprocno isn't -1, the next invocation of StrategyGetBuffer will
+ * set that latch.  Pass -1 to clear the pending notification before it
+ * happens.  This feature is used by the bgwriter process to wake itself up
+ * from hibernation, and is not meant for anybody else to use.
+ */
+void
+StrategyNotifyBgWriter(int bgwprocno)
+{
+	/*
+	 * We acquire buffer_strategy_lock just to ensure that the store appears
+	 * atomic to StrategyGetBuffer.  The bgwriter should call this rather
+	 * infrequently, so there's no performance penalty from being safe.
+	 */
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	StrategyControl->bgwprocno = bgwprocno;
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+
+/*
+ * StrategyShmemSize
+ *
+ * estimate the size of shared memory used by the freelist-related structures.
+ *
+ * Note: for somewhat historical reasons, the buffer lookup hashtable size
+ * is also determined here.
+ */
+Size
+StrategyShmemSize(void)
+{
+	Size		size = 0;
+
+	/* size of lookup hash table ... see comment in StrategyInitialize */
+	size = add_size(size, BufTableShmemSize(NBuffers + NUM_BUFFER_PARTITIONS));
+
+	/* size of the shared replacement strategy control block */
+	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
+
+	// CS3223: Frame classes, one per buffer
+	size = add_size(size, mul_size(sizeof(pg_atomic_uint32), NBuffers));
+
+	// Hot frame count, cold target and shadow statistics
+	size = add_size(size, sizeof(clockpro_info));
+
+	// Shadow entries
+	size = add_size(size, mul_size(sizeof(pg_atomic_uint64), clockpro_num_shadows()));
+
+	return size;
+}
+
+/*
+ * StrategyInitialize -- initialize the buffer cache replacement
+ *		strategy.
+ *
+ * Assumes: All of the buffers are already built into a linked list.
+ *		Only called by postmaster and only during initialization.
+ */
+void
+StrategyInitialize(bool init)
+{
+	bool		found;
+
+	// CS3223: Boolean values for if shared memory alloc is successful
+	bool is_frame_class_success = false;
+	bool is_clockpro_success = false;
+	bool is_shadows_success = false;
+
+	/*
+	 * Initialize the shared buffer lookup hashtable.
+	 *
+	 * Since we can't tolerate running out of lookup table entries, we must be
+	 * sure to specify an adequate table size here.  The maximum steady-state
+	 * usage is of course NBuffers entries, but BufferAlloc() tries to insert
+	 * a new entry before deleting the old.  In principle this could be
+	 * happening in each partition concurrently, so we could need as many as
+	 * NBuffers + NUM_BUFFER_PARTITIONS entries.
+	 */
+	InitBufTable(NBuffers + NUM_BUFFER_PARTITIONS);
+
+	/*
+	 * Get or create the shared strategy control block
+	 */
+	StrategyControl = (BufferStrategyControl *)
+		ShmemInitStruct("Buffer Strategy Status",
+						sizeof(BufferStrategyControl),
+						&found);
+
+
+	// CS3223: Initialize space for our data structures
+	numShadows = clockpro_num_shadows();
+
+	frameClass = (pg_atomic_uint32 *)ShmemInitStruct("ClockPro Frame Classes",
+													mul_size(sizeof(pg_atomic_uint32), NBuffers),
+													&is_frame_class_success);
+
+	clockPro = (clockpro_info *)ShmemInitStruct("ClockPro Info", sizeof(clockpro_info), &is_clockpro_success);
+
+	shadows = (pg_atomic_uint64 *)ShmemInitStruct("ClockPro Shadows",
+												mul_size(sizeof(pg_atomic_uint64), numShadows),
+												&is_shadows_success);
+
+	if (!found)
+	{
+		/*
+		 * Only done once, usually in postmaster
+		 */
+		Assert(init);
+
+		SpinLockInit(&StrategyControl->buffer_strategy_lock);
+
+		/*
+		 * Grab the whole linked list of free buffers for our strategy. We
+		 * assume it was previously set up by InitBufferPool().
+		 */
+		StrategyControl->firstFreeBuffer = 0;
+		StrategyControl->lastFreeBuffer = NBuffers - 1;
+
+		/* Initialize the clock sweep pointer */
+		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+
+		/* Clear statistics */
+		StrategyControl->completePasses = 0;
+		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
+
+		/* No pending notification */
+		StrategyControl->bgwprocno = -1;
+
+		/* CS3223: Clear ring statistics */
+		pg_atomic_init_u64(&StrategyControl->ringReuses, 0);
+		pg_atomic_init_u64(&StrategyControl->ringEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->poolEvictions, 0);
+	}
+	else
+		Assert(!init);
+
+	// CS3223: Every frame starts cold, the cold target at half the pool, and the shadow table empty
+	if (!is_frame_class_success && !is_clockpro_success && !is_shadows_success) {
+		Assert (init);
+		for (int i = 0; i < NBuffers; i++) {
+			pg_atomic_init_u32(&frameClass[i], 0);
+		}
+
+		pg_atomic_init_u32(&clockPro->numHot, 0);
+		pg_atomic_init_u32(&clockPro->coldTarget, (uint32) Max(NBuffers / 2, 1));
+		pg_atomic_init_u32(&clockPro->evictions, 0);
+		pg_atomic_init_u64(&clockPro->shadowHits, 0);
+		pg_atomic_init_u64(&clockPro->shadowMisses, 0);
+
+		for (uint32 i = 0; i < numShadows; i++) {
+			pg_atomic_init_u64(&shadows[i], 0);
+		}
+	} else
+		Assert(!init);
+}
+
+
+/* ----------------------------------------------------------------
+ *				Backend-private buffer ring management
+ * ----------------------------------------------------------------
+ */
+
+
+/*
+ * GetAccessStrategy -- create a BufferAccessStrategy object
+ *
+ * The object is allocated in the current memory context.
+ */
+BufferAccessStrategy
+GetAccessStrategy(BufferAccessStrategyType btype)
+{
+	int			ring_size_kb;
+
+	/*
+	 * Select ring size to use.  See buffer/README for rationales.
+	 *
+	 * Note: if you change the ring size for BAS_BULKREAD, see also
+	 * SYNC_SCAN_REPORT_INTERVAL in access/heap/syncscan.c.
+	 */
+	switch (btype)
+	{
+		case BAS_NORMAL:
+			/* if someone asks for NORMAL, just give 'em a "default" object */
+			return NULL;
+
+		case BAS_BULKREAD:
+			ring_size_kb = 256;
+			break;
+		case BAS_BULKWRITE:
+			ring_size_kb = 16 * 1024;
+			break;
+		case BAS_VACUUM:
+			ring_size_kb = 256;
+			break;
+
+		default:
+			elog(ERROR, "unrecognized buffer access strategy: %d",
+				 (int) btype);
+			return NULL;		/* keep compiler quiet */
+	}
+
+	return GetAccessStrategyWithSize(btype, ring_size_kb);
+}
+
+/*
+ * GetAccessStrategyWithSize -- create a BufferAccessStrategy object with a
+ *		number of buffers equivalent to the passed in size.
+ *
+ * If the given ring size is 0, no BufferAccessStrategy will be created and
+ * the function will return NULL.  ring_size_kb must not be negative.
+ */
+BufferAccessStrategy
+GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb)
+{
+	int			ring_buffers;
+	BufferAccessStrategy strategy;
+
+	Assert(ring_size_kb >= 0);
+
+	/* Figure out how many buffers ring_size_kb is */
+	ring_buffers = ring_size_kb / (BLCKSZ / 1024);
+
+	/* 0 means unlimited, so no BufferAccessStrategy required */
+	if (ring_buffers == 0)
+		return NULL;
+
+	/* Cap to 1/8th of shared_buffers */
+	ring_buffers = Min(NBuffers / 8, ring_buffers);
+
+	/* NBuffers should never be less than 16, so this shouldn't happen */
+	Assert(ring_buffers > 0);
+
+	/* Allocate the object and initialize all elements to zeroes */
+	strategy = (BufferAccessStrategy)
+		palloc0(offsetof(BufferAccessStrategyData, buffers) +
+				ring_buffers * sizeof(Buffer));
+
+	/* Set fields that don't start out zero */
+	strategy->btype = btype;
+	strategy->nbuffers = ring_buffers;
+
+	return strategy;
+}
+
+/*
+ * GetAccessStrategyBufferCount -- an accessor for the number of buffers in
+ *		the ring
+ *
+ * Returns 0 on NULL input to match behavior of GetAccessStrategyWithSize()
+ * returning NULL with 0 size.
+ */
+int
+GetAccessStrategyBufferCount(BufferAccessStrategy strategy)
+{
+	if (strategy == NULL)
+		return 0;
+
+	return strategy->nbuffers;
+}
+
+/*
+ * FreeAccessStrategy -- release a BufferAccessStrategy object
+ *
+ * A simple pfree would do at the moment, but we would prefer that callers
+ * don't assume that much about the representation of BufferAccessStrategy.
+ */
+void
+FreeAccessStrategy(BufferAccessStrategy strategy)
+{
+	/* don't crash if called on a "default" strategy */
+	if (strategy != NULL)
+		pfree(strategy);
+}
+
+/*
+ * GetBufferFromRing -- returns a buffer from the ring, or NULL if the
+ *		ring is empty / not usable.
+ *
+ * The bufhdr spin lock is held on the returned buffer.
+ */
+static BufferDesc *
+GetBufferFromRing(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	Buffer		bufnum;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+
+	/* Advance to next ring slot */
+	if (++strategy->current >= strategy->nbuffers)
+		strategy->current = 0;
+
+	/*
+	 * If the slot hasn't been filled yet, tell the caller to allocate a new
+	 * buffer with the normal allocation strategy.  He will then fill this
+	 * slot by calling AddBufferToRing with the new buffer.
+	 */
+	bufnum = strategy->buffers[strategy->current];
+	if (bufnum == InvalidBuffer)
+		return NULL;
+
+	/*
+	 * If the buffer is pinned we cannot use it under any circumstances.
+	 *
+	 * If usage_count is 0 or 1 then the buffer is fair game (we expect 1,
+	 * since our own previous usage of the ring element would have left it
+	 * there, but it might've been decremented by clock sweep since then). A
+	 * higher usage_count indicates someone else has touched the buffer, so we
+	 * shouldn't re-use it.
+	 */
+	buf = GetBufferDescriptor(bufnum - 1);
+	local_buf_state = LockBufHdr(buf);
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+		&& BUF_STATE_GET_USAGECOUNT(local_buf_state) <= 1)
+	{
+		*buf_state = local_buf_state;
+		return buf;
+	}
+	UnlockBufHdr(buf, local_buf_state);
+
+	/*
+	 * Tell caller to allocate a new buffer with the normal allocation
+	 * strategy.  He'll then replace this ring element via AddBufferToRing.
+	 */
+	return NULL;
+}
+
+/*
+ * AddBufferToRing -- add a buffer to the buffer ring
+ *
+ * Caller must hold the buffer header spinlock on the buffer.  Since this
+ * is called with the spinlock held, it had better be quite cheap.
+ */
+static void
+AddBufferToRing(BufferAccessStrategy strategy, BufferDesc *buf)
+{
+	strategy->buffers[strategy->current] = BufferDescriptorGetBuffer(buf);
+}
+
+/*
+ * Utility function returning the IOContext of a given BufferAccessStrategy's
+ * strategy ring.
+ */
+IOContext
+IOContextForStrategy(BufferAccessStrategy strategy)
+{
+	if (!strategy)
+		return IOCONTEXT_NORMAL;
+
+	switch (strategy->btype)
+	{
+		case BAS_NORMAL:
+
+			/*
+			 * Currently, GetAccessStrategy() returns NULL for
+			 * BufferAccessStrategyType BAS_NORMAL, so this case is
+			 * unreachable.
+			 */
+			pg_unreachable();
+			return IOCONTEXT_NORMAL;
+		case BAS_BULKREAD:
+			return IOCONTEXT_BULKREAD;
+		case BAS_BULKWRITE:
+			return IOCONTEXT_BULKWRITE;
+		case BAS_VACUUM:
+			return IOCONTEXT_VACUUM;
+	}
+
+	elog(ERROR, "unrecognized BufferAccessStrategyType: %d", strategy->btype);
+	pg_unreachable();
+}
+
+/*
+ * StrategyRejectBuffer -- consider rejecting a dirty buffer
+ *
+ * When a nondefault strategy is used, the buffer manager calls this function
+ * when it turns out that the buffer selected by StrategyGetBuffer needs to
+ * be written out and doing so would require flushing WAL too.  This gives us
+ * a chance to choose a different victim.
+ *
+ * Returns true if buffer manager should ask for a new victim, and false
+ * if this buffer should be written and re-used.
+ */
+bool
+StrategyRejectBuffer(BufferAccessStrategy strategy, BufferDesc *buf, bool from_ring)
+{
+	/* We only do this in bulkread mode */
+	if (strategy->btype != BAS_BULKREAD)
+		return false;
+
+	/* Don't muck with behavior of normal buffer-replacement strategy */
+	if (!from_ring ||
+		strategy->buffers[strategy->current] != BufferDescriptorGetBuffer(buf))
+		return false;
+
+	/*
+	 * Remove the dirty buffer from the ring; necessary to prevent infinite
+	 * loop if all ring members are dirty.
+	 */
+	strategy->buffers[strategy->current] = InvalidBuffer;
+
+	return true;
+}
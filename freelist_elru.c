@@ -15,8 +15,12 @@
  */
 #include "postgres.h"
 
+#include "access/xact.h"
+#include "common/hashfn.h"
+#include "common/pg_prng.h"
 #include "pgstat.h"
 #include "port/atomics.h"
+#include "port/pg_bitutils.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/proc.h"
@@ -28,444 +32,1721 @@
 #define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
 #define SECOND_LAST_ACCESS 0
 #define FIRST_LAST_ACCESS 1
-#define ADDITIONAL_BUFFER 1000000
+#define ELRU_MAX_K 8                    // Upper bound for elru_k
+#define ELRU_B2_NUM_BUCKETS 64          // Number of buckets in the B2 timing wheel
+#define ELRU_ACCESS_RING_MAX 64         // Upper bound for elru_access_ring_size
+#define ELRU_CLOCK_BATCH_MAX 1024       // Upper bound for elru_clock_batch
+#define VICTIM_QUEUE_SCAN_FACTOR 4      // A refill looks at up to this many frames per victim it wants
+#define VICTIM_QUEUE_LOW_WATER 4        // The bgwriter is woken once the victim queue is down to 1/4 of its capacity
+#define SKETCH_DEPTH 4                  // Rows of the admission sketch, each page has one counter in every row
+#define SKETCH_COUNTERS_PER_BUFFER 2    // Counters in every row of the admission sketch per buffer
+#define SKETCH_COUNTER_MAX 15           // Sketch counters are 4 bits, 16 to a 64-bit word
+#define SKETCH_COUNTERS_PER_WORD 16
+#define SKETCH_SAMPLE_FACTOR 4          // The sketch is aged once every SKETCH_SAMPLE_FACTOR hits per counter in a row
+#define DOORKEEPER_BITS_PER_COUNTER 8   // Doorkeeper bits per counter in a row
 
 /*********************************************/
 // CS3223 - Data Structure declarations
+
+// List membership tag for every node, so a frame can be found by buf_id in O(1)
+#define LIST_NONE 0
+#define LIST_B1 1
+#define LIST_B2 2
+
+// Nodes are linked by buf_id (32 bits) instead of by pointer
+#define NIL_FRAME (-1)
+#define FRAME_ID(frame) ((int32) ((frame) - doubleLinkedList))
+
+// Access stamps in time_array are 32 bits, relative to the epoch of the frame's partition. Once the counter gets
+// ELRU_EPOCH_LIMIT ticks past that epoch, it moves forward by ELRU_EPOCH_SHIFT and the partition's stamps are rebased.
+#define ELRU_EPOCH_LIMIT (UINT64CONST(1) << 31)
+#define ELRU_EPOCH_SHIFT (UINT64CONST(1) << 30)
+#define ELRU_MAX_BUCKET_WIDTH (1 << 20)    // Keeps ELRU_B2_NUM_BUCKETS whole buckets inside one ELRU_EPOCH_SHIFT
+
+// The logical clock. Ticked once per StrategyAccessBuffer / StrategyGetBuffer call with an atomic add, so no lock is
+// needed to take a timestamp.
 typedef struct counter_info {
-	uint64_t counter;
-	slock_t counter_spinlock;
+	pg_atomic_uint64 counter;
 } counter_info;
 
+// 16 bytes per buffer, four to a cache line. The stamps are kept apart in frameStamps, so a walk of B1 or of a B2
+// bucket only touches the nodes; the stamps are only read once a frame is compared or moved.
 typedef struct node {
-	struct node* prev;
-	struct node* next;
-	int frame_id;
-	uint64_t time_array[2];
-	int sanity_check;
+	int32 prev;                        // buf_id of the previous node in B1 / B2 bucket, or NIL_FRAME
+	int32 next;                        // buf_id of the next node in B1 / B2 bucket, or NIL_FRAME
+	uint8 list;                        // LIST_NONE, LIST_B1 or LIST_B2
+	bool ring;                         // Placed at the tail of B1 for a BufferAccessStrategy ring, see place_ring_frame
+	bool fresh;                        // In B1 with a page that has not been hit since it was loaded, see recall_history
+	int32 heap_index;                  // Slot in the partition's B2 heap, only valid while list == LIST_B2
 } node;
 
+typedef struct frame_stamps {
+	uint32 time_array[2];              // Last and K-th last access (the 2nd last for K = 2), see get_history
+} frame_stamps;
+
 typedef struct info {
-	struct node* head;
-	struct node* tail;
+	int32 head;                        // buf_id of the head node, or NIL_FRAME
+	int32 tail;                        // buf_id of the tail node, or NIL_FRAME
 	int size;
-	slock_t linkedListInfo_spinlock;
+	LWLock linkedListInfo_lock;        // Exclusive to change the list, shared to walk it
 } info;
 
-static node* doubleLinkedList = NULL; 			//Make Global Declare it in InitializeStructure
-static node* otherDoubleLinkedList = NULL;      // B2
-static info* linkedListInfo = NULL;
-static info* otherLinkedListInfo = NULL;       // B2
+// One bucket of the B2 timing wheel, a list of B2 frames with the most recently inserted at the head
+typedef struct b2_bucket {
+	int32 head;                        // buf_id of the head node, or NIL_FRAME
+	int32 tail;                        // buf_id of the tail node, or NIL_FRAME
+	int size;
+} b2_bucket;
+
+// B2 timing wheel, used instead of the B2 heap when elru_b2_bucket_width > 0. Protected by the partition's B2 lock.
+// A frame belongs to the bucket of epoch Max(time_array[SECOND_LAST_ACCESS] / width, base_epoch), so the bucket
+// never has to be stored in the node: buckets older than base_epoch have been folded into the base bucket.
+typedef struct b2_wheel {
+	uint64_t width;                              // Counter ticks covered by one bucket (0 means B2 is the exact heap)
+	uint64_t base_epoch;                         // Epoch of the oldest bucket in the wheel
+	b2_bucket buckets[ELRU_B2_NUM_BUCKETS];      // Bucket for epoch e is buckets[e % ELRU_B2_NUM_BUCKETS]
+} b2_wheel;
+
+// The ELRU lists are split into numPartitions partitions and frame buf_id always belongs to partition
+// buf_id % numPartitions. Each partition is a complete ELRU of its own (B1, B2 and the epoch its stamps are
+// relative to) behind its own locks, so backends working on different partitions never contend.
+// Lock order is B1 then B2 of one partition, then history_lock, then a buffer header lock. No LWLock is taken while a
+// buffer header lock or a spinlock is held, and no code path holds the locks of two partitions at once.
+typedef struct partition_info {
+	info b1;                           // B1, head is the most recently used frame
+	info b2;                           // B2 (head/tail unused, size is the number of B2 entries)
+	int heap_base;                     // The partition's B2 heap is b2Heap[heap_base .. heap_base + b2.size - 1]
+	uint64_t epoch;                    // Counter value that the partition's time_array stamps are relative to
+	b2_wheel wheel;                    // B2 in bucket mode
+} partition_info;
+
+static node* doubleLinkedList = NULL; 			// Indexed by buf_id, NBuffers nodes shared by B1 and B2 (a frame is in at most one)
+static frame_stamps* frameStamps = NULL;       // Indexed by buf_id, like doubleLinkedList
+static partition_info* partitionInfo = NULL;   // numPartitions entries
+static int* b2Heap = NULL;                     // B2 of every partition as indexed min-heaps of buf_ids, keyed on time_array[SECOND_LAST_ACCESS]
 static counter_info* counterInfo = NULL;
+static int numPartitions = 1;                  // elru_num_partitions as latched by StrategyInitialize
+
+#define PARTITION_OF(frame_id) (&partitionInfo[(frame_id) % numPartitions])
+#define TIME_ARRAY(frame) (frameStamps[FRAME_ID(frame)].time_array)
+
+// Victims the bgwriter picked in advance, B1 tails first and then B2 in victim order, so that StrategyGetBuffer can
+// usually take one in O(1) instead of searching B1 and B2. Entries are only hints: the list tag and stamps are the
+// frame's version when it was picked, and an entry whose frame has been moved or pinned since is dropped when popped.
+typedef struct victim_entry {
+	int32 buf_id;
+	uint8 list;
+	uint32 time_array[2];
+} victim_entry;
+
+typedef struct victim_queue {
+	slock_t victimQueue_spinlock;      // Protects head, count and entries
+	int head;                          // Slot of the next entry to pop
+	int count;                         // Entries left to pop, entries[head .. head + count - 1]
+	int capacity;                      // elru_victim_queue_size as latched by StrategyInitialize, 0 if disabled
+	int bgwprocno;                     // pgprocno of the bgwriter that refills the queue, or -1
+	pg_atomic_uint32 refill_requested; // Set once the queue runs low, cleared by the next refill
+	victim_entry entries[FLEXIBLE_ARRAY_MEMBER];
+} victim_queue;
+
+static victim_queue* victimQueue = NULL;
+
+// Admission filter: the count-min sketch and doorkeeper of freelist_lru.c, see admission_sketch there
+typedef struct admission_sketch {
+	uint32 width;                      // Counters per row, a power of 2, 0 if the filter is off
+	uint32 sample_size;                // Hits recorded between two agings
+	pg_atomic_uint32 samples;          // Hits recorded since the last aging
+	pg_atomic_uint64 admissions;       // B1 frames that beat the B2 victim and went to B2
+	pg_atomic_uint64 rejections;       // B1 frames that were evicted
+	pg_atomic_uint64 words[FLEXIBLE_ARRAY_MEMBER];   // SKETCH_DEPTH rows of counters, then the doorkeeper
+} admission_sketch;
+
+static admission_sketch* admissionSketch = NULL;
+static bool admissionFilter = false;           // elru_admission_filter as latched by StrategyInitialize
+
+// LRU-K: B2 is ordered on the K-th last access of every frame, and a frame stays in B1 until it has been accessed K
+// times. frameStamps only has room for the last and the K-th last access, which is all that victim search reads; for
+// K > 2 the stamps in between are kept in middleStamps.
+static uint32* middleStamps = NULL;            // Indexed by buf_id * (historyDepth - 2), none for K = 2
+static int historyDepth = 2;                   // elru_k as latched by StrategyInitialize
+
+#define MIDDLE_STAMPS(frame_id) (&middleStamps[(frame_id) * (historyDepth - 2)])
+
+// Retained history: the stamps of pages evicted lately, keyed by BufferTag, so that a page read back in soon after it
+// was evicted carries on with the history it had instead of starting out as if it had never been seen (the retained
+// information period of LRU-K). Entries are kept in a ring of slots in FIFO order, a slot being reused once the ring
+// comes round to it again, and are chained by hash of their tag. Their stamps are absolute counter values, as the page
+// may come back into a frame of another partition: historyStamps[slot * historyDepth + i] is its (i + 1)-th last
+// access, 0 if it had none.
+typedef struct history_entry {
+	BufferTag tag;
+	int32 hash_next;                   // Slot of the next entry in the same hash bucket, or NIL_FRAME
+	bool valid;                        // False while the slot is unused, or once its page was read back in
+} history_entry;
+
+typedef struct history_table {
+	int capacity;                      // Number of slots, 0 if the retained history is off
+	int next;                          // Slot the next entry goes into
+	uint32 num_buckets;                // Power of two, at least capacity
+	LWLock history_lock;               // Exclusive to look up or add an entry
+} history_table;
+
+static history_table* historyTable = NULL;
+static history_entry* historyEntries = NULL;   // capacity slots
+static int32* historyBuckets = NULL;           // num_buckets heads of slot chains
+static uint64_t* historyStamps = NULL;         // historyDepth stamps per slot
+
 node* search_for_frame(int desired_frame_id);
 void delete_arbitrarily(int frame_id_for_deletion);
 void insert_at_head(node* frame);
+void link_at_head(node* frame);
 void move_to_head(node* frame);       // Case 1 - Called by StrategyAccessBuffer(..., false) in bufmgr_lru.c
+void insert_at_tail(node* frame);
+void move_to_tail(node* frame);       // Victims taken for a BufferAccessStrategy ring
 
 //Pre-declare functions
+void unlink_frame(info* list_info, node* frame);
 void insert_into_b2(node* frame);
-void move_to_head_b2(node* frame);
+void place_by_history(node* frame);
 void delete_other_arbitrarily(int frame_id_for_deletion);
 node* search_for_frame_b2(int desired_frame_id);
-node* search_for_frame_before(int desired_frame_id);
-node* search_for_frame_after(int desired_frame_id);
+bool b2_heap_less(partition_info* part, int index_a, int index_b);
+void b2_heap_swap(partition_info* part, int index_a, int index_b);
+void b2_heap_sift_up(partition_info* part, int index);
+void b2_heap_sift_down(partition_info* part, int index);
+void b2_heap_stash_root(partition_info* part);
+void b2_heap_restore_stash(partition_info* part, int num_stashed);
+b2_bucket* b2_bucket_of(node* frame);
+void b2_bucket_unlink(b2_bucket* bucket, node* frame);
+void b2_wheel_advance(partition_info* part, uint64_t epoch);
+void b2_bucket_insert(node* frame);
+int32 get_victim_from_b2_heap(partition_info* part);
+int32 get_victim_from_b2_buckets(partition_info* part);
+BufferDesc* claim_victim(const victim_entry* seen, bool for_ring, uint32* buf_state);
+void see_frame(int32 frame_id, victim_entry* seen);
+bool get_victim_from_b2(int start_partition, victim_entry* victim);
 void update_time(node* frame);
+void rebase_time(partition_info* part, uint64_t counter);
+int elru_partition_count(void);
+bool record_access(int buf_id);
+void flush_access_ring(void);
+void access_ring_xact_callback(XactEvent event, void* arg);
+void clock_tick(void);
+uint64_t clock_now(void);
+bool skip_promotion(int buf_id);
+bool skip_correlated(int buf_id);
+bool skip_ring_promotion(int buf_id);
+int32 find_clean_victim(int32 dirty_frame_id);
+int elru_victim_queue_capacity(void);
+Size victim_queue_shmem_size(int capacity);
+void consider_victim(int32 frame_id, victim_entry* out, int* num_picked, victim_entry* dirty, int* num_dirty, int quota, bool prefer_clean);
+int pick_victims(partition_info* part, victim_entry* out, int quota, bool prefer_clean);
+int collect_victims(victim_entry* out, int max_victims, bool prefer_clean, int start_partition);
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions);
+void request_victim_queue_refill(void);
+BufferDesc* pop_victim(uint32* buf_state, bool for_ring);
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions);
+void place_ring_frame(int buf_id);
+void release_ring_frame(int buf_id);
+uint32 admission_sketch_width(void);
+Size admission_sketch_shmem_size(uint32 width);
+void sketch_increment(uint32 row, uint32 index);
+uint32 sketch_estimate(uint32 hash);
+void sketch_age(void);
+void record_frequency(int buf_id);
+uint32 frame_frequency(int32 frame_id);
+bool find_admission_rival(const victim_entry* victim, victim_entry* rival);
+bool apply_admission(const victim_entry* victim, const victim_entry* rival);
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections);
+void StrategyCorrelationStats(uint64* correlated_references);
+int elru_history_depth(void);
+int elru_history_capacity(void);
+uint32 history_num_buckets(int capacity);
+void get_history(node* frame, uint32* stamps);
+void set_history(node* frame, const uint32* stamps);
+void clear_history(node* frame);
+uint32 history_bucket_of(const BufferTag* tag);
+int32 history_lookup(const BufferTag* tag);
+void history_unlink(int slot);
+void save_history(node* frame, const BufferTag* tag);
+bool restore_history(node* frame, const BufferTag* tag);
+void recall_history(node* frame);
+
+// CS3223: The GUCs below are defined in bufmgr.c, see the GUCs in freelist_lru.c
+
+// CS3223 - GUC (PGC_POSTMASTER): counter ticks grouped into one B2 bucket. 0 keeps B2 exactly ordered (b2Heap);
+// a positive value trades LRU-2 precision for O(1) B2 maintenance using the timing wheel (partition_info.wheel).
+extern PGDLLIMPORT int elru_b2_bucket_width;
+
+// CS3223 - GUC (PGC_POSTMASTER): number of independently locked ELRU partitions, at most NUM_BUFFER_PARTITIONS.
+// 1 keeps a single exact ELRU; more partitions trade global LRU-2 order for less lock contention.
+extern PGDLLIMPORT int elru_num_partitions;
+
+// CS3223 - GUC (PGC_USERSET): number of re-references a backend collects before applying them to B1/B2 in one go.
+// 0 applies every access immediately. See record_access.
+extern PGDLLIMPORT int elru_access_ring_size;
+
+// Per-backend ring of re-referenced buf_ids that have not been applied to B1/B2 yet
+static int accessRing[ELRU_ACCESS_RING_MAX];
+static int accessRingCount = 0;
+static bool accessRingCallbackRegistered = false;
+
+// CS3223 - GUC (PGC_USERSET): number of clock ticks a backend reserves from the shared counter at a time.
+// 1 (the default) ticks the shared counter on every access. A larger value only touches the shared counter once
+// every elru_clock_batch accesses, at the price of stamps from different backends being up to that far out of order.
+extern PGDLLIMPORT int elru_clock_batch;
+
+// CS3223 - GUC (PGC_USERSET): a B2 frame re-referenced within this percentage of NBuffers clock ticks of its last
+// access is left alone. 0 applies every re-reference. See skip_promotion.
+extern PGDLLIMPORT int elru_promotion_filter;
+
+// CS3223 - GUC (PGC_USERSET): percentage chance that a re-reference inside the elru_promotion_filter window is applied anyway
+extern PGDLLIMPORT int elru_promotion_probability;
+
+// CS3223 - GUC (PGC_USERSET): correlated reference period, as a percentage of NBuffers clock ticks (up to 100). A
+// reference to a B1 or B2 frame within that many ticks of its last access does not count. 0 counts every reference.
+// See skip_correlated.
+extern PGDLLIMPORT int elru_correlated_period;
+
+// CS3223 - GUC (PGC_POSTMASTER): number of victims the bgwriter keeps picked in advance, at most NBuffers.
+// 0 disables the victim queue, so every StrategyGetBuffer searches B1 and B2. See StrategyRefillVictimQueue.
+extern PGDLLIMPORT int elru_victim_queue_size;
+
+// CS3223 - GUC (PGC_USERSET): number of unpinned candidates from the tail of B1 that victim search looks at when the
+// first one is dirty, to substitute a clean one that the backend need not write out first. 0 or 1 evicts the first one.
+extern PGDLLIMPORT int elru_dirty_lookahead;
+
+// CS3223 - GUC (PGC_USERSET): how much younger than the true B1 victim a clean substitute may be, as a percentage
+// of NBuffers clock ticks. See find_clean_victim.
+extern PGDLLIMPORT int elru_dirty_age_tolerance;
+
+// CS3223 - GUC (PGC_POSTMASTER): let a B1 frame that is up for eviction stay if the admission sketch says its page is
+// more popular than that of the B2 victim, which is evicted in its place. See apply_admission.
+extern PGDLLIMPORT bool elru_admission_filter;
+
+// CS3223 - GUC (PGC_POSTMASTER): K of LRU-K, from 2 to ELRU_MAX_K. 2 is the classic ELRU, where a frame goes to B2 on
+// its second access. A larger K takes longer to trust a page, and keeps K - 2 more stamps per buffer.
+extern PGDLLIMPORT int elru_k;
+
+// CS3223 - GUC (PGC_POSTMASTER): number of evicted pages whose history is retained, as a percentage of NBuffers, up to
+// 400. 0 turns the retained history off, so a page read back in starts with no history. See save_history.
+extern PGDLLIMPORT int elru_history_percent;
+
+// CS3223 - GUC (PGC_USERSET): retained information period, as a percentage of NBuffers clock ticks. The retained
+// history of a page last accessed longer ago than that is not used. 0 uses it for as long as it is retained.
+extern PGDLLIMPORT int elru_retained_period;
+
+// Per-backend slice of the logical clock reserved by clock_tick when elru_clock_batch > 1
+static uint64_t localClockNow = 0;     // Last tick handed out to this backend
+static uint64_t localClockEnd = 0;     // End (exclusive) of the reserved slice
 
 /*********************************************/
 // CS3223 - Function definitions
 
-// Traverse through linkedListInfo for frame corresponding to some 'frame_id'
+// Number of partitions to use, elru_num_partitions clamped to [1, Min(NUM_BUFFER_PARTITIONS, NBuffers)]
+int elru_partition_count(void) {
+	return Min(Max(elru_num_partitions, 1), Min(NUM_BUFFER_PARTITIONS, NBuffers));
+}
+
+// Look up the node for 'desired_frame_id' in O(1); returns NULL if the frame is not in B1
 node* search_for_frame(int desired_frame_id) {
-	//elog(LOG, "Searching for frame %d in B1", desired_frame_id);
-	node* traversal_ptr;
+	node* frame = &doubleLinkedList[desired_frame_id];
+
+	if (frame->list != LIST_B1) {
+		return NULL;
+	}
+
+	return frame;
+}
 
-	if (linkedListInfo->head == NULL) { 
-		//elog(ERROR, "linkedListInfo is empty");
-		//elog(LOG, "B1 is empty");
-		return NULL; // Handle empty list case properly
+// Unlink a frame from the list described by 'list_info' in O(1)
+void unlink_frame(info* list_info, node* frame) {
+	if (frame->prev != NIL_FRAME) {
+		doubleLinkedList[frame->prev].next = frame->next;
 	} else {
-		traversal_ptr = linkedListInfo->head;
+		list_info->head = frame->next;
+	}
 
-		while (traversal_ptr != NULL) {
-			if (traversal_ptr->frame_id == desired_frame_id) {
-				//elog(LOG, "Frame %d found in B1", desired_frame_id);
-				return traversal_ptr;
-			}
+	if (frame->next != NIL_FRAME) {
+		doubleLinkedList[frame->next].prev = frame->prev;
+	} else {
+		list_info->tail = frame->prev;
+	}
+
+	frame->prev = NIL_FRAME;
+	frame->next = NIL_FRAME;
+	frame->list = LIST_NONE;
+	frame->ring = false;
+	frame->fresh = false;
+	list_info->size--;
+}
+
+void delete_arbitrarily(int frame_id_for_deletion) {
+	node* frame_for_deletion = search_for_frame(frame_id_for_deletion);
+
+	if (!frame_for_deletion) { // Handle case where frame is not in B1
+		return;
+	}
+
+	unlink_frame(&PARTITION_OF(frame_id_for_deletion)->b1, frame_for_deletion);
+}
+
+// Stamp a frame (which must not be in B1 or B2) and link it at the head of its partition's B1
+void insert_at_head(node* frame) { 
+	// Update time_array
+	update_time(frame);
+
+	link_at_head(frame);
+}
+
+// Link a frame (which must not be in B1 or B2) at the head of its partition's B1, leaving its stamps as they are
+void link_at_head(node* frame) {
+	info* list_info = &PARTITION_OF(FRAME_ID(frame))->b1;
+
+	Assert(frame->list == LIST_NONE);
+
+	frame->prev = NIL_FRAME;
+	frame->next = list_info->head; 
+	if (list_info->head != NIL_FRAME) { // Check if list is not empty
+		doubleLinkedList[list_info->head].prev = FRAME_ID(frame); 
+	}
+
+	list_info->head = FRAME_ID(frame); 
+
+	if (list_info->tail == NIL_FRAME) { // If list was empty, update tail as well
+		list_info->tail = FRAME_ID(frame);
+	}
+
+	frame->list = LIST_B1;
+	frame->ring = false;
+	list_info->size++;
+} 
+
+void move_to_head(node* frame) { 
+	delete_arbitrarily(FRAME_ID(frame));
+	delete_other_arbitrarily(FRAME_ID(frame));
+	insert_at_head(frame); 
+}
+
+// Link a frame (which must not be in B1 or B2) at the tail of its partition's B1, for a strategy's ring. It is still
+// stamped, since victim search uses the stamps as the frame's version.
+void insert_at_tail(node* frame) {
+	info* list_info = &PARTITION_OF(FRAME_ID(frame))->b1;
+
+	Assert(frame->list == LIST_NONE);
+
+	update_time(frame);
+
+	frame->next = NIL_FRAME;
+	frame->prev = list_info->tail;
+	if (list_info->tail != NIL_FRAME) { // Check if list is not empty
+		doubleLinkedList[list_info->tail].next = FRAME_ID(frame);
+	}
+	list_info->tail = FRAME_ID(frame);
 
-			traversal_ptr = traversal_ptr->next;
+	if (list_info->head == NIL_FRAME) { // If list was empty, update head as well
+		list_info->head = FRAME_ID(frame);
+	}
+
+	frame->list = LIST_B1;
+	frame->ring = true;
+	list_info->size++;
+}
+
+void move_to_tail(node* frame) {
+	delete_arbitrarily(FRAME_ID(frame));
+	delete_other_arbitrarily(FRAME_ID(frame));
+	insert_at_tail(frame);
+}
+
+// See place_ring_frame in freelist_lru.c. Ring buffers are kept at the tail of B1, so they never get into B2.
+void place_ring_frame(int buf_id) {
+	partition_info* part = PARTITION_OF(buf_id);
+	node* frame = &doubleLinkedList[buf_id];
+
+	LWLockAcquire(&part->b1.linkedListInfo_lock, LW_EXCLUSIVE);
+	LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
+
+	// The frame is getting a new page (from the freelist, or recycled by the ring), which starts out with no history
+	// of its own. It leaves B2 before its stamps are cleared, as its B2 bucket is derived from them.
+	delete_arbitrarily(buf_id);
+	delete_other_arbitrarily(buf_id);
+	clear_history(frame);
+	insert_at_tail(frame);
+	frame->fresh = true;
+
+	LWLockRelease(&part->b2.linkedListInfo_lock);
+	LWLockRelease(&part->b1.linkedListInfo_lock);
+}
+
+// Called by StrategyRejectBuffer once a ring has given up a buffer. The frame stays where it is, but its next access
+// counts like any other B1 frame's.
+void release_ring_frame(int buf_id) {
+	partition_info* part = PARTITION_OF(buf_id);
+
+	LWLockAcquire(&part->b1.linkedListInfo_lock, LW_EXCLUSIVE);
+	doubleLinkedList[buf_id].ring = false;
+	LWLockRelease(&part->b1.linkedListInfo_lock);
+}
+
+// B2 - Function definitions
+
+// B2 of a partition is kept as a binary min-heap of buf_ids, stored in b2Heap starting at part->heap_base and
+// ranked on the 2nd last accessed time i.e time_array[SECOND_LAST_ACCESS]. The root is the frame with the lowest rank
+// (the oldest 2nd last access), which is the partition's next B2 victim. Every node remembers its own slot
+// (heap_index), so a re-referenced or deleted frame can be repositioned in O(log n) without searching.
+// part->b2.size is the number of heap entries.
+
+// True if the frame at heap slot 'index_a' ranks below the frame at 'index_b' (ties broken on the last access)
+bool b2_heap_less(partition_info* part, int index_a, int index_b) {
+	int* heap = b2Heap + part->heap_base;
+	node* a = &doubleLinkedList[heap[index_a]];
+	node* b = &doubleLinkedList[heap[index_b]];
+
+	if (TIME_ARRAY(a)[SECOND_LAST_ACCESS] != TIME_ARRAY(b)[SECOND_LAST_ACCESS]) {
+		return TIME_ARRAY(a)[SECOND_LAST_ACCESS] < TIME_ARRAY(b)[SECOND_LAST_ACCESS];
+	}
+
+	return TIME_ARRAY(a)[FIRST_LAST_ACCESS] < TIME_ARRAY(b)[FIRST_LAST_ACCESS];
+}
+
+void b2_heap_swap(partition_info* part, int index_a, int index_b) {
+	int* heap = b2Heap + part->heap_base;
+	int frame_id_a = heap[index_a];
+
+	heap[index_a] = heap[index_b];
+	heap[index_b] = frame_id_a;
+	doubleLinkedList[heap[index_a]].heap_index = index_a;
+	doubleLinkedList[heap[index_b]].heap_index = index_b;
+}
+
+void b2_heap_sift_up(partition_info* part, int index) {
+	while (index > 0) {
+		int parent = (index - 1) / 2;
+
+		if (!b2_heap_less(part, index, parent)) {
+			break;
 		}
+
+		b2_heap_swap(part, index, parent);
+		index = parent;
 	}
+}
+
+void b2_heap_sift_down(partition_info* part, int index) {
+	int size = part->b2.size;
 
-	//elog(LOG, "B1 is not empty but Frame %d not found in B1", desired_frame_id);
-	return NULL; // Return NULL if frame_id not found
+	for (;;) {
+		int smallest = index;
+		int left = 2 * index + 1;
+		int right = left + 1;
+
+		if (left < size && b2_heap_less(part, left, smallest)) {
+			smallest = left;
+		}
+		if (right < size && b2_heap_less(part, right, smallest)) {
+			smallest = right;
+		}
+		if (smallest == index) {
+			break;
+		}
+
+		b2_heap_swap(part, index, smallest);
+		index = smallest;
+	}
 }
 
-void delete_arbitrarily(int frame_id_for_deletion) {
-	//elog(LOG, "Deleting frame %d from B1", frame_id_for_deletion);
-	//log_linked_list(linkedListInfo);
- 	node* frame_for_deletion = search_for_frame(frame_id_for_deletion);
+// Re-reference of a frame in B1 or B2. Its time_array is updated and it is (re)positioned in B2 in O(log n), or at
+// the head of B1 if it has still been accessed fewer than K times. A frame coming from B1 is unlinked from B1 first.
+void insert_into_b2(node* frame) {
+	partition_info* part = PARTITION_OF(FRAME_ID(frame));
+
+	if (part->wheel.width > 0) {
+		// Bucket mode - the current bucket is derived from the old time_array, so unlink before updating it
+		delete_other_arbitrarily(FRAME_ID(frame));
+	}
+
+	// Update time array for frame
+	update_time(frame);
+
+	place_by_history(frame);
+}
+
+// Put a frame where its stamps say it belongs: in B2 once it has a K-th last access, at the head of B1 until then.
+// The frame may be in B1, in neither list, or in the B2 heap if its stamps have only grown since it was put there.
+// In bucket mode a B2 frame must be taken out of its bucket before its stamps change.
+void place_by_history(node* frame) {
+	partition_info* part = PARTITION_OF(FRAME_ID(frame));
+
+	if (frame->list == LIST_B2) {
+		// time_array[SECOND_LAST_ACCESS] only ever grows, so the frame can only move down the heap
+		b2_heap_sift_down(part, frame->heap_index);
+		return;
+	}
+
+	delete_arbitrarily(FRAME_ID(frame));
 
-	if (!frame_for_deletion) { // Handle case where frame is not found
-		//elog(LOG, "Frame %d not found in B1", frame_id_for_deletion);
+	if (TIME_ARRAY(frame)[SECOND_LAST_ACCESS] == 0) {
+		// Accessed fewer than K times so far, which for K = 2 never happens here
+		link_at_head(frame);
 		return;
 	}
 
-	//log prev and next frame of frame_for_deletion, print null if either are null
-	if (frame_for_deletion->prev && frame_for_deletion->next) {
-		//elog(LOG, "Prev frame of frame %d: %d, Next frame of frame %d: %d", frame_id_for_deletion, frame_for_deletion->prev->frame_id, frame_id_for_deletion, frame_for_deletion->next->frame_id);
-	} else if (frame_for_deletion->prev) {
-		//elog(LOG, "Prev frame of frame %d: %d, Next frame of frame %d: NULL", frame_id_for_deletion, frame_for_deletion->prev->frame_id, frame_id_for_deletion);
-	} else if (frame_for_deletion->next) {
-		//elog(LOG, "Prev frame of frame %d: NULL, Next frame of frame %d: %d", frame_id_for_deletion, frame_id_for_deletion, frame_for_deletion->next->frame_id);
+	if (part->wheel.width > 0) {
+		b2_bucket_insert(frame);
+		return;
+	}
+
+	frame->list = LIST_B2;
+	frame->heap_index = part->b2.size;
+	b2Heap[part->heap_base + part->b2.size++] = FRAME_ID(frame);
+	b2_heap_sift_up(part, frame->heap_index);
+}
+
+// Remove a frame from B2 in O(log n), by moving the last heap entry into its slot
+void delete_other_arbitrarily(int frame_id_for_deletion) {
+	node* frame_for_deletion = search_for_frame_b2(frame_id_for_deletion);
+	partition_info* part = PARTITION_OF(frame_id_for_deletion);
+	int index;
+	int last;
+
+	if (!frame_for_deletion) { // Handle case where frame is not in B2
+		return;
+	}
+
+	if (part->wheel.width > 0) {
+		b2_bucket_unlink(b2_bucket_of(frame_for_deletion), frame_for_deletion);
+		part->b2.size--;
+		return;
+	}
+
+	index = frame_for_deletion->heap_index;
+	last = --part->b2.size;
+	if (index != last) {
+		b2_heap_swap(part, index, last);
+		b2_heap_sift_up(part, index);
+		b2_heap_sift_down(part, index);
+	}
+
+	frame_for_deletion->list = LIST_NONE;
+	frame_for_deletion->heap_index = -1;
+}
+
+// Used by get_victim_from_b2_heap when the root of B2 is pinned: the root is moved just past the end of the heap
+// (as in heapsort) so that the next lowest ranked frame becomes the root. The frame is still tagged LIST_B2.
+void b2_heap_stash_root(partition_info* part) {
+	int last = --part->b2.size;
+
+	b2_heap_swap(part, 0, last);
+	b2_heap_sift_down(part, 0);
+}
+
+// Put back the 'num_stashed' frames set aside by b2_heap_stash_root
+void b2_heap_restore_stash(partition_info* part, int num_stashed) {
+	while (num_stashed-- > 0) {
+		b2_heap_sift_up(part, part->b2.size++);
+	}
+}
+
+// B2 bucket mode - Function definitions
+
+// Bucket currently holding a B2 frame
+b2_bucket* b2_bucket_of(node* frame) {
+	b2_wheel* wheel = &PARTITION_OF(FRAME_ID(frame))->wheel;
+	uint64_t epoch = Max(TIME_ARRAY(frame)[SECOND_LAST_ACCESS] / wheel->width, wheel->base_epoch);
+
+	return &wheel->buckets[epoch % ELRU_B2_NUM_BUCKETS];
+}
+
+// Take a B2 frame out of its bucket, in O(1). The caller accounts for it in b2.size.
+void b2_bucket_unlink(b2_bucket* bucket, node* frame) {
+	if (frame->prev != NIL_FRAME) {
+		doubleLinkedList[frame->prev].next = frame->next;
 	} else {
-		////elog(LOG, "Prev frame of frame %d: NULL, Next frame of frame %d: NULL", frame_id_for_deletion, frame_id_for_deletion);
-	}
-
-	// sanity check
-	if (frame_for_deletion->sanity_check != 42069) {
-		//elog(ERROR, "Sanity check failed for frame %d, sanity check value: %d and not 42069", frame_id_for_deletion, frame_for_deletion->sanity_check);
-	}	
-
-	if (frame_for_deletion == linkedListInfo->head) { // Correctly check and update head
-		//elog(LOG, "if (frame_for_deletion == linkedListInfo->head) triggered");
-		if (linkedListInfo->head->next) { // Check if there's a next node
-			linkedListInfo->head = linkedListInfo->head->next;
-			linkedListInfo->head->prev = NULL;
-			} 
-		else { // List becomes empty
-			linkedListInfo->head = linkedListInfo->tail = NULL;
+		bucket->head = frame->next;
+	}
+
+	if (frame->next != NIL_FRAME) {
+		doubleLinkedList[frame->next].prev = frame->prev;
+	} else {
+		bucket->tail = frame->prev;
+	}
+
+	frame->prev = NIL_FRAME;
+	frame->next = NIL_FRAME;
+	frame->list = LIST_NONE;
+	bucket->size--;
+}
+
+// Make room for a frame of bucket epoch 'epoch' by folding the oldest buckets into their successors.
+// Older frames are appended on the tail side, so they are still evicted first.
+void b2_wheel_advance(partition_info* part, uint64_t epoch) {
+	b2_wheel* wheel = &part->wheel;
+
+	while (epoch >= wheel->base_epoch + ELRU_B2_NUM_BUCKETS) {
+		b2_bucket* oldest = &wheel->buckets[wheel->base_epoch % ELRU_B2_NUM_BUCKETS];
+		b2_bucket* next = &wheel->buckets[(wheel->base_epoch + 1) % ELRU_B2_NUM_BUCKETS];
+
+		if (part->b2.size == 0 || epoch >= wheel->base_epoch + 2 * ELRU_B2_NUM_BUCKETS) {
+			// Every bucket would be folded at least once - gather everything into one bucket and jump there
+			int32 merged_head = NIL_FRAME;
+			int32 merged_tail = NIL_FRAME;
+			int merged_size = 0;
+
+			for (int i = ELRU_B2_NUM_BUCKETS - 1; i >= 0; i--) {
+				b2_bucket* bucket = &wheel->buckets[(wheel->base_epoch + i) % ELRU_B2_NUM_BUCKETS];
+
+				if (bucket->head != NIL_FRAME) {
+					if (merged_tail != NIL_FRAME) {
+						doubleLinkedList[merged_tail].next = bucket->head;
+						doubleLinkedList[bucket->head].prev = merged_tail;
+					} else {
+						merged_head = bucket->head;
+					}
+					merged_tail = bucket->tail;
+					merged_size += bucket->size;
+				}
+				bucket->head = bucket->tail = NIL_FRAME;
+				bucket->size = 0;
+			}
+
+			wheel->base_epoch = epoch - (ELRU_B2_NUM_BUCKETS - 1);
+			oldest = &wheel->buckets[wheel->base_epoch % ELRU_B2_NUM_BUCKETS];
+			oldest->head = merged_head;
+			oldest->tail = merged_tail;
+			oldest->size = merged_size;
+			return;
+		}
+
+		// Splice the oldest bucket behind the tail of the next one
+		if (oldest->head != NIL_FRAME) {
+			if (next->tail != NIL_FRAME) {
+				doubleLinkedList[next->tail].next = oldest->head;
+				doubleLinkedList[oldest->head].prev = next->tail;
+			} else {
+				next->head = oldest->head;
+			}
+			next->tail = oldest->tail;
+			next->size += oldest->size;
+			oldest->head = oldest->tail = NIL_FRAME;
+			oldest->size = 0;
+		}
+		wheel->base_epoch++;
+	}
+}
+
+// Append a frame (not in B1 or B2) at the head of the bucket for its time_array[SECOND_LAST_ACCESS], in O(1)
+void b2_bucket_insert(node* frame) {
+	partition_info* part = PARTITION_OF(FRAME_ID(frame));
+	b2_bucket* bucket;
+
+	b2_wheel_advance(part, TIME_ARRAY(frame)[SECOND_LAST_ACCESS] / part->wheel.width);
+	bucket = b2_bucket_of(frame);
+
+	frame->prev = NIL_FRAME;
+	frame->next = bucket->head;
+	if (bucket->head != NIL_FRAME) {
+		doubleLinkedList[bucket->head].prev = FRAME_ID(frame);
+	} else {
+		bucket->tail = FRAME_ID(frame);
+	}
+	bucket->head = FRAME_ID(frame);
+	bucket->size++;
+
+	frame->list = LIST_B2;
+	part->b2.size++;
+}
+
+// Look up the node for 'desired_frame_id' in O(1); returns NULL if the frame is not in B2
+node* search_for_frame_b2(int desired_frame_id) {
+	node* frame = &doubleLinkedList[desired_frame_id];
+
+	if (frame->list != LIST_B2) {
+		return NULL;
+	}
+
+	return frame;
+}
+
+// B2 victim selection within one partition, called with the partition's B2 lock held exclusively (the heap is
+// reordered while searching). Returns the buf_id of the B2 frame of lowest rank that looks unpinned, or NIL_FRAME
+// if every B2 frame is pinned. The refcount is only peeked at; claim_victim makes sure of the frame afterwards.
+// The frame is left in B2.
+
+// Exact mode - start at the heap root; pinned roots are stashed past the end of the heap until an unpinned frame surfaces
+int32 get_victim_from_b2_heap(partition_info* part) {
+	int32 victim = NIL_FRAME;
+	int num_stashed = 0;
+
+	while (part->b2.size > 0) {
+		int32 root = b2Heap[part->heap_base];
+
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&GetBufferDescriptor(root)->state)) == 0) {
+			victim = root;
+			break;
+		}
+
+		b2_heap_stash_root(part);
+		num_stashed++;
+	}
+
+	b2_heap_restore_stash(part, num_stashed);
+	return victim;
+}
+
+// Bucket mode - drain the oldest non-empty bucket first, from its tail
+int32 get_victim_from_b2_buckets(partition_info* part) {
+	for (int i = 0; i < ELRU_B2_NUM_BUCKETS; i++) {
+		b2_bucket* bucket = &part->wheel.buckets[(part->wheel.base_epoch + i) % ELRU_B2_NUM_BUCKETS];
+
+		for (int32 traversal_frame_id = bucket->tail; traversal_frame_id != NIL_FRAME; traversal_frame_id = doubleLinkedList[traversal_frame_id].prev) {
+			if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&GetBufferDescriptor(traversal_frame_id)->state)) == 0) {
+				return traversal_frame_id;
+			}
+		}
+	}
+
+	return NIL_FRAME;
+}
+
+// Try to evict the frame 'seen' describes, holding no lock. See claim_victim in freelist_lru.c: unless it has been
+// moved since it was seen (every move stamps it), the frame is moved to the head of B1 (to the tail if it is taken for
+// a ring, see place_ring_frame) under both of its partition's locks, and only then, with the lists unlocked, is its
+// buffer header locked to make sure nobody has pinned it meanwhile. Returns the buffer with its header locked, or NULL.
+// With the retained history on, the evicted page's history is saved first, from a copy of its tag taken before the
+// lists are locked, see save_history. A page pinned meanwhile gets that history back on its next hit, see
+// recall_history.
+BufferDesc* claim_victim(const victim_entry* seen, bool for_ring, uint32* buf_state) {
+	partition_info* part = PARTITION_OF(seen->buf_id);
+	node* frame = &doubleLinkedList[seen->buf_id];
+	BufferDesc* buf = GetBufferDescriptor(seen->buf_id);
+	uint32 local_buf_state;
+	bool save = false;
+	bool moved;
+	BufferTag tag;
+
+	if (historyTable->capacity > 0) {
+		local_buf_state = LockBufHdr(buf);
+		tag = buf->tag;
+		UnlockBufHdr(buf, local_buf_state);
+
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0) {
+			return NULL;
+		}
+		save = (local_buf_state & BM_TAG_VALID) != 0;
+	}
+
+	LWLockAcquire(&part->b1.linkedListInfo_lock, LW_EXCLUSIVE);
+	LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
+
+	moved = (frame->list != seen->list
+		|| TIME_ARRAY(frame)[SECOND_LAST_ACCESS] != seen->time_array[SECOND_LAST_ACCESS]
+		|| TIME_ARRAY(frame)[FIRST_LAST_ACCESS] != seen->time_array[FIRST_LAST_ACCESS]);
+
+	// A page not hit since it was loaded has not had its retained history looked up yet. With it, the page may have
+	// been accessed K times, and then it belongs in B2 rather than among the B1 victims. Ring frames are the ring's to
+	// recycle.
+	if (!moved && save && frame->fresh && !frame->ring && restore_history(frame, &tag)
+		&& TIME_ARRAY(frame)[SECOND_LAST_ACCESS] != 0) {
+		place_by_history(frame);
+		moved = true;
+	}
+
+	if (!moved) {
+		if (save) {
+			save_history(frame, &tag);
+		}
+
+		// The frame is getting a new page, which starts out with no history of its own. It leaves B2 before its
+		// stamps are cleared, as its B2 bucket is derived from them.
+		delete_other_arbitrarily(seen->buf_id);
+		clear_history(frame);
+
+		if (for_ring) {
+			move_to_tail(frame);
+		} else {
+			move_to_head(frame);     // Removes from B1 or B2, then inserts into B1
+		}
+		frame->fresh = true;
+	}
+
+	LWLockRelease(&part->b2.linkedListInfo_lock);
+	LWLockRelease(&part->b1.linkedListInfo_lock);
+
+	if (moved) {
+		return NULL;
+	}
+
+	local_buf_state = LockBufHdr(buf);
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0 || (save && !BufferTagsEqual(&buf->tag, &tag))) {
+		UnlockBufHdr(buf, local_buf_state);
+		return NULL;
+	}
+
+	*buf_state = local_buf_state;
+	return buf;
+}
+
+// Remember which list 'frame_id' is in and its stamps, which together are its version. Caller holds the lock of that
+// list; shared mode is enough.
+void see_frame(int32 frame_id, victim_entry* seen) {
+	seen->buf_id = frame_id;
+	seen->list = doubleLinkedList[frame_id].list;
+	seen->time_array[SECOND_LAST_ACCESS] = frameStamps[frame_id].time_array[SECOND_LAST_ACCESS];
+	seen->time_array[FIRST_LAST_ACCESS] = frameStamps[frame_id].time_array[FIRST_LAST_ACCESS];
+}
+
+// Called by StrategyGetBuffer, holding no list locks, once B1 of every partition has no unpinned frame.
+// Visits the partitions starting at 'start_partition' and sets 'victim' to the first B2 victim found, for
+// claim_victim. Returns false if every B2 frame is pinned.
+bool get_victim_from_b2(int start_partition, victim_entry* victim) {
+	for (int i = 0; i < numPartitions; i++) {
+		partition_info* part = &partitionInfo[(start_partition + i) % numPartitions];
+		int32 victim_id;
+
+		// B2 alone is enough, the heap is only reordered while searching
+		LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
+
+		if (part->wheel.width > 0) {
+			victim_id = get_victim_from_b2_buckets(part);
+		} else {
+			victim_id = get_victim_from_b2_heap(part);
+		}
+
+		if (victim_id != NIL_FRAME) {
+			see_frame(victim_id, victim);
+		}
+
+		LWLockRelease(&part->b2.linkedListInfo_lock);
+
+		if (victim_id != NIL_FRAME) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Admission filter - Function definitions
+
+// See admission_sketch_width in freelist_lru.c. 0 if elru_admission_filter is off.
+uint32 admission_sketch_width(void) {
+	if (!elru_admission_filter) {
+		return 0;
+	}
+
+	return Max(pg_nextpower2_32((uint32) NBuffers * SKETCH_COUNTERS_PER_BUFFER), SKETCH_COUNTERS_PER_WORD);
+}
+
+Size admission_sketch_shmem_size(uint32 width) {
+	Size num_words = add_size(mul_size(SKETCH_DEPTH, width / SKETCH_COUNTERS_PER_WORD), width * DOORKEEPER_BITS_PER_COUNTER / 64);
+
+	return add_size(offsetof(admission_sketch, words), mul_size(sizeof(pg_atomic_uint64), num_words));
+}
+
+// Add one to counter 'index' of row 'row', unless it is already at SKETCH_COUNTER_MAX
+void sketch_increment(uint32 row, uint32 index) {
+	pg_atomic_uint64* word = &admissionSketch->words[row * (admissionSketch->width / SKETCH_COUNTERS_PER_WORD) + index / SKETCH_COUNTERS_PER_WORD];
+	int shift = (index % SKETCH_COUNTERS_PER_WORD) * 4;
+	uint64 old_word = pg_atomic_read_u64(word);
+
+	while (((old_word >> shift) & SKETCH_COUNTER_MAX) < SKETCH_COUNTER_MAX) {
+		if (pg_atomic_compare_exchange_u64(word, &old_word, old_word + (UINT64CONST(1) << shift))) {
+			break;
+		}
+	}
+}
+
+// See sketch_estimate in freelist_lru.c
+uint32 sketch_estimate(uint32 hash) {
+	uint32 width = admissionSketch->width;
+	uint32 step = murmurhash32(hash) | 1;
+	uint32 doorkeeper_bit = murmurhash32(step) & (width * DOORKEEPER_BITS_PER_COUNTER - 1);
+	pg_atomic_uint64* doorkeeper = &admissionSketch->words[SKETCH_DEPTH * (width / SKETCH_COUNTERS_PER_WORD)];
+	uint32 estimate = SKETCH_COUNTER_MAX;
+
+	for (uint32 row = 0; row < SKETCH_DEPTH; row++) {
+		uint32 index = (hash + row * step) & (width - 1);
+		uint64 word = pg_atomic_read_u64(&admissionSketch->words[row * (width / SKETCH_COUNTERS_PER_WORD) + index / SKETCH_COUNTERS_PER_WORD]);
+
+		estimate = Min(estimate, (uint32) ((word >> ((index % SKETCH_COUNTERS_PER_WORD) * 4)) & SKETCH_COUNTER_MAX));
+	}
+
+	if (pg_atomic_read_u64(&doorkeeper[doorkeeper_bit / 64]) & (UINT64CONST(1) << (doorkeeper_bit % 64))) {
+		estimate++;
+	}
+
+	return estimate;
+}
+
+// See sketch_age in freelist_lru.c
+void sketch_age(void) {
+	uint32 width = admissionSketch->width;
+	uint32 num_counter_words = SKETCH_DEPTH * (width / SKETCH_COUNTERS_PER_WORD);
+	uint32 num_doorkeeper_words = width * DOORKEEPER_BITS_PER_COUNTER / 64;
+
+	for (uint32 i = 0; i < num_counter_words; i++) {
+		pg_atomic_uint64* word = &admissionSketch->words[i];
+		uint64 old_word = pg_atomic_read_u64(word);
+
+		// Shifting the whole word right halves each counter; the mask drops the bit every counter got from the next one
+		while (!pg_atomic_compare_exchange_u64(word, &old_word, (old_word >> 1) & UINT64CONST(0x7777777777777777))) {
+		}
+	}
+
+	for (uint32 i = 0; i < num_doorkeeper_words; i++) {
+		pg_atomic_write_u64(&admissionSketch->words[num_counter_words + i], 0);
+	}
+
+	pg_atomic_sub_fetch_u32(&admissionSketch->samples, admissionSketch->sample_size);
+}
+
+// See record_frequency in freelist_lru.c
+void record_frequency(int buf_id) {
+	BufferDesc* buf = GetBufferDescriptor(buf_id);
+	uint32 state = pg_atomic_read_u32(&buf->state);
+	uint32 width = admissionSketch->width;
+	uint32 hash;
+	uint32 step;
+	uint32 doorkeeper_bit;
+	uint64 doorkeeper_mask;
+
+	if (BUF_STATE_GET_REFCOUNT(state) == 0 || !(state & BM_TAG_VALID)) {
+		return;
+	}
+
+	hash = BufTableHashCode(&buf->tag);
+	step = murmurhash32(hash) | 1;
+	doorkeeper_bit = murmurhash32(step) & (width * DOORKEEPER_BITS_PER_COUNTER - 1);
+	doorkeeper_mask = UINT64CONST(1) << (doorkeeper_bit % 64);
+
+	if (pg_atomic_add_fetch_u32(&admissionSketch->samples, 1) == admissionSketch->sample_size) {
+		sketch_age();
+	}
+
+	if (!(pg_atomic_fetch_or_u64(&admissionSketch->words[SKETCH_DEPTH * (width / SKETCH_COUNTERS_PER_WORD) + doorkeeper_bit / 64], doorkeeper_mask) & doorkeeper_mask)) {
+		return;
+	}
+
+	for (uint32 row = 0; row < SKETCH_DEPTH; row++) {
+		sketch_increment(row, (hash + row * step) & (width - 1));
+	}
+}
+
+// See frame_frequency in freelist_lru.c
+uint32 frame_frequency(int32 frame_id) {
+	BufferDesc* buf = GetBufferDescriptor(frame_id);
+	uint32 state = LockBufHdr(buf);
+	BufferTag tag = buf->tag;
+
+	UnlockBufHdr(buf, state);
+
+	if (!(state & BM_TAG_VALID)) {
+		return 0;
+	}
+
+	return sketch_estimate(BufTableHashCode(&tag));
+}
+
+// Called by victim search, holding the partition's B1 lock (shared mode is enough) but not its B2 lock, for the
+// unpinned B1 frame 'victim' it is about to evict. B1 holds the pages that have been accessed fewer than K times, so
+// every one of them is on probation. Returns false if the frame has been moved since it was seen, or is a ring frame
+// (ring frames are the ring's to recycle). Otherwise 'rival' is set to the frame B2 would give up in its place (the
+// B2 victim of the partition), or its buf_id to NIL_FRAME if every B2 frame is pinned.
+bool find_admission_rival(const victim_entry* victim, victim_entry* rival) {
+	partition_info* part = PARTITION_OF(victim->buf_id);
+	node* frame = &doubleLinkedList[victim->buf_id];
+
+	if (frame->list != LIST_B1 || frame->ring
+		|| TIME_ARRAY(frame)[SECOND_LAST_ACCESS] != victim->time_array[SECOND_LAST_ACCESS]
+		|| TIME_ARRAY(frame)[FIRST_LAST_ACCESS] != victim->time_array[FIRST_LAST_ACCESS]) {
+		return false;
+	}
+
+	LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
+
+	rival->buf_id = (part->wheel.width > 0) ? get_victim_from_b2_buckets(part) : get_victim_from_b2_heap(part);
+	if (rival->buf_id != NIL_FRAME) {
+		see_frame(rival->buf_id, rival);
+	}
+
+	LWLockRelease(&part->b2.linkedListInfo_lock);
+	return true;
+}
+
+// Called by victim search, holding no lock, for the B1 frame 'victim' and the 'rival' find_admission_rival found for
+// it. The page in B1 gets to stay only if it is more popular than the rival's. In that case it is admitted into B2,
+// as a hit would have done, and true is returned: the rival is to be evicted instead. See apply_admission in
+// freelist_lru.c.
+bool apply_admission(const victim_entry* victim, const victim_entry* rival) {
+	partition_info* part = PARTITION_OF(victim->buf_id);
+	node* frame = &doubleLinkedList[victim->buf_id];
+	uint32 frequency;
+
+	// A page nobody has hit lately cannot beat anything
+	frequency = (rival->buf_id != NIL_FRAME) ? frame_frequency(victim->buf_id) : 0;
+
+	if (frequency == 0 || frequency <= frame_frequency(rival->buf_id)) {
+		pg_atomic_fetch_add_u64(&admissionSketch->rejections, 1);
+		return false;
+	}
+
+	// Unless a hit has admitted it already
+	LWLockAcquire(&part->b1.linkedListInfo_lock, LW_EXCLUSIVE);
+	LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
+	if (frame->list == LIST_B1
+		&& TIME_ARRAY(frame)[SECOND_LAST_ACCESS] == victim->time_array[SECOND_LAST_ACCESS]
+		&& TIME_ARRAY(frame)[FIRST_LAST_ACCESS] == victim->time_array[FIRST_LAST_ACCESS]) {
+		insert_into_b2(frame);
+	}
+	LWLockRelease(&part->b2.linkedListInfo_lock);
+	LWLockRelease(&part->b1.linkedListInfo_lock);
+
+	pg_atomic_fetch_add_u64(&admissionSketch->admissions, 1);
+	return true;
+}
+
+// Access ring - Function definitions
+
+// Called by StrategyAccessBuffer for a re-reference. If the access ring is enabled and the frame is already in B1 or B2,
+// the access is only recorded in this backend's ring and true is returned; the caller then has nothing left to do.
+// Frames that are in neither list (fresh from the freelist) are never deferred, otherwise they could not be evicted
+// until the ring is flushed. The unlocked look at frame->list is only a hint, flush_access_ring checks it again.
+bool record_access(int buf_id) {
+	int ring_size = Min(elru_access_ring_size, ELRU_ACCESS_RING_MAX);
+
+	if (ring_size <= 0 || doubleLinkedList[buf_id].list == LIST_NONE) {
+		return false;
+	}
+
+	if (!accessRingCallbackRegistered) {
+		RegisterXactCallback(access_ring_xact_callback, NULL);
+		accessRingCallbackRegistered = true;
+	}
+
+	accessRing[accessRingCount++] = buf_id;
+	if (accessRingCount >= ring_size) {
+		flush_access_ring();
+	}
+
+	return true;
+}
+
+// Apply every access recorded in this backend's ring, in the order they happened. Each partition's locks are
+// taken once for all of its entries. Each entry still ticks the counter, so stamps are the same as if the accesses had
+// been applied one by one at flush time. Frames freed since they were recorded are left alone; a frame that was
+// evicted and reused in the meantime gets the promotion meant for its old page, which costs no more than a stale hint.
+void flush_access_ring(void) {
+	int count = accessRingCount;
+
+	accessRingCount = 0;
+
+	for (int i = 0; i < count; i++) {
+		partition_info* part;
+
+		if (accessRing[i] == NIL_FRAME) { // Already applied together with an earlier entry of its partition
+			continue;
+		}
+
+		part = PARTITION_OF(accessRing[i]);
+		LWLockAcquire(&part->b1.linkedListInfo_lock, LW_EXCLUSIVE);
+		LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
+
+		for (int j = i; j < count; j++) {
+			node* frame;
+
+			if (accessRing[j] == NIL_FRAME || PARTITION_OF(accessRing[j]) != part) {
+				continue;
+			}
+
+			clock_tick();
+
+			frame = &doubleLinkedList[accessRing[j]];
+			if (frame->list != LIST_NONE) {
+				if (frame->fresh) {
+					recall_history(frame);
+				}
+				insert_into_b2(frame);
+			}
+			accessRing[j] = NIL_FRAME;
+		}
+
+		LWLockRelease(&part->b1.linkedListInfo_lock);
+		LWLockRelease(&part->b2.linkedListInfo_lock);
+	}
+}
+
+// See access_ring_xact_callback in freelist_lru.c
+void access_ring_xact_callback(XactEvent event, void* arg) {
+	if (accessRingCount > 0) {
+		flush_access_ring();
+	}
+}
+
+// Victim queue - Function definitions
+
+// Number of entries in the victim queue, elru_victim_queue_size clamped to [0, NBuffers]
+int elru_victim_queue_capacity(void) {
+	return Min(Max(elru_victim_queue_size, 0), NBuffers);
+}
+
+Size victim_queue_shmem_size(int capacity) {
+	return add_size(offsetof(victim_queue, entries), mul_size(sizeof(victim_entry), capacity));
+}
+
+// Collect 'frame_id' for pick_victims if it looks unpinned: into 'out' if it is clean or 'prefer_clean' is not set,
+// otherwise into 'dirty' while there is room. The caller holds the lock of the list the frame is in.
+void consider_victim(int32 frame_id, victim_entry* out, int* num_picked, victim_entry* dirty, int* num_dirty, int quota, bool prefer_clean) {
+	uint32 state = pg_atomic_read_u32(&GetBufferDescriptor(frame_id)->state);
+	node* frame = &doubleLinkedList[frame_id];
+	victim_entry entry = {frame_id, frame->list, {TIME_ARRAY(frame)[SECOND_LAST_ACCESS], TIME_ARRAY(frame)[FIRST_LAST_ACCESS]}};
+
+	if (BUF_STATE_GET_REFCOUNT(state) != 0) {
+		return;
+	}
+
+	if (!prefer_clean || !(state & BM_DIRTY)) {
+		out[(*num_picked)++] = entry;
+	} else if (*num_dirty < quota) {
+		dirty[(*num_dirty)++] = entry;
+	}
+}
+
+// Collect up to 'quota' unpinned frames of one partition into 'out', in the order StrategyGetBuffer would evict
+// them: B1 from its tail (shared lock), then B2 if B1 falls short. With 'prefer_clean', clean frames come first
+// within each list so that backends seldom have to write a page out before reusing its buffer; dirty ones only make
+// up for a shortage of clean ones, but a dirty B1 frame still goes before any B2 frame. Returns the number collected.
+int pick_victims(partition_info* part, victim_entry* out, int quota, bool prefer_clean) {
+	victim_entry* dirty = palloc(mul_size(sizeof(victim_entry), quota));
+	int num_picked = 0;
+	int num_dirty = 0;
+	int scan_limit = quota * VICTIM_QUEUE_SCAN_FACTOR;
+
+	LWLockAcquire(&part->b1.linkedListInfo_lock, LW_SHARED);
+
+	for (int32 frame_id = part->b1.tail; frame_id != NIL_FRAME && num_picked < quota && scan_limit-- > 0; frame_id = doubleLinkedList[frame_id].prev) {
+		consider_victim(frame_id, out, &num_picked, dirty, &num_dirty, quota, prefer_clean);
+	}
+
+	LWLockRelease(&part->b1.linkedListInfo_lock);
+
+	for (int i = 0; i < num_dirty && num_picked < quota; i++) {
+		out[num_picked++] = dirty[i];
+	}
+	num_dirty = 0;
+
+	if (num_picked < quota && scan_limit > 0) {
+		// B2 in victim order; the heap has to be taken apart for that, so this needs the B2 lock exclusively
+		LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
+
+		if (part->wheel.width > 0) {
+			for (int i = 0; i < ELRU_B2_NUM_BUCKETS && num_picked < quota && scan_limit > 0; i++) {
+				b2_bucket* bucket = &part->wheel.buckets[(part->wheel.base_epoch + i) % ELRU_B2_NUM_BUCKETS];
+
+				for (int32 frame_id = bucket->tail; frame_id != NIL_FRAME && num_picked < quota && scan_limit-- > 0; frame_id = doubleLinkedList[frame_id].prev) {
+					consider_victim(frame_id, out, &num_picked, dirty, &num_dirty, quota, prefer_clean);
+				}
+			}
+		} else {
+			int num_stashed = 0;
+
+			while (part->b2.size > 0 && num_picked < quota && scan_limit-- > 0) {
+				consider_victim(b2Heap[part->heap_base], out, &num_picked, dirty, &num_dirty, quota, prefer_clean);
+				b2_heap_stash_root(part);
+				num_stashed++;
+			}
+
+			b2_heap_restore_stash(part, num_stashed);
+		}
+
+		LWLockRelease(&part->b2.linkedListInfo_lock);
+	}
+
+	for (int i = 0; i < num_dirty && num_picked < quota; i++) {
+		out[num_picked++] = dirty[i];
+	}
+
+	pfree(dirty);
+	return num_picked;
+}
+
+// See collect_victims in freelist_lru.c
+int collect_victims(victim_entry* out, int max_victims, bool prefer_clean, int start_partition) {
+	int quota = (max_victims + numPartitions - 1) / numPartitions;
+	victim_entry* picked = palloc(mul_size(sizeof(victim_entry), mul_size(quota, numPartitions)));
+	int* num_picked = palloc(mul_size(sizeof(int), numPartitions));
+	int num_entries = 0;
+
+	for (int p = 0; p < numPartitions; p++) {
+		num_picked[p] = pick_victims(&partitionInfo[p], &picked[p * quota], quota, prefer_clean);
+	}
+
+	for (int k = 0; k < quota && num_entries < max_victims; k++) {
+		for (int i = 0; i < numPartitions && num_entries < max_victims; i++) {
+			int p = (start_partition + i) % numPartitions;
+
+			if (k < num_picked[p]) {
+				out[num_entries++] = picked[p * quota + k];
 			}
-		} 
-	else if (frame_for_deletion == linkedListInfo->tail) { // Correctly check and update tail
-			//elog(LOG, "if (frame_for_deletion == linkedListInfo->tail) triggered");
-			linkedListInfo->tail = linkedListInfo->tail->prev;
-			linkedListInfo->tail->next = NULL;
-		} 
-	else { // Node is in the middle
-			//elog(LOG, "else triggered");
-			frame_for_deletion->prev->next = frame_for_deletion->next;
-			frame_for_deletion->next->prev = frame_for_deletion->prev;
 		}
-	//elog(LOG, "Successfully deleted frame %d from B1", frame_id_for_deletion);
-	frame_for_deletion->next = NULL;
-	frame_for_deletion->prev = NULL;
+	}
+
+	pfree(picked);
+	pfree(num_picked);
+	return num_entries;
+}
+
+// Wake the bgwriter to refill the victim queue, at most once until it has done so
+void request_victim_queue_refill(void) {
+	int bgwprocno = INT_ACCESS_ONCE(victimQueue->bgwprocno);
+
+	if (bgwprocno == -1 || pg_atomic_read_u32(&victimQueue->refill_requested) != 0) {
+		return;
+	}
+
+	if (pg_atomic_exchange_u32(&victimQueue->refill_requested, 1) == 0) {
+		SetLatch(&ProcGlobal->allProcs[bgwprocno].procLatch);
+	}
+}
+
+// See pop_victim in freelist_lru.c. A B2 entry is also stale once B1 of its partition has frames again, as B1 goes
+// first.
+BufferDesc* pop_victim(uint32* buf_state, bool for_ring) {
+	for (;;) {
+		victim_entry entry;
+		victim_entry rival;
+		int remaining;
+		partition_info* part;
+		BufferDesc* buf;
+		bool on_probation;
+
+		// Unlocked first look, like the freelist check in StrategyGetBuffer
+		if (victimQueue->count == 0) {
+			request_victim_queue_refill();
+			return NULL;
+		}
+
+		SpinLockAcquire(&victimQueue->victimQueue_spinlock);
+
+		if (victimQueue->count == 0) {
+			SpinLockRelease(&victimQueue->victimQueue_spinlock);
+			continue;
+		}
+
+		entry = victimQueue->entries[victimQueue->head++];
+		remaining = --victimQueue->count;
+
+		SpinLockRelease(&victimQueue->victimQueue_spinlock);
+
+		if (remaining < victimQueue->capacity / VICTIM_QUEUE_LOW_WATER) {
+			request_victim_queue_refill();
+		}
+
+		part = PARTITION_OF(entry.buf_id);
+
+		// An unlocked look at the size of B1, at worst a B2 frame is evicted although B1 has frames again
+		if (entry.list == LIST_B2 && part->b1.size > 0) {
+			continue;
+		}
+
+		// The bgwriter picked the frame without regard to admission, so a page in B1 may still stay
+		if (admissionFilter && entry.list == LIST_B1) {
+			LWLockAcquire(&part->b1.linkedListInfo_lock, LW_SHARED);
+			on_probation = find_admission_rival(&entry, &rival);
+			LWLockRelease(&part->b1.linkedListInfo_lock);
+
+			if (on_probation && apply_admission(&entry, &rival)) {
+				entry = rival;
+			}
+		}
+
+		buf = claim_victim(&entry, for_ring, buf_state);
+		if (buf != NULL) {
+			return buf;
+		}
+	}
+}
+
+// Logical clock - Function definitions
+
+// Advance the logical clock by one access
+void clock_tick(void) {
+	int batch = Min(elru_clock_batch, ELRU_CLOCK_BATCH_MAX);
+
+	if (batch <= 1) {
+		pg_atomic_fetch_add_u64(&counterInfo->counter, 1);
+		return;
+	}
+
+	if (localClockNow + 1 >= localClockEnd) {
+		// Slice used up, reserve the next one
+		localClockNow = pg_atomic_fetch_add_u64(&counterInfo->counter, batch);
+		localClockEnd = localClockNow + batch + 1;
+	}
+	localClockNow++;
+}
+
+// Current logical time as seen by this backend
+uint64_t clock_now(void) {
+	if (Min(elru_clock_batch, ELRU_CLOCK_BATCH_MAX) <= 1) {
+		return pg_atomic_read_u64(&counterInfo->counter);
+	}
+
+	return localClockNow;
 }
 
-void insert_at_head(node* frame) { 
-	// Update time_array
-	update_time(frame);
+// Promotion filter - Function definitions
 
-	//elog(LOG, "Inserting frame %d into B1", frame->frame_id);
+// Called by StrategyAccessBuffer without any lock: true if the re-reference of a B2 frame follows its last access so
+// closely that updating time_array and the heap / wheel is not worth it. One tick is one access, so a frame last
+// accessed fewer than 'window' ticks ago is among the 'window' most recently used frames. Skipping such a re-reference
+// treats it as part of the previous one, the same way a correlated reference is treated in LRU-K. B1 frames are never
+// filtered: their K-th access is what moves them to B2.
+// The unlocked reads can be stale, which only means an access is filtered (or not) by mistake.
+bool skip_promotion(int buf_id) {
+	node* frame = &doubleLinkedList[buf_id];
+	uint64_t window;
+	uint64_t last_access;
 
-	frame->next = linkedListInfo->head; 
-	if (linkedListInfo->head != NULL && linkedListInfo->tail != NULL) { // Check if list is not empty
-		//elog(LOG, "Head of B1: %d", linkedListInfo->head->frame_id);
-		// just log sanity check value
-		//elog(LOG, "Sanity check value of head of B1: %d", linkedListInfo->head->sanity_check);
+	if (elru_promotion_filter <= 0 || frame->list != LIST_B2) {
+		return false;
+	}
 
-		linkedListInfo->head->prev = frame; 
+	window = (uint64_t) NBuffers * Min(elru_promotion_filter, 100) / 100;
+	last_access = PARTITION_OF(buf_id)->epoch + TIME_ARRAY(frame)[FIRST_LAST_ACCESS];
+	if (clock_now() - last_access >= window) {
+		return false;
 	}
 
-	linkedListInfo->head = frame; 
+	return elru_promotion_probability <= 0 ||
+		pg_prng_double(&pg_global_prng_state) * 100 >= elru_promotion_probability;
+}
 
-	if (linkedListInfo->tail == NULL) { // If list was empty, update tail as well
-		//elog(LOG, "Tail of B1: NULL");
-		linkedListInfo->tail = frame;
-		frame->next = NULL;
+// Called by StrategyAccessBuffer without any lock: true if the reference falls inside the correlated reference period,
+// i.e. fewer than elru_correlated_period percent of NBuffers ticks after the frame's last access. Such a reference is
+// taken to be part of the same burst as that access (one query reading the page twice, say), as in LRU-K: it neither
+// shifts the frame's stamps nor moves it in B1 or B2, so a page that is only hot inside one query does not get to B2
+// on it. Unlike skip_promotion this holds for B1 frames too, and for every reference in the window. The window is not
+// stretched by the references it drops, so a page that keeps being used counts again once per period.
+// The unlocked reads can be stale, which only misjudges one reference.
+bool skip_correlated(int buf_id) {
+	node* frame = &doubleLinkedList[buf_id];
+	uint64_t window;
+	uint64_t last_access;
+
+	if (elru_correlated_period <= 0 || frame->list == LIST_NONE) {
+		return false;
 	}
 
-	frame->prev = NULL; // Set frame's prev to NULL
-} 
-
-void move_to_head(node* frame) { 
-	delete_arbitrarily(frame->frame_id);
-	delete_other_arbitrarily(frame->frame_id);
-	insert_at_head(frame); 
+	window = (uint64_t) NBuffers * Min(elru_correlated_period, 100) / 100;
+	last_access = PARTITION_OF(buf_id)->epoch + TIME_ARRAY(frame)[FIRST_LAST_ACCESS];
+	return clock_now() - last_access < window;
 }
 
-// B2 - Function definitions
+// See skip_ring_promotion in freelist_lru.c. A frame only its ring has used stays at the tail of B1 instead of moving
+// to B2.
+bool skip_ring_promotion(int buf_id) {
+	node* frame = &doubleLinkedList[buf_id];
 
-// Rank in B2(otherLinkedListInfo) is based on 2nd last accessed time i.e time_array[SECOND_LAST_ACCESS]
-// Traverse through otherLinkedListInfo and check rank of frame corresponding by comparing time_array[SECOND_LAST_ACCESS]
-// of other frames with the time_array[SECOND_LAST_ACCESS] of the frame to be inserted, and insert the frame at the correct position.
-// The frame with the highest rank (largest time_array[SECOND_LAST_ACCESS]) will be at the head of the list.
-// If insertion is successful, delete frame from linkedListInfo(original B1 list).
-void insert_into_b2(node* frame) {
-	//elog(LOG, "Inserting frame %d into B2", frame->frame_id);
-	//elog(LOG, "Second last access time of frame %d: %lu", frame->frame_id, frame->time_array[SECOND_LAST_ACCESS]);
-	//elog(LOG, "First last access time of frame %d: %lu", frame->frame_id, frame->time_array[FIRST_LAST_ACCESS]);
-	node* traversal_ptr;
-	//node* next_frame;
-	node* prev_frame;
+	return frame->ring && frame->list == LIST_B1 &&
+		BUF_STATE_GET_USAGECOUNT(pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state)) <= 1;
+}
 
-	// Update time array for frame
-	update_time(frame);
+// Called by victim search, holding the partition's B1 lock, when the first unpinned B1 candidate 'dirty_frame_id' is
+// dirty. Looks at up to elru_dirty_lookahead - 1 further unpinned candidates towards the head of B1 and returns the
+// first clean one, or NIL_FRAME if there is none. Candidates accessed more than elru_dirty_age_tolerance percent of
+// NBuffers ticks after the dirty one are too young to stand in for it, and end the search. B2 victims are not
+// substituted; B2 is only searched once B1 has nothing unpinned.
+int32 find_clean_victim(int32 dirty_frame_id) {
+	int64 oldest = frameStamps[dirty_frame_id].time_array[FIRST_LAST_ACCESS];
+	int64 window = (int64) NBuffers * Min(Max(elru_dirty_age_tolerance, 0), 100) / 100;
+	int candidates_left = elru_dirty_lookahead - 1;
+
+	for (int32 frame_id = doubleLinkedList[dirty_frame_id].prev; frame_id != NIL_FRAME && candidates_left > 0; frame_id = doubleLinkedList[frame_id].prev) {
+		uint32 state = pg_atomic_read_u32(&GetBufferDescriptor(frame_id)->state);
 
-	//elog(LOG, "managed to update time for frame %d", frame->frame_id);
+		if ((int64) frameStamps[frame_id].time_array[FIRST_LAST_ACCESS] - oldest > window) {
+			break;
+		}
 
-	// delete frame from B2 if it exists first, then insert into B2 at the correct position
-	delete_other_arbitrarily(frame->frame_id);
+		if (BUF_STATE_GET_REFCOUNT(state) != 0) {
+			continue;
+		}
 
-	//elog(LOG, "managed to delete frame from B2");
+		if (!(state & BM_DIRTY)) {
+			return frame_id;
+		}
 
-	delete_arbitrarily(frame->frame_id);
+		candidates_left--;
+	}
 
-	//elog(LOG, "managed to delete frame from B1");
+	return NIL_FRAME;
+}
 
-	if (otherLinkedListInfo->tail == NULL) { // If B2 is empty
-		//elog(LOG, "B2 is empty");
-		otherLinkedListInfo->head = otherLinkedListInfo->tail = frame;
-		frame->prev = frame->next = NULL;
+// Record an access of the frame: every stamp moves one place back, the K-th last access dropping out, and the access
+// becomes the last. The caller holds both locks of the frame's partition exclusively.
+void update_time(node* frame) {
+	partition_info* part = PARTITION_OF(FRAME_ID(frame));
+	uint64_t counter = clock_now();
+	uint32 now;
+	uint32 stamps[ELRU_MAX_K];
+
+	if (counter <= part->epoch) {
+		// Only with elru_clock_batch > 1: a backend's slice can predate the partition's latest rebase
+		now = 1;
 	} else {
-		//elog(LOG, "B2 is not empty");
-		traversal_ptr = otherLinkedListInfo->head;
-		//elog(LOG, "Access time and frame_id of traversal_ptr: %lu, %d", traversal_ptr->time_array[SECOND_LAST_ACCESS], traversal_ptr->frame_id);
-
-		while (traversal_ptr != NULL) {
-			if (traversal_ptr->time_array[SECOND_LAST_ACCESS] <= frame->time_array[SECOND_LAST_ACCESS]) {
-				//next_frame = traversal_ptr->next;
-				prev_frame = traversal_ptr->prev;
-
-				if (prev_frame) {
-					prev_frame->next = frame;
-				} else {
-					otherLinkedListInfo->head = frame;
-				}
+		if (counter - part->epoch >= ELRU_EPOCH_LIMIT) {
+			rebase_time(part, counter);
+		}
+		now = (uint32) (counter - part->epoch);
+	}
 
-				//elog(LOG, "Inserting frame %d into B2 at position %d", frame->frame_id, traversal_ptr->frame_id);
+	// Stamps of one frame must never go backwards (B2 relies on it), which a batched clock could otherwise do
+	now = Max(now, TIME_ARRAY(frame)[FIRST_LAST_ACCESS]);
+	//elog(LOG, "Updating time for frame %d, with counter: %u, frame first last access time: %u, frame second last access time: %u", FRAME_ID(frame), now, TIME_ARRAY(frame)[FIRST_LAST_ACCESS], TIME_ARRAY(frame)[SECOND_LAST_ACCESS]);
 
-				frame->prev = prev_frame;
-				frame->next = traversal_ptr;
-				traversal_ptr->prev = frame;
+	// Stamps of accesses the frame has not had are 0, so on its first access only the last access is set
+	get_history(frame, stamps);
+	memmove(&stamps[1], &stamps[0], (historyDepth - 1) * sizeof(uint32));
+	stamps[0] = now;
+	set_history(frame, stamps);
+	//elog (LOG, "Updated second last access time to: %u, and first last access time to: %u", TIME_ARRAY(frame)[SECOND_LAST_ACCESS], TIME_ARRAY(frame)[FIRST_LAST_ACCESS]);
+}
+
+// Move the partition's epoch forward so that stamps keep fitting in 32 bits. Called from update_time with both of the
+// partition's locks held exclusively, roughly once every 2^30 accesses. Only the partition's own frames are touched.
+// A partition can go untouched while the counter keeps moving, so the epoch moves by as many ELRU_EPOCH_SHIFTs as
+// needed to get back under ELRU_EPOCH_LIMIT. Stamps older than the shift are clamped to 1, which keeps them ordered
+// before every newer stamp.
+void rebase_time(partition_info* part, uint64_t counter) {
+	uint64_t shift = ELRU_EPOCH_SHIFT * ((counter - part->epoch - ELRU_EPOCH_LIMIT) / ELRU_EPOCH_SHIFT + 1);
+
+	if (part->wheel.width > 0) {
+		// Bring the wheel up to date, then shift by whole turns of the wheel so every frame keeps its bucket
+		b2_wheel_advance(part, (counter - part->epoch) / part->wheel.width);
+		shift -= shift % (part->wheel.width * ELRU_B2_NUM_BUCKETS);
+		part->wheel.base_epoch -= shift / part->wheel.width;
+	}
 
-				// Edge case - Insertion with one element only (HEAD & TAIL both pointing to the same element)
-				// if (otherLinkedListInfo->head == otherLinkedListInfo->tail) {
-				// 	otherLinkedListInfo->tail = traversal_ptr;
-				// }
+	for (int i = part - partitionInfo; i < NBuffers; i += numPartitions) {
+		uint32 stamps[ELRU_MAX_K];
 
-				return;
+		get_history(&doubleLinkedList[i], stamps);
+		for (int k = 0; k < historyDepth; k++) {
+			if (stamps[k] != 0) {
+				stamps[k] = (stamps[k] > shift) ? (uint32) (stamps[k] - shift) : 1;
 			}
+		}
+		set_history(&doubleLinkedList[i], stamps);
+	}
 
-			traversal_ptr = traversal_ptr->next;
+	// Clamping can tie stamps that used to differ, which may break the tie-break on the last access - rebuild the heap
+	if (part->wheel.width == 0) {
+		for (int i = part->b2.size / 2 - 1; i >= 0; i--) {
+			b2_heap_sift_down(part, i);
 		}
+	}
+
+	part->epoch += shift;
+}
 
-		// If frame has the lowest rank, insert at the end
+// LRU-K history - Function definitions
+
+// K, elru_k clamped to [2, ELRU_MAX_K]
+int elru_history_depth(void) {
+	return Min(Max(elru_k, 2), ELRU_MAX_K);
+}
+
+// Slots of the retained history, elru_history_percent of NBuffers. Up to 4 times NBuffers pages may be remembered.
+int elru_history_capacity(void) {
+	return (int) ((int64) NBuffers * Min(Max(elru_history_percent, 0), 400) / 100);
+}
 
-		//elog(LOG, "Inserting frame %d into B2 at the end", frame->frame_id);
-		
-		otherLinkedListInfo->tail->next = frame;
-		frame->prev = otherLinkedListInfo->tail;
-		frame->next = NULL;
-		otherLinkedListInfo->tail = frame;
+uint32 history_num_buckets(int capacity) {
+	return pg_nextpower2_32((uint32) Max(capacity, 1));
+}
 
-		//elog(LOG, "Successfully inserted frame %d into B2 at the end", frame->frame_id);
+// Copy the K stamps of a frame into 'stamps', the last access first and the K-th last access last
+void get_history(node* frame, uint32* stamps) {
+	stamps[0] = TIME_ARRAY(frame)[FIRST_LAST_ACCESS];
+	if (historyDepth > 2) {
+		memcpy(&stamps[1], MIDDLE_STAMPS(FRAME_ID(frame)), (historyDepth - 2) * sizeof(uint32));
 	}
+	stamps[historyDepth - 1] = TIME_ARRAY(frame)[SECOND_LAST_ACCESS];
 }
 
-//Moves a frame in otherLinkedListInfo to the head of the list
-void move_to_head_b2(node* frame) {
-	//elog(LOG, "Moving frame %d to the head of B2", frame->frame_id);
-	if (frame == otherLinkedListInfo->head) {
-		return;
+// Set the K stamps of a frame, in the order get_history returns them
+void set_history(node* frame, const uint32* stamps) {
+	TIME_ARRAY(frame)[FIRST_LAST_ACCESS] = stamps[0];
+	if (historyDepth > 2) {
+		memcpy(MIDDLE_STAMPS(FRAME_ID(frame)), &stamps[1], (historyDepth - 2) * sizeof(uint32));
 	}
+	TIME_ARRAY(frame)[SECOND_LAST_ACCESS] = stamps[historyDepth - 1];
+}
 
-	if (frame == otherLinkedListInfo->tail) {
-		otherLinkedListInfo->tail = frame->prev;
-		otherLinkedListInfo->tail->next = NULL;
-	} else {
-		frame->prev->next = frame->next;
-		frame->next->prev = frame->prev;
+// Forget every access of a frame, for a frame that is getting a new page
+void clear_history(node* frame) {
+	uint32 stamps[ELRU_MAX_K] = {0};
+
+	set_history(frame, stamps);
+}
+
+// Retained history - Function definitions. history_unlink and history_lookup are called with history_lock held
+// exclusively.
+
+uint32 history_bucket_of(const BufferTag* tag) {
+	return BufTableHashCode((BufferTag*) tag) & (historyTable->num_buckets - 1);
+}
+
+// Slot of the entry for page 'tag', or NIL_FRAME if its history is not retained
+int32 history_lookup(const BufferTag* tag) {
+	for (int32 slot = historyBuckets[history_bucket_of(tag)]; slot != NIL_FRAME; slot = historyEntries[slot].hash_next) {
+		if (BufferTagsEqual(&historyEntries[slot].tag, tag)) {
+			return slot;
+		}
 	}
 
-	frame->next = otherLinkedListInfo->head;
-	frame->prev = NULL;
-	otherLinkedListInfo->head->prev = frame;
-	otherLinkedListInfo->head = frame;
+	return NIL_FRAME;
 }
 
-void delete_other_arbitrarily(int frame_id_for_deletion) {
-	//elog(LOG, "Deleting frame %d from B2", frame_id_for_deletion);
-	node* frame_for_deletion = search_for_frame_b2(frame_id_for_deletion);
-	//elog(LOG, "Frame %d found in B2 in delete_other_arbitrarily", frame_id_for_deletion);
+// Take the entry in 'slot' off its hash chain. Chains are about one entry long, as there are at least as many buckets
+// as slots.
+void history_unlink(int slot) {
+	int32* link = &historyBuckets[history_bucket_of(&historyEntries[slot].tag)];
 
-	if (!frame_for_deletion) { // Handle case where frame is not found
-		return;
+	while (*link != slot) {
+		Assert(*link != NIL_FRAME);
+		link = &historyEntries[*link].hash_next;
 	}
 
-	if (frame_for_deletion == otherLinkedListInfo->head) { // Correctly check and update head
-		//elog(LOG, "if (frame_for_deletion == otherLinkedListInfo->head) triggered in delete_other_arbitrarily");
-		if (otherLinkedListInfo->head->next) { // Check if there's a next node
-			otherLinkedListInfo->head = otherLinkedListInfo->head->next;
-			otherLinkedListInfo->head->prev = NULL;
-		} else { // List becomes empty
-			otherLinkedListInfo->head = otherLinkedListInfo->tail = NULL;
-		}
-	} else if (frame_for_deletion == otherLinkedListInfo->tail) { // Correctly check and update tail
-		//elog(LOG, "if (frame_for_deletion == otherLinkedListInfo->tail) triggered in delete_other_arbitrarily");
-		otherLinkedListInfo->tail = otherLinkedListInfo->tail->prev;
-		otherLinkedListInfo->tail->next = NULL;
-	} else { // Node is in the middle
-		//elog(LOG, "else triggered in delete_other_arbitrarily");
-		//log check if prev or next is null
-		if (frame_for_deletion->prev && frame_for_deletion->next) {
-			//elog(LOG, "Prev frame of frame %d: %d, Next frame of frame %d: %d", frame_id_for_deletion, frame_for_deletion->prev->frame_id, frame_id_for_deletion, frame_for_deletion->next->frame_id);
-		} else if (frame_for_deletion->prev) {
-			//elog(LOG, "Prev frame of frame %d: %d, Next frame of frame %d: NULL", frame_id_for_deletion, frame_for_deletion->prev->frame_id, frame_id_for_deletion);
-			//search for frame right after the frame with the frame to be deleted
-			node* after_frame = search_for_frame_after(frame_id_for_deletion);
-			frame_for_deletion->next = after_frame;
-		} else if (frame_for_deletion->next) {
-			//elog(LOG, "Prev frame of frame %d: NULL, Next frame of frame %d: %d", frame_id_for_deletion, frame_id_for_deletion, frame_for_deletion->next->frame_id);
-			//search for frame right before the frame with the frame to be deleted
-			node* before_frame = search_for_frame_before(frame_id_for_deletion);
-			frame_for_deletion->prev = before_frame;
-		} else {
-			//elog(LOG, "Prev frame of frame %d: NULL, Next frame of frame %d: NULL", frame_id_for_deletion, frame_id_for_deletion);
-		}
-		///////////////////////////////////////
-		if (frame_for_deletion->prev && frame_for_deletion->next) {
-			//elog(LOG, "New Prev frame of frame %d: %d, New Next frame of frame %d: %d", frame_id_for_deletion, frame_for_deletion->prev->frame_id, frame_id_for_deletion, frame_for_deletion->next->frame_id);
-		} else if (frame_for_deletion->prev) {
-			//elog(LOG, "New Prev frame of frame %d: %d, New Next frame of frame %d: NULL", frame_id_for_deletion, frame_for_deletion->prev->frame_id, frame_id_for_deletion);
-		} else if (frame_for_deletion->next) {
-			//elog(LOG, "New Prev frame of frame %d: NULL, New Next frame of frame %d: %d", frame_id_for_deletion, frame_id_for_deletion, frame_for_deletion->next->frame_id);
-		} else {
-			//elog(LOG, "New Prev frame of frame %d: NULL, New Next frame of frame %d: NULL", frame_id_for_deletion, frame_id_for_deletion);
-		}
+	*link = historyEntries[slot].hash_next;
+	historyEntries[slot].valid = false;
+}
 
-		// if (otherLinkedListInfo->head != NULL)
-		// 	//elog(LOG, "Head of B2: %d", otherLinkedListInfo->head->frame_id);
-		// if (linkedListInfo->head != NULL)
-		// 	//elog(LOG, "Head of B1: %d", linkedListInfo->head->frame_id);
-		// // only log tail if it exists
-		// if (otherLinkedListInfo->tail != NULL)
-		// 	//elog(LOG, "Tail of B2: %d", otherLinkedListInfo->tail->frame_id);
-		// if (linkedListInfo->tail != NULL)
-		// 	//elog(LOG, "Tail of B1: %d", linkedListInfo->tail->frame_id);
+// Retain the history of page 'tag', which is being evicted from 'frame', dropping the oldest entry if the table is
+// full. The page may already have an entry, if it was read back in and evicted again before its history was looked
+// up; that entry is dropped in favour of the new one. Called by claim_victim with both of the frame's partition locks
+// held exclusively, but not the buffer header lock.
+void save_history(node* frame, const BufferTag* tag) {
+	partition_info* part = PARTITION_OF(FRAME_ID(frame));
+	uint32 stamps[ELRU_MAX_K];
+	uint64_t* retained;
+	int32 slot;
+	uint32 bucket;
 
-		// elog(LOG, "I love CS3223!");	
-		//log_linked_list(linkedListInfo);
-		//log_linked_list_backwards(linkedListInfo);
-		//log_b2_linked_list(otherLinkedListInfo);
-		//log_b2_linked_list_backwards(otherLinkedListInfo);	
+	get_history(frame, stamps);
 
-		frame_for_deletion->prev->next = frame_for_deletion->next;
-		frame_for_deletion->next->prev = frame_for_deletion->prev;
+	LWLockAcquire(&historyTable->history_lock, LW_EXCLUSIVE);
 
-		frame_for_deletion->next = NULL;
-		frame_for_deletion->prev = NULL;
+	slot = history_lookup(tag);
+	if (slot != NIL_FRAME) {
+		history_unlink(slot);
 	}
-}
 
-// Search for frame in B2
-node* search_for_frame_b2(int desired_frame_id) {
-	node* traversal_ptr;
+	slot = historyTable->next;
+	historyTable->next = (slot + 1) % historyTable->capacity;
 
-	if (otherLinkedListInfo->head == NULL) { 
-		//elog(ERROR, "otherLinkedListInfo is empty");
-		return NULL; // Handle empty list case properly
-	} else {
-		traversal_ptr = otherLinkedListInfo->head;
-		//log head 
-		// if (otherLinkedListInfo->head != NULL)
-		// 	elog(LOG, "Head of B2: %d", otherLinkedListInfo->head->frame_id);
-		// if (linkedListInfo->head != NULL)
-		// 	elog(LOG, "Head of B1: %d", linkedListInfo->head->frame_id);
-		// // only log tail if it exists
-		// if (otherLinkedListInfo->tail != NULL)
-		// 	elog(LOG, "Tail of B2: %d", otherLinkedListInfo->tail->frame_id);
-		// if (linkedListInfo->tail != NULL)
-		// 	elog(LOG, "Tail of B1: %d", linkedListInfo->tail->frame_id);
-
-		// log_linked_list(linkedListInfo);
-		// log_linked_list_backwards(linkedListInfo);
-		// log_b2_linked_list(otherLinkedListInfo);
-		// log_b2_linked_list_backwards(otherLinkedListInfo);		
-
-		while (traversal_ptr != NULL) {
-			if (traversal_ptr->frame_id == desired_frame_id) {
-				return traversal_ptr;
-			}
+	if (historyEntries[slot].valid) {
+		history_unlink(slot);
+	}
 
-			traversal_ptr = traversal_ptr->next;
-		}
+	bucket = history_bucket_of(tag);
+	historyEntries[slot].tag = *tag;
+	historyEntries[slot].valid = true;
+	historyEntries[slot].hash_next = historyBuckets[bucket];
+	historyBuckets[bucket] = slot;
+
+	retained = &historyStamps[slot * historyDepth];
+	for (int k = 0; k < historyDepth; k++) {
+		retained[k] = (stamps[k] != 0) ? part->epoch + stamps[k] : 0;
 	}
 
-	return NULL; // Return NULL if frame_id not found
+	LWLockRelease(&historyTable->history_lock);
 }
 
-//search and return pointer to frame right before the frame with the desired frame_id in B2
-node* search_for_frame_before(int desired_frame_id) {
-	node* traversal_ptr;
-
-	if (otherLinkedListInfo->head == NULL) { 
-		return NULL; // Handle empty list case properly
-	} else {
-		traversal_ptr = otherLinkedListInfo->head;
+// Look up the retained history of page 'tag', which has been read into the fresh frame 'frame', and append it to the
+// accesses the page has had since it was loaded, up to K stamps in all. The entry is dropped, as its page is resident
+// again. Returns true if there was history to append. Called with both of the frame's partition locks held
+// exclusively, but not the buffer header lock.
+bool restore_history(node* frame, const BufferTag* tag) {
+	partition_info* part = PARTITION_OF(FRAME_ID(frame));
+	uint64_t retained[ELRU_MAX_K];
+	uint32 stamps[ELRU_MAX_K];
+	uint64_t now;
+	int32 slot;
+	int k = 0;
+
+	frame->fresh = false;
+
+	if (historyTable->capacity == 0) {
+		return false;
+	}
 
-		while (traversal_ptr != NULL && traversal_ptr->next != NULL) {
-			if (traversal_ptr->next->frame_id == desired_frame_id) {
-				return traversal_ptr;
-			}
+	LWLockAcquire(&historyTable->history_lock, LW_EXCLUSIVE);
 
-			traversal_ptr = traversal_ptr->next;
-		}
+	slot = history_lookup(tag);
+	if (slot != NIL_FRAME) {
+		memcpy(retained, &historyStamps[slot * historyDepth], historyDepth * sizeof(uint64_t));
+		history_unlink(slot);
 	}
 
-	return NULL; // Return NULL if frame_id not found
-}
+	LWLockRelease(&historyTable->history_lock);
 
-//search and return pointer to frame right after the frame with the desired frame_id, this has to search from the tail
-node* search_for_frame_after(int desired_frame_id) {
-	node* traversal_ptr;
+	if (slot == NIL_FRAME) {
+		return false;
+	}
 
-	if (otherLinkedListInfo->tail == NULL) { 
-		return NULL; // Handle empty list case properly
-	} else {
-		traversal_ptr = otherLinkedListInfo->tail;
+	// Past the retained information period, the history no longer says anything about the page
+	now = clock_now();
+	if (elru_retained_period > 0 && now > retained[0]
+		&& now - retained[0] > (uint64_t) NBuffers * elru_retained_period / 100) {
+		return false;
+	}
 
-		while (traversal_ptr != NULL && traversal_ptr->prev != NULL) {
-			if (traversal_ptr->prev->frame_id == desired_frame_id) {
-				
-				return traversal_ptr;
-			}
+	get_history(frame, stamps);
+	while (k < historyDepth && stamps[k] != 0) {
+		k++;
+	}
 
-			elog(LOG, "traversal_ptr->frame_id: %d", traversal_ptr->frame_id);
+	// The retained stamps predate every stamp the page got since, but are rebased on the frame's partition, whose
+	// epoch may be later than the oldest of them; those are clamped to 1, as rebase_time does
+	for (int i = 0; k < historyDepth && retained[i] != 0; i++, k++) {
+		uint64_t stamp = (retained[i] > part->epoch) ? retained[i] - part->epoch : 1;
 
-			traversal_ptr = traversal_ptr->prev;
+		if (k > 0) {
+			stamp = Min(stamp, stamps[k - 1]);
 		}
+		stamps[k] = (uint32) Max(stamp, 1);
 	}
 
-	return NULL; // Return NULL if frame_id not found
+	set_history(frame, stamps);
+	return true;
 }
 
-// Update time array depending if first or accessed again
-void update_time(node* frame) {
-	//acquire spinlock for counter
-	SpinLockAcquire(&counterInfo->counter_spinlock);
-	//elog(LOG, "Updating time for frame %d, with counter: %lu, frame first last access time: %lu, frame second last access time: %lu", frame->frame_id, counterInfo->counter, frame->time_array[FIRST_LAST_ACCESS], frame->time_array[SECOND_LAST_ACCESS]);
-	bool not_first_update;
-	//If both array values are zero then it is the first time the frame is being accessed
-	if (frame->time_array[SECOND_LAST_ACCESS] == 0 && frame->time_array[FIRST_LAST_ACCESS] == 0) {
-		//elog(LOG, "First update for frame %d", frame->frame_id);
-		not_first_update = false;
-	} else {
-		//elog(LOG, "Not first update for frame %d", frame->frame_id);
-		not_first_update = true;
+// Called on the first hit of a fresh frame, holding both of its partition's locks exclusively: looks up the history
+// the page had before it was last evicted. The caller usually has the buffer pinned; if not (an access ring flush), the
+// tag may already belong to a later page, which only costs a stale hint.
+void recall_history(node* frame) {
+	BufferDesc* buf = GetBufferDescriptor(FRAME_ID(frame));
+	uint32 buf_state;
+	BufferTag tag;
+
+	frame->fresh = false;
+
+	if (historyTable->capacity == 0) {
+		return;
 	}
-	if (not_first_update) {
-		frame->time_array[SECOND_LAST_ACCESS] = frame->time_array[FIRST_LAST_ACCESS];
-		frame->time_array[FIRST_LAST_ACCESS] = counterInfo->counter;
-		//elog (LOG, "Updated second last access time to: %lu, and first last access time to: %lu", frame->time_array[SECOND_LAST_ACCESS], frame->time_array[FIRST_LAST_ACCESS]);
-	} else {
-		frame->time_array[FIRST_LAST_ACCESS] = counterInfo->counter;
-		//elog (LOG, "Updated first last access time to: %lu", frame->time_array[FIRST_LAST_ACCESS]);
+
+	buf_state = LockBufHdr(buf);
+	tag = buf->tag;
+	UnlockBufHdr(buf, buf_state);
+
+	if (buf_state & BM_TAG_VALID) {
+		(void) restore_history(frame, &tag);
 	}
-	//release spinlock for counter
-	SpinLockRelease(&counterInfo->counter_spinlock);
 }
 
-
+// Caller must hold the list's lock; shared mode is enough
 char* print_list_to_string(info* linkedListInfo) {
     // Initial allocation for the string
     int str_size = 256; // Initial size, may need to increase depending on list size
@@ -477,12 +1758,12 @@ char* print_list_to_string(info* linkedListInfo) {
 
     list_str[0] = '\0'; // Start with an empty string
 
-    node* current = linkedListInfo->head;
+    int32 current = linkedListInfo->head;
     int offset = 0; // Keep track of the number of characters written
 
 	int debug_limit = 0;
 
-    while (current != NULL && debug_limit < 100 && current->frame_id != -1) {
+    while (current != NIL_FRAME && debug_limit < 100) {
         // Check remaining buffer size and reallocate if necessary
         if (str_size - offset < 50) { // Ensure there's at least 50 chars of space
             str_size *= 2; // Double the buffer size
@@ -494,7 +1775,7 @@ char* print_list_to_string(info* linkedListInfo) {
         }
 
         // Append current node's frame_id to the string
-        int written = snprintf(list_str + offset, str_size - offset, "Frame ID: %d -> ", current->frame_id);
+        int written = snprintf(list_str + offset, str_size - offset, "Frame ID: %d -> ", current);
         if (written > 0) {
             offset += written; // Increase offset by the number of characters written
         } else {
@@ -503,7 +1784,7 @@ char* print_list_to_string(info* linkedListInfo) {
             return NULL;
         }
 
-        current = current->next;
+        current = doubleLinkedList[current].next;
 		debug_limit++;
     }
 
@@ -527,12 +1808,12 @@ char* print_list_to_string_backwards(info* linkedListInfo) {
 
 	list_str[0] = '\0'; // Start with an empty string
 
-	node* current = linkedListInfo->tail;
+	int32 current = linkedListInfo->tail;
 	int offset = 0; // Keep track of the number of characters written
 
 	int debug_limit = 0;
 
-	while (current != NULL && debug_limit < 100 && current->frame_id != -1) {
+	while (current != NIL_FRAME && debug_limit < 100) {
 		// Check remaining buffer size and reallocate if necessary
 		if (str_size - offset < 50) { // Ensure there's at least 50 chars of space
 			str_size *= 2; // Double the buffer size
@@ -544,7 +1825,7 @@ char* print_list_to_string_backwards(info* linkedListInfo) {
 		}
 
 		// Append current node's frame_id to the string
-		int written = snprintf(list_str + offset, str_size - offset, "Frame ID: %d -> ", current->frame_id);
+		int written = snprintf(list_str + offset, str_size - offset, "Frame ID: %d -> ", current);
 		if (written > 0) {
 			offset += written; // Increase offset by the number of characters written
 		} else {
@@ -553,7 +1834,7 @@ char* print_list_to_string_backwards(info* linkedListInfo) {
 			return NULL;
 		}
 
-		current = current->prev;
+		current = doubleLinkedList[current].prev;
 		debug_limit++;
 	}
 
@@ -644,6 +1925,42 @@ typedef struct
 	 * StrategyNotifyBgWriter.
 	 */
 	int			bgwprocno;
+
+	/*
+	 * CS3223: Partition the next victim search starts from, taken modulo the
+	 * number of list partitions.
+	 */
+	pg_atomic_uint32 nextVictimPartition;
+
+	/*
+	 * CS3223: LWLock tranche of the B1 and B2 partition locks, so waits on
+	 * them show up as "ELRUList" in pg_stat_activity.
+	 */
+	int			listLockTrancheId;
+
+	/*
+	 * CS3223: Victim search statistics while elru_dirty_lookahead is on.
+	 * Every clean substitution is a write the backend did not have to do;
+	 * dirtyEvictions counts the dirty B1 victims it could not avoid.
+	 */
+	pg_atomic_uint64 cleanSubstitutions;
+	pg_atomic_uint64 dirtyEvictions;
+
+	/*
+	 * CS3223: Buffers recycled by BufferAccessStrategy rings, against
+	 * victims evicted from B1/B2 for a ring and for everybody else.
+	 * Freelist allocations are not counted.
+	 */
+	pg_atomic_uint64 ringReuses;
+	pg_atomic_uint64 ringEvictions;
+	pg_atomic_uint64 poolEvictions;
+
+	/*
+	 * CS3223: References that did not count, as they fell inside the
+	 * correlated reference period or came from a backend that already had
+	 * the buffer pinned.
+	 */
+	pg_atomic_uint64 correlatedReferences;
 } BufferStrategyControl;
 
 /* Pointers to shared state */
@@ -773,91 +2090,95 @@ have_free_buffer(void)
 // Called by bufmgr when a buffer page is accessed.
 // Adjusts the position of buffer (identified by buf_id) in the LRU stack if delete is false;
 // otherwise, delete buffer buf_id from the LRU stack.
+// Takes the partition's LWLocks.
 void
 StrategyAccessBuffer(int buf_id, bool delete)
 {
-	//log entered function for buf_id and delete is true or false
-	//elog(LOG, "Entered StrategyAccessBuffer for buffer %d, delete: %d", buf_id, delete);
-	//acquire spinlock for counter
-	SpinLockAcquire(&counterInfo->counter_spinlock);
-	counterInfo->counter++;
-	//release spinlock for counter
-	SpinLockRelease(&counterInfo->counter_spinlock);
-	//elog(LOG, "Incremented Counter at StrategyAccessBuffer to: %lu", counterInfo->counter);
+
+	// CS3223: A reference correlated with the frame's last access does not count, see skip_correlated
+	if (!delete && skip_correlated(buf_id)) {
+		pg_atomic_fetch_add_u64(&StrategyControl->correlatedReferences, 1);
+		return;
+	}
+
+	// CS3223: Every other hit counts towards the page's popularity, however the lists treat it, see record_frequency
+	if (!delete && admissionFilter) {
+		record_frequency(buf_id);
+	}
+
+	// CS3223: Ring frames only the ring uses stay at the tail of B1, see skip_ring_promotion
+	if (!delete && skip_ring_promotion(buf_id)) {
+		return;
+	}
+
+	// CS3223: Re-references that closely follow the last access of a B2 frame are dropped, see skip_promotion
+	if (!delete && skip_promotion(buf_id)) {
+		return;
+	}
+
+	// CS3223: With the access ring enabled, a re-reference is recorded now and applied later, see record_access
+	if (!delete && record_access(buf_id)) {
+		return;
+	}
+
+	clock_tick();
+	partition_info* part = PARTITION_OF(buf_id);
 	node* frame;
 	if (delete) {
-		//elog(LOG, "entered delete of strategy access buffer");
-        SpinLockAcquire(&linkedListInfo->linkedListInfo_spinlock);
-		//elog(LOG, "Spinlock acquired for linkedListInfo");
-		////elog(LOG, "SpinLOCK A");
-		//log_linked_list(linkedListInfo);
-		//log_b2_linked_list(otherLinkedListInfo);
+        LWLockAcquire(&part->b1.linkedListInfo_lock, LW_EXCLUSIVE);
 
         delete_arbitrarily(buf_id);
-		// doubleLinkedList[buf_id].next = NULL;
-		// doubleLinkedList[buf_id].prev = NULL;
-		// doubleLinkedList[buf_id].frame_id = -1;
-		// doubleLinkedList[buf_id].time_array[0] = 0;
-		// doubleLinkedList[buf_id].time_array[1] = 0;
-		// doubleLinkedList[buf_id].sanity_check = 42069;
-
-        SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-		////elog(LOG, "SpinRELEASE A");
-		//log_linked_list(linkedListInfo);
-		//log_b2_linked_list(otherLinkedListInfo);
+
+        LWLockRelease(&part->b1.linkedListInfo_lock);
 
 		// B2, did not exist in B1 so we have to delete from B2 now
-		SpinLockAcquire(&otherLinkedListInfo->linkedListInfo_spinlock);
+		LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
 
 		delete_other_arbitrarily(buf_id);
-		// otherDoubleLinkedList[buf_id].next = NULL;
-		// otherDoubleLinkedList[buf_id].prev = NULL;
-		// otherDoubleLinkedList[buf_id].frame_id = -1;
-		// otherDoubleLinkedList[buf_id].time_array[0] = 0;
-		// otherDoubleLinkedList[buf_id].time_array[1] = 0;
-		// otherDoubleLinkedList[buf_id].sanity_check = 42069;
-
-		SpinLockRelease(&otherLinkedListInfo->linkedListInfo_spinlock);
+
+		LWLockRelease(&part->b2.linkedListInfo_lock);
     } else {
-		//elog(LOG, "entered else of strategy access buffer");
-		SpinLockAcquire(&linkedListInfo->linkedListInfo_spinlock);
-		//elog(LOG, "Spinlock acquired for linkedListInfo");
-		SpinLockAcquire(&otherLinkedListInfo->linkedListInfo_spinlock);
-		//elog(LOG, "Spinlock acquired for otherLinkedListInfo");
-		////elog(LOG, "SpinLOCK B");
-		//log_linked_list(linkedListInfo);
-		//log_b2_linked_list(otherLinkedListInfo);
+		LWLockAcquire(&part->b1.linkedListInfo_lock, LW_EXCLUSIVE);
+		LWLockAcquire(&part->b2.linkedListInfo_lock, LW_EXCLUSIVE);
 
 		//Search for frame in B1
 		frame = search_for_frame(buf_id);
 		if (frame) {			
+			// CS3223: The page's first hit since it was loaded, so it may carry on with the history it had before
+			if (frame->fresh) {
+				recall_history(frame);
+			}
 			insert_into_b2(frame);			
 		} else {
 			// Frame does not exist in B1, so we have to search for it in B2
 			frame = search_for_frame_b2(buf_id);
 
 			if (frame) {
-				//elog(LOG, "Inserting frame %d into B2 again(to put it at new postion) from StrategyAccessBuffer if statement", frame->frame_id);
 				insert_into_b2(frame);
 			} else{
 				node* new_frame = &doubleLinkedList[buf_id];
-				new_frame->frame_id = buf_id;
-				new_frame->time_array[SECOND_LAST_ACCESS] = 0;
-				new_frame->time_array[FIRST_LAST_ACCESS] = 0;
-				new_frame->sanity_check = 42069;
-				//elog(LOG, "Inserting frame %d into B1 from StrategyAccessBuffer else statement", new_frame->frame_id);
+				clear_history(new_frame);
 				move_to_head(new_frame);
+				new_frame->fresh = true;
 			}
 		}
 
-		SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-		SpinLockRelease(&otherLinkedListInfo->linkedListInfo_spinlock);
-		////elog(LOG, "SpinRELEASE B");
-		//log_linked_list(linkedListInfo);
-		//log_b2_linked_list(otherLinkedListInfo);
+		LWLockRelease(&part->b1.linkedListInfo_lock);
+		LWLockRelease(&part->b2.linkedListInfo_lock);
 	}
 }
 
+// CS3223 - StrategyAccessPinnedBuffer
+// Called by bufmgr instead of StrategyAccessBuffer(buf_id, false) for a hit on a buffer the backend already has pinned,
+// i.e. that PinBuffer found a PrivateRefCount entry for. PrivateRefCount is private to bufmgr.c, so bufmgr has to tell
+// us. Such a reference is correlated with the one that took the backend's first pin, whatever the correlated reference
+// period, so the frame is left as it is; the reference is only counted.
+void
+StrategyAccessPinnedBuffer(int buf_id)
+{
+	pg_atomic_fetch_add_u64(&StrategyControl->correlatedReferences, 1);
+}
+
 /*
  * StrategyGetBuffer
  *
@@ -873,14 +2194,14 @@ StrategyAccessBuffer(int buf_id, bool delete)
 BufferDesc *
 StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_ring)
 {
-	//elog(LOG, "Entered StrategyGetBuffer");
-	//acquire spinlock for counter
-	SpinLockAcquire(&counterInfo->counter_spinlock);
-	counterInfo->counter++;
-	//release spinlock for counter
-	SpinLockRelease(&counterInfo->counter_spinlock);
 
-	//elog(LOG, "Incremented Counter at StrategyGetBuffer to: %lu", counterInfo->counter);
+	// CS3223: Victim selection has to see this backend's recent accesses, so apply its access ring first
+	if (accessRingCount > 0) {
+		flush_access_ring();
+	}
+
+	clock_tick();
+
 
 	BufferDesc *buf;
 	int			bgwprocno;
@@ -888,14 +2209,15 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
 
 	// CS3223
-	node* traversal_frame;
-	int fetched_frame_id;
-	node *fetched_frame;
+	int32 traversal_frame_id;
+	victim_entry seen;
+	victim_entry rival;
+	bool on_probation;
+	bool substituted;
+	partition_info* part;
+	int start_partition;
+	int partitions_left;
 
-	// B2
-	node* otherTraversal_frame;
-	int other_frame_id;
-	node *other_fetched_frame;
 
 	*from_ring = false;
 
@@ -904,17 +2226,32 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 	 * assume strategy objects don't need buffer_strategy_lock.
 	 */
 
-	// CS3223 - We check the freelist first before doing anything (strictly following LRU policy)
-	// if (strategy != NULL)
-	// {
-	// 	buf = GetBufferFromRing(strategy, buf_state);
-	// 	if (buf != NULL)
-	// 	{
-	// 		*from_ring = true;
-	// 		StrategyAccessBuffer(buf->buf_id, false); // cs3223
-	// 		return buf;
-	// 	}
-	// }
+	// CS3223: A recycled ring buffer is not promoted, it stays at the tail of B1 with the rest of its ring (see
+	// place_ring_frame). The ring's buffer may have been evicted and used by somebody else since, in which case it is
+	// moved back to the tail first, with the buffer header unlocked, and the buffer checked again. The unlocked look
+	// at the ring flag is only a hint.
+	if (strategy != NULL)
+	{
+		buf = GetBufferFromRing(strategy, buf_state);
+		if (buf != NULL && !doubleLinkedList[buf->buf_id].ring)
+		{
+			UnlockBufHdr(buf, *buf_state);
+			place_ring_frame(buf->buf_id);
+			*buf_state = LockBufHdr(buf);
+			if (BUF_STATE_GET_REFCOUNT(*buf_state) != 0
+				|| BUF_STATE_GET_USAGECOUNT(*buf_state) > 1)
+			{
+				UnlockBufHdr(buf, *buf_state);
+				buf = NULL;
+			}
+		}
+		if (buf != NULL)
+		{
+			*from_ring = true;
+			pg_atomic_fetch_add_u64(&StrategyControl->ringReuses, 1);
+			return buf;
+		}
+	}
 
 	/*
 	 * If asked, we need to waken the bgwriter. Since we don't want to rely on
@@ -993,6 +2330,15 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 			 */
 			SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 
+			//CS3223: Add buffer to the head of the linked list, or to the tail for a ring, before the buffer
+			// header is locked. If the buffer turns out to be unusable below, somebody is using it and it belongs
+			// in the lists anyway.
+			if (strategy != NULL) {
+				place_ring_frame(buf->buf_id);                             // Case 2, for a ring
+			} else {
+				StrategyAccessBuffer(buf->buf_id, false);                  // Case 2
+			}
+
 			/*
 			 * If the buffer is pinned or has a nonzero usage_count, we cannot
 			 * use it; discard it and retry.  (This can only happen if VACUUM
@@ -1004,19 +2350,8 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
 				&& BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
 			{
-				
-				// SpinLockAcquire(&linkedListInfo->linkedListInfo_spinlock);
-				////elog(LOG, "Case 2");
-				//log_linked_list(linkedListInfo);
-				//log_b2_linked_list(otherLinkedListInfo);
-			
-				// AddBufferToRing(strategy, buf);
-				//CS3223: Add buffer to the head of the linked list
-				StrategyAccessBuffer(buf->buf_id, false);                      // Case 2
-				// SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-				////elog(LOG, "Case 2");
-				//log_linked_list(linkedListInfo);
-				//log_b2_linked_list(otherLinkedListInfo);
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
 				*buf_state = local_buf_state;
 				return buf;
 			}
@@ -1025,16 +2360,37 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 	}
 
 
+	// CS3223: Nothing on the freelist, so a buffer is evicted from the lists. There is no clock hand to sweep, but
+	// ticking it counts evictions, so StrategySyncStart reports how fast the bgwriter has to keep up.
+	(void) ClockSweepTick();
+	pg_atomic_fetch_add_u64(strategy != NULL ? &StrategyControl->ringEvictions : &StrategyControl->poolEvictions, 1);
+
+	// CS3223: Take a victim the bgwriter picked in advance if there is one
+	if (victimQueue->capacity > 0)
+	{
+		buf = pop_victim(&local_buf_state, strategy != NULL);
+		if (buf != NULL)
+		{
+			if (strategy != NULL)
+				AddBufferToRing(strategy, buf);
+			*buf_state = local_buf_state;
+			return buf;
+		}
+	}
+
 	/**************** Nothing on the freelist, so we run the LRU algorithm below ... ****************/
-	// 1. Start from tail
+	// 1. Start from tail of B1 of one partition
 	// 2. Traverse to head, while checking for a suitable frame to evict
+	// 3. Move on to the next partition, round-robin, until every partition's B1 has been searched
+	// 4. Only then fall back to B2, visiting the partitions in the same order
 
-	SpinLockAcquire(&linkedListInfo->linkedListInfo_spinlock);    // Acquire DLL lock
-	SpinLockAcquire(&otherLinkedListInfo->linkedListInfo_spinlock);
-	////elog(LOG, "SpinLOCK Case 3");
-	//log_linked_list(linkedListInfo);
-	//log_b2_linked_list(otherLinkedListInfo);
-	traversal_frame = linkedListInfo->tail;				          // Reset traversal to the tail
+	// Every call starts at the next partition so evictions are spread over all of them
+	start_partition = (numPartitions > 1) ? pg_atomic_fetch_add_u32(&StrategyControl->nextVictimPartition, 1) % numPartitions : 0;
+	partitions_left = numPartitions;
+	part = &partitionInfo[start_partition];
+
+	LWLockAcquire(&part->b1.linkedListInfo_lock, LW_SHARED);    // Acquire DLL lock, walking B1 only needs it shared
+	traversal_frame_id = part->b1.tail;				      // Reset traversal to the tail
 	trycounter = NBuffers;                                        // NOTE: NBuffers is 16 (as defined by Chee Yong) 
 
 	// Case 3
@@ -1046,130 +2402,98 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 		 * it; decrement the usage_count (unless pinned) and keep scanning.
 		 */
 
-		if (traversal_frame == NULL) {
+		if (traversal_frame_id == NIL_FRAME) {
 			// We must have traversed the entire list, or the list is empty
 			// i.e All buffers are pinned
 
 			// Thus, the result should be similar to Clock Policy (where all frames are pinned, none can be evicted)
 			// We follow their method there
-			traversal_frame = linkedListInfo->tail;				          // Reset traversal to the tail
-			//SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);    // Release the DLL spinlock we acquired before for(;;)
-			
-			//This is the case where B1 is empty (Original linked list is empty or has no unpinned frames)
-			//So we have to scan through B2 now to find and unpinned frame to evict
+			LWLockRelease(&part->b1.linkedListInfo_lock);    // Release the DLL lock we acquired before for(;;)
+
+			if (--partitions_left > 0) {
+				// This partition's B1 is empty or has no unpinned frames, try B1 of the next partition
+				part = &partitionInfo[(part - partitionInfo + 1) % numPartitions];
+				LWLockAcquire(&part->b1.linkedListInfo_lock, LW_SHARED);
+				traversal_frame_id = part->b1.tail;
+				continue;
+			}
 			
+			//This is the case where B1 is empty (Original linked list is empty or has no unpinned frames) in every partition
+			//So we have to take an unpinned frame from B2 now (exact heap, or the timing wheel in bucket mode)
+			if (!get_victim_from_b2(start_partition, &seen)) {
+				// i.e All buffers are pinned
+
+				// Thus, the result should be similar to Clock Policy (where all frames are pinned, none can be evicted)
+				// We follow their method there
+				elog(ERROR, "no unpinned buffers available");
+			}
 
-			otherTraversal_frame = otherLinkedListInfo->tail;
-			for (;;)
-			{
-				if (otherTraversal_frame == NULL) {
-					// We must have traversed the entire list, or the list is empty
-					// i.e All buffers are pinned
-
-					// Thus, the result should be similar to Clock Policy (where all frames are pinned, none can be evicted)
-					// We follow their method there
-					otherTraversal_frame = otherLinkedListInfo->tail;				          // Reset traversal to the tail
-					SpinLockRelease(&otherLinkedListInfo->linkedListInfo_spinlock);    // Release the DLL spinlock we acquired before for(;;)
-					SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock); 
-					elog(ERROR, "no unpinned buffers available");
-				}
+			// Should the B2 victim not be claimed, the search starts over at B1 of the start partition
+			partitions_left = numPartitions;
+			part = &partitionInfo[start_partition];
+			substituted = false;
+		} else {
+			buf = GetBufferDescriptor(traversal_frame_id);
+
+			// Only peek at the refcount here, the buffer header is locked by claim_victim
+			local_buf_state = pg_atomic_read_u32(&buf->state);
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0) {
+				traversal_frame_id = doubleLinkedList[traversal_frame_id].prev;
+				continue;
+			}
+
+			// A dirty victim would have to be written out by this backend first, so try a clean one close behind it
+			substituted = false;
+			if (elru_dirty_lookahead > 1 && (local_buf_state & BM_DIRTY)) {
+				int32 clean_frame_id = find_clean_victim(traversal_frame_id);
 
-				other_frame_id = otherTraversal_frame->frame_id;				
-				buf = GetBufferDescriptor(other_frame_id);
-				local_buf_state = LockBufHdr(buf);
-
-				if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-				{
-					// Found a usable buffer
-					// AddBufferToRing(strategy, other_fetched_frame);
-					////elog(LOG, "SpinRELEASE Case 3 else");
-					//log_linked_list(linkedListInfo);
-					//log_b2_linked_list(otherLinkedListInfo);
-
-					other_fetched_frame = search_for_frame_b2(other_frame_id);
-					//log insert at head called from strategygetbuffer
-					//elog(LOG, "Inserting frame %d into B1 from strategygetbuffer", other_fetched_frame->frame_id);
-					delete_other_arbitrarily(other_fetched_frame->frame_id);
-					otherDoubleLinkedList[other_fetched_frame->frame_id].next = NULL;
-					otherDoubleLinkedList[other_fetched_frame->frame_id].prev = NULL;
-					otherDoubleLinkedList[other_fetched_frame->frame_id].frame_id = -1;
-					otherDoubleLinkedList[other_fetched_frame->frame_id].time_array[0] = 0;
-					otherDoubleLinkedList[other_fetched_frame->frame_id].time_array[1] = 0;
-					otherDoubleLinkedList[other_fetched_frame->frame_id].sanity_check = 42069;
-					move_to_head(other_fetched_frame);
-					SpinLockRelease(&otherLinkedListInfo->linkedListInfo_spinlock);
-					SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock); 
-
-					*buf_state = local_buf_state;
-					return buf;
+				if (clean_frame_id != NIL_FRAME) {
+					traversal_frame_id = clean_frame_id;
+					substituted = true;
 				}
-				UnlockBufHdr(buf, local_buf_state);
-				otherTraversal_frame = otherTraversal_frame -> prev;
 			}
 
+			// Looks unpinned. Remember the frame's version (its stamps, as every move of a frame stamps it) and let go
+			// of B1: claim_victim takes the locks back only to move the frame, and locks the buffer header after that,
+			// so no list lock is held across a buffer header lock.
+			see_frame(traversal_frame_id, &seen);
+
+			// A page in B1 has to beat the B2 victim to stay, see apply_admission
+			on_probation = admissionFilter && find_admission_rival(&seen, &rival);
+
+			LWLockRelease(&part->b1.linkedListInfo_lock);
+
+			if (on_probation && apply_admission(&seen, &rival)) {
+				seen = rival;
+				substituted = false;
+			}
 		}
 
-		fetched_frame_id = traversal_frame->frame_id;
-		buf = GetBufferDescriptor(fetched_frame_id);
-		local_buf_state = LockBufHdr(buf);
+		buf = claim_victim(&seen, strategy != NULL, &local_buf_state);
+		if (buf != NULL) {
+			if (strategy != NULL) {
+				AddBufferToRing(strategy, buf);
+			}
 
-		//elog(NOTICE, "fetched_frame is %d", fetched_frame_id);
-		//elog(NOTICE, "RC is %d", BUF_STATE_GET_REFCOUNT(local_buf_state));
+			if (elru_dirty_lookahead > 1) {
+				if (local_buf_state & BM_DIRTY) {
+					pg_atomic_fetch_add_u64(&StrategyControl->dirtyEvictions, 1);
+				} else if (substituted) {
+					pg_atomic_fetch_add_u64(&StrategyControl->cleanSubstitutions, 1);
+				}
+			}
 
-		// Check if the frame_id will be valid below...
-		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-		{
-			////elog(LOG, "Entered: if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0) ");
-			// if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
-			// {
-			// 	local_buf_state -= BUF_USAGECOUNT_ONE;
-			// 	trycounter = NBuffers;
-			// }
-			// else
-			//{
-				/* Found a usable buffer */
-				// if (strategy != NULL) {
-				// 	//elog(LOG, "Non-default strategy found a buffer");
-				// }
-				// AddBufferToRing(strategy, buf);
-
-			fetched_frame = search_for_frame(fetched_frame_id);
-			delete_other_arbitrarily(fetched_frame_id);
-			// otherDoubleLinkedList[fetched_frame_id].next = NULL;
-			// otherDoubleLinkedList[fetched_frame_id].prev = NULL;
-			// otherDoubleLinkedList[fetched_frame_id].frame_id = -1;
-			// otherDoubleLinkedList[fetched_frame_id].time_array[0] = 0;	
-			// otherDoubleLinkedList[fetched_frame_id].time_array[1] = 0;
-			// otherDoubleLinkedList[fetched_frame_id].sanity_check = 42069;			
-			move_to_head(fetched_frame);
-
-			SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-			SpinLockRelease(&otherLinkedListInfo->linkedListInfo_spinlock);
-
-			////elog(LOG, "SpinRELEASE Case 3 else");
-			//log_linked_list(linkedListInfo);
-			//log_b2_linked_list(otherLinkedListInfo);
 			*buf_state = local_buf_state;
 			return buf;
-			//}
 		}
-		// else if (--trycounter == 0)
-		// {
-		// 	/*
-		// 	 * We've scanned all the buffers without making any state changes,
-		// 	 * so all the buffers are pinned (or were when we looked at them).
-		// 	 * We could hope that someone will free one eventually, but it's
-		// 	 * probably better to fail than to risk getting stuck in an
-		// 	 * infinite loop.
-		// 	 */
-		// 	UnlockBufHdr(buf, local_buf_state);
-		// 	SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-		// 	//elog(LOG, "SpinRELEASE Case 3 elseif");
-		// 	//log_linked_list(linkedListInfo);
-		// 	elog(ERROR, "no unpinned buffers available");
-		// }
-		UnlockBufHdr(buf, local_buf_state);
-		traversal_frame = traversal_frame -> prev;
+
+		// Moved or pinned since we peeked, so where we were in B1 means nothing any more. Start again from the tail,
+		// but like the clock sweep give up rather than risk getting stuck in an infinite loop.
+		if (--trycounter == 0) {
+			elog(ERROR, "no unpinned buffers available");
+		}
+		LWLockAcquire(&part->b1.linkedListInfo_lock, LW_SHARED);
+		traversal_frame_id = part->b1.tail;
 	}
 }
 
@@ -1179,11 +2503,12 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 void
 StrategyFreeBuffer(BufferDesc *buf)
 {
-	//elog(LOG, "Entered StrategyFreeBuffer");
+
+	// Case 4
+	// CS3223: Unlink the frame before it becomes visible on the freelist, and before buffer_strategy_lock is taken
+	StrategyAccessBuffer(buf->buf_id, true);
+
 	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
-	////elog(LOG, "SpinLOCK Case 4");
-	//log_linked_list(linkedListInfo);
-	//log_b2_linked_list(otherLinkedListInfo);
 
 	/*
 	 * It is possible that we are told to put something in the freelist that
@@ -1195,16 +2520,9 @@ StrategyFreeBuffer(BufferDesc *buf)
 		if (buf->freeNext < 0)
 			StrategyControl->lastFreeBuffer = buf->buf_id;
 		StrategyControl->firstFreeBuffer = buf->buf_id;
-
-
-		// Case 4
-		StrategyAccessBuffer(buf->buf_id, true);
 	}
 
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
-	////elog(LOG, "SpinRELEASE Case 4");
-	//log_linked_list(linkedListInfo);
-	//log_b2_linked_list(otherLinkedListInfo);
 }
 
 /*
@@ -1217,6 +2535,11 @@ StrategyFreeBuffer(BufferDesc *buf)
  * the higher-order bits of nextVictimBuffer) and the count of recent buffer
  * allocs if non-NULL pointers are passed.  The alloc count is reset after
  * being read.
+ *
+ * CS3223: Here the clock hand only counts evictions from the lists (see
+ * StrategyGetBuffer), so the result and pass count tell the bgwriter how
+ * far eviction has got but not which buffers come next; BgBufferSync gets
+ * those from StrategySyncVictims.
  */
 int
 StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
@@ -1247,6 +2570,77 @@ StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
 	return result;
 }
 
+// Called by the bgwriter on every round. Replaces the contents of the victim queue with fresh victims from every
+// partition, clean ones first.
+void StrategyRefillVictimQueue(void) {
+	int capacity = victimQueue->capacity;
+	int num_entries;
+	victim_entry* picked;
+
+	if (capacity == 0) {
+		return;
+	}
+
+	victimQueue->bgwprocno = MyProc->pgprocno;
+
+	picked = palloc(mul_size(sizeof(victim_entry), capacity));
+	num_entries = collect_victims(picked, capacity, true, pg_atomic_read_u32(&StrategyControl->nextVictimPartition) % numPartitions);
+
+	SpinLockAcquire(&victimQueue->victimQueue_spinlock);
+	memcpy(victimQueue->entries, picked, mul_size(sizeof(victim_entry), num_entries));
+	victimQueue->head = 0;
+	victimQueue->count = num_entries;
+	SpinLockRelease(&victimQueue->victimQueue_spinlock);
+
+	pg_atomic_write_u32(&victimQueue->refill_requested, 0);
+
+	pfree(picked);
+}
+
+// CS3223: See StrategySyncVictims in freelist_lru.c. The order is B1 tails, then B2 in victim order.
+int StrategySyncVictims(int* buf_ids, int max_buffers) {
+	victim_entry* victims;
+	int num_victims;
+
+	if (max_buffers <= 0) {
+		return 0;
+	}
+
+	victims = palloc(mul_size(sizeof(victim_entry), max_buffers));
+	num_victims = collect_victims(victims, max_buffers, false, pg_atomic_read_u32(&StrategyControl->nextVictimPartition) % numPartitions);
+
+	for (int i = 0; i < num_victims; i++) {
+		buf_ids[i] = victims[i].buf_id;
+	}
+
+	pfree(victims);
+	return num_victims;
+}
+
+// CS3223: Victim search statistics for elru_dirty_lookahead, see StrategyDirtyLookaheadStats in freelist_lru.c
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions) {
+	*clean_substitutions = pg_atomic_read_u64(&StrategyControl->cleanSubstitutions);
+	*dirty_evictions = pg_atomic_read_u64(&StrategyControl->dirtyEvictions);
+}
+
+// CS3223: Ring reuse against main pool evictions, see StrategyRingStats in freelist_lru.c
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions) {
+	*ring_reuses = pg_atomic_read_u64(&StrategyControl->ringReuses);
+	*ring_evictions = pg_atomic_read_u64(&StrategyControl->ringEvictions);
+	*pool_evictions = pg_atomic_read_u64(&StrategyControl->poolEvictions);
+}
+
+// CS3223: Admission filter decisions for elru_admission_filter, see StrategyAdmissionStats in freelist_lru.c
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections) {
+	*admissions = pg_atomic_read_u64(&admissionSketch->admissions);
+	*rejections = pg_atomic_read_u64(&admissionSketch->rejections);
+}
+
+// CS3223: References dropped as correlated, for debugging and for customTests/harness
+void StrategyCorrelationStats(uint64* correlated_references) {
+	*correlated_references = pg_atomic_read_u64(&StrategyControl->correlatedReferences);
+}
+
 /*
  * StrategyNotifyBgWriter -- set or clear allocation notification latch
  *
@@ -1266,6 +2660,13 @@ StrategyNotifyBgWriter(int bgwprocno)
 	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
 	StrategyControl->bgwprocno = bgwprocno;
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+	/*
+	 * CS3223: Unlike bgwprocno, which is cleared once used, the victim queue
+	 * keeps the bgwriter so that it can wake it whenever the queue runs low.
+	 */
+	if (bgwprocno != -1)
+		victimQueue->bgwprocno = bgwprocno;
 }
 
 
@@ -1288,21 +2689,36 @@ StrategyShmemSize(void)
 	/* size of the shared replacement strategy control block */
 	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
 
-	// CS3223: Allocate size for our data structures in FREE-LIST
-	size = add_size(size, sizeof(node) * (NBuffers + NUM_BUFFER_PARTITIONS + ADDITIONAL_BUFFER));
+	// CS3223: Allocate size for our node pool, one node per buffer shared by B1 and B2
+	size = add_size(size, mul_size(sizeof(node), NBuffers));
 
-	//Size of the control information of double link list
-	size = add_size(size, sizeof(info));
+	// CS3223: Last and K-th last access of every buffer
+	size = add_size(size, mul_size(sizeof(frame_stamps), NBuffers));
 
-	// CS3223: Allocate size for our data structures in B2
-	size = add_size(size, sizeof(node) * (NBuffers + NUM_BUFFER_PARTITIONS + ADDITIONAL_BUFFER));
+	// CS3223: Size of the control information (B1, B2, B2 timing wheel) of every partition
+	size = add_size(size, mul_size(sizeof(partition_info), elru_partition_count()));
 
-	//Size of the control information of B2 double link list
-	size = add_size(size, sizeof(info));
+	// CS3223: Allocate size for the B2 heaps, the partitions' heaps together hold at most one slot per buffer
+	size = add_size(size, mul_size(sizeof(int), NBuffers));
 
 	//Size of the counter info;
 	size = add_size(size, sizeof(counter_info));
 
+	// CS3223: Victim queue
+	size = add_size(size, victim_queue_shmem_size(elru_victim_queue_capacity()));
+
+	// CS3223: Admission sketch
+	size = add_size(size, admission_sketch_shmem_size(admission_sketch_width()));
+
+	// CS3223: Stamps between the last and the K-th last access of every buffer, none for K = 2
+	size = add_size(size, mul_size(sizeof(uint32), mul_size(NBuffers, elru_history_depth() - 2)));
+
+	// CS3223: Retained history, its slots, hash buckets and stamps
+	size = add_size(size, sizeof(history_table));
+	size = add_size(size, mul_size(sizeof(history_entry), elru_history_capacity()));
+	size = add_size(size, mul_size(sizeof(int32), history_num_buckets(elru_history_capacity())));
+	size = add_size(size, mul_size(sizeof(uint64_t), mul_size(elru_history_capacity(), elru_history_depth())));
+
 	return size;
 }
 
@@ -1320,12 +2736,19 @@ StrategyInitialize(bool init)
 
 	// CS3223: Boolean values for if shared memory alloc is successful
 	bool is_dll_success = false;
-	bool is_link_list_info_success = false;
-
-	bool is_other_dll_success = false;
-	bool is_other_link_list_info_success = false;
+	bool is_partition_info_success = false;
 
 	bool is_counter_info_success = false;
+	bool is_b2_heap_success = false;
+	bool is_victim_queue_success = false;
+	bool is_sketch_success = false;
+	bool is_frame_stamps_success = false;
+	bool is_middle_stamps_success = false;
+	bool is_history_table_success = false;
+	bool is_history_entries_success = false;
+	bool is_history_buckets_success = false;
+	bool is_history_stamps_success = false;
+	int history_capacity = elru_history_capacity();
 
 	/*
 	 * Initialize the shared buffer lookup hashtable.
@@ -1349,31 +2772,65 @@ StrategyInitialize(bool init)
 
 
 	// CS3223: Initialize space for our data structures
-	// Linked List Info
-	linkedListInfo = (info *)ShmemInitStruct("Link List Info",
-												sizeof(info),
-												&is_link_list_info_success);
+	// elru_num_partitions is PGC_POSTMASTER, so every backend arrives at the same partition count
+	numPartitions = elru_partition_count();
+
+	// Partition Info (B1, B2 and B2 timing wheel of every partition)
+	partitionInfo = (partition_info *)ShmemInitStruct("Partition Info",
+												mul_size(sizeof(partition_info), numPartitions),
+												&is_partition_info_success);
 
-	// Double Linked List itself
+	// Node pool for both B1 and B2, one node per buffer
 	doubleLinkedList = (node *)ShmemInitStruct("Double Link List",
-														sizeof(node) * (NBuffers + NUM_BUFFER_PARTITIONS + ADDITIONAL_BUFFER),
+														mul_size(sizeof(node), NBuffers),
 														&is_dll_success);
-	
-	// Intialization for B2
-	otherLinkedListInfo = (info *)ShmemInitStruct("Other Link List Info",
-												sizeof(info),
-												&is_other_link_list_info_success);
 
-	// Double Linked List itself
-	otherDoubleLinkedList = (node *)ShmemInitStruct("Other Double Link List",
-														sizeof(node) * (NBuffers + NUM_BUFFER_PARTITIONS + ADDITIONAL_BUFFER),
-														&is_other_dll_success);
+	// Last and K-th last access of every buffer
+	frameStamps = (frame_stamps *)ShmemInitStruct("Frame Stamps",
+														mul_size(sizeof(frame_stamps), NBuffers),
+														&is_frame_stamps_success);
+
+	// B2 heaps, one slot per buffer
+	b2Heap = (int *)ShmemInitStruct("B2 Heap",
+										mul_size(sizeof(int), NBuffers),
+										&is_b2_heap_success);
 
 	// Counter Info
 	counterInfo = (counter_info *)ShmemInitStruct("Counter Info",
 												sizeof(counter_info),
 												&is_counter_info_success);													
 
+	// Victim queue, elru_victim_queue_size is PGC_POSTMASTER as well
+	victimQueue = (victim_queue *)ShmemInitStruct("Victim Queue",
+												victim_queue_shmem_size(elru_victim_queue_capacity()),
+												&is_victim_queue_success);
+
+	// Admission sketch, elru_admission_filter is PGC_POSTMASTER too
+	admissionFilter = elru_admission_filter;
+	admissionSketch = (admission_sketch *)ShmemInitStruct("Admission Sketch",
+												admission_sketch_shmem_size(admission_sketch_width()),
+												&is_sketch_success);
+
+	// Stamps between the last and the K-th last access, elru_k is PGC_POSTMASTER as well
+	historyDepth = elru_history_depth();
+	middleStamps = (uint32 *)ShmemInitStruct("Middle Stamps",
+												mul_size(sizeof(uint32), mul_size(NBuffers, historyDepth - 2)),
+												&is_middle_stamps_success);
+
+	// Retained history, elru_history_percent is PGC_POSTMASTER too
+	historyTable = (history_table *)ShmemInitStruct("History Table",
+												sizeof(history_table),
+												&is_history_table_success);
+	historyEntries = (history_entry *)ShmemInitStruct("History Entries",
+												mul_size(sizeof(history_entry), history_capacity),
+												&is_history_entries_success);
+	historyBuckets = (int32 *)ShmemInitStruct("History Buckets",
+												mul_size(sizeof(int32), history_num_buckets(history_capacity)),
+												&is_history_buckets_success);
+	historyStamps = (uint64_t *)ShmemInitStruct("History Stamps",
+												mul_size(sizeof(uint64_t), mul_size(history_capacity, historyDepth)),
+												&is_history_stamps_success);
+
 	if (!found)
 	{
 		/*
@@ -1399,64 +2856,145 @@ StrategyInitialize(bool init)
 
 		/* No pending notification */
 		StrategyControl->bgwprocno = -1;
+
+		/* CS3223: Victim search starts at the first list partition */
+		pg_atomic_init_u32(&StrategyControl->nextVictimPartition, 0);
+
+		/* CS3223: Clear victim search statistics */
+		pg_atomic_init_u64(&StrategyControl->cleanSubstitutions, 0);
+		pg_atomic_init_u64(&StrategyControl->dirtyEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->ringReuses, 0);
+		pg_atomic_init_u64(&StrategyControl->ringEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->poolEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->correlatedReferences, 0);
+
+		/* CS3223: One tranche shared by all B1 and B2 partition locks and history_lock */
+		StrategyControl->listLockTrancheId = LWLockNewTrancheId();
 	}
 	else
 		Assert(!init);
 
+	// CS3223: Tranche names are backend-local, so every backend registers it
+	LWLockRegisterTranche(StrategyControl->listLockTrancheId, "ELRUList");
+
 	// CS3223: Intialize our DLL Data Structure
-	if (!is_dll_success && !is_link_list_info_success) { //Initiate our Double Link List Data Structure here
+	if (!is_dll_success) { //Initiate our Double Link List Data Structure here
 		Assert (init);
-		SpinLockInit(&linkedListInfo->linkedListInfo_spinlock);
-
-		linkedListInfo->tail = NULL;
-		linkedListInfo->size = 0;
-		linkedListInfo->head = doubleLinkedList;
-		//log what is MBiffers and what is NUM_BUFFER_PARTITIONS
-		//elog(LOG, "NBuffers: %d and NUM_BUFFER_PARTITIONS: %d", NBuffers, NUM_BUFFER_PARTITIONS);
-
-		// We used NBuffers + NUM_BUFFER_PARTITIONS in the original size of the doubleLinkedList
-		for (int i = 0; i < (NBuffers + NUM_BUFFER_PARTITIONS + ADDITIONAL_BUFFER); i++) {
-			doubleLinkedList[i].prev = NULL;
-			doubleLinkedList[i].next = NULL;
-			doubleLinkedList[i].frame_id = -1;
-			doubleLinkedList[i].time_array[0] = 0;
-			doubleLinkedList[i].time_array[1] = 0;
-			doubleLinkedList[i].sanity_check = 12345;
-    	}
-
-		//Check freshly initialized linked list linkedListInfo->head frame id
-		//elog(LOG, "freshly initialized linkedListInfo->head frame id: %d", linkedListInfo->head->frame_id);
-		//compare with doubleLinkedList[0] head frame id
-		//elog(LOG, "doubleLinkedList[0] head frame id: %d", doubleLinkedList[0].frame_id);
+
+		// An all-zero node is a valid unlinked node: list is LIST_NONE, and prev/next/heap_index are only read
+		// while the node is linked into B1 or B2
+		memset(doubleLinkedList, 0, mul_size(sizeof(node), NBuffers));
 
 	} else
 		Assert(!init);
 
-	// CS3223: Intialize our OTHER DLL Data Structure
-	if (!is_other_dll_success && !is_other_link_list_info_success) { //Initiate our Double Link List Data Structure here for B2
+	// CS3223: Intialize every partition (its nodes live in doubleLinkedList), latching elru_b2_bucket_width
+	// for the lifetime of the server
+	if (!is_partition_info_success) {
 		Assert (init);
-		SpinLockInit(&otherLinkedListInfo->linkedListInfo_spinlock);
-
-		otherLinkedListInfo->tail = NULL;
-		otherLinkedListInfo->size = 0;
-		otherLinkedListInfo->head = otherDoubleLinkedList;
-		for (int i = 0; i < (NBuffers + NUM_BUFFER_PARTITIONS + ADDITIONAL_BUFFER); i++) {
-			otherDoubleLinkedList[i].prev = NULL;
-			otherDoubleLinkedList[i].next = NULL;
-			otherDoubleLinkedList[i].frame_id = -1;
-			otherDoubleLinkedList[i].time_array[0] = 0;
-			otherDoubleLinkedList[i].time_array[1] = 0;
-			otherDoubleLinkedList[i].sanity_check = 42069;
+		for (int p = 0; p < numPartitions; p++) {
+			partition_info* part = &partitionInfo[p];
+
+			LWLockInitialize(&part->b1.linkedListInfo_lock, StrategyControl->listLockTrancheId);
+			part->b1.head = NIL_FRAME;
+			part->b1.tail = NIL_FRAME;
+			part->b1.size = 0;
+
+			LWLockInitialize(&part->b2.linkedListInfo_lock, StrategyControl->listLockTrancheId);
+			part->b2.head = NIL_FRAME;
+			part->b2.tail = NIL_FRAME;
+			part->b2.size = 0;
+
+			// Partition p holds buf_ids p, p + numPartitions, ..., so the first NBuffers % numPartitions
+			// partitions have one frame more than the rest; their heaps are laid out back to back
+			part->heap_base = p * (NBuffers / numPartitions) + Min(p, NBuffers % numPartitions);
+			part->epoch = 0;
+
+			part->wheel.width = Min(Max(elru_b2_bucket_width, 0), ELRU_MAX_BUCKET_WIDTH);
+			part->wheel.base_epoch = 0;
+			for (int i = 0; i < ELRU_B2_NUM_BUCKETS; i++) {
+				part->wheel.buckets[i].head = NIL_FRAME;
+				part->wheel.buckets[i].tail = NIL_FRAME;
+				part->wheel.buckets[i].size = 0;
+			}
 		}
-
 	} else
 		Assert(!init);
+
+	// CS3223: The B2 heaps need no initialization, entries past part->b2.size are never read
+	if (!is_b2_heap_success)
+		Assert(init);
+	else
+		Assert(!init);
 	
 	// CS3223: Intialize our Counter Info Data Structure
 	if (!is_counter_info_success) { //Initiate our Counter Info Data Structure here
 		Assert (init);
-		SpinLockInit(&counterInfo->counter_spinlock);
-		counterInfo->counter = 0;
+		pg_atomic_init_u64(&counterInfo->counter, 0);
+	} else
+		Assert(!init);
+
+	// CS3223: The victim queue starts empty, the bgwriter fills it on its first round
+	if (!is_victim_queue_success) {
+		Assert (init);
+		SpinLockInit(&victimQueue->victimQueue_spinlock);
+		victimQueue->head = 0;
+		victimQueue->count = 0;
+		victimQueue->capacity = elru_victim_queue_capacity();
+		victimQueue->bgwprocno = -1;
+		pg_atomic_init_u32(&victimQueue->refill_requested, 0);
+	} else
+		Assert(!init);
+
+	// CS3223: The admission sketch starts out knowing no page
+	if (!is_sketch_success) {
+		uint32 width = admission_sketch_width();
+		Size num_words = (admission_sketch_shmem_size(width) - offsetof(admission_sketch, words)) / sizeof(pg_atomic_uint64);
+
+		Assert (init);
+		admissionSketch->width = width;
+		admissionSketch->sample_size = width * SKETCH_SAMPLE_FACTOR;
+		pg_atomic_init_u32(&admissionSketch->samples, 0);
+		pg_atomic_init_u64(&admissionSketch->admissions, 0);
+		pg_atomic_init_u64(&admissionSketch->rejections, 0);
+		for (Size i = 0; i < num_words; i++) {
+			pg_atomic_init_u64(&admissionSketch->words[i], 0);
+		}
+	} else
+		Assert(!init);
+
+	// CS3223: No frame has been accessed yet
+	if (!is_frame_stamps_success) {
+		Assert (init);
+		memset(frameStamps, 0, mul_size(sizeof(frame_stamps), NBuffers));
+	} else
+		Assert(!init);
+
+	// CS3223: Nor in the stamps in between
+	if (!is_middle_stamps_success) {
+		Assert (init);
+		memset(middleStamps, 0, mul_size(sizeof(uint32), mul_size(NBuffers, historyDepth - 2)));
+	} else
+		Assert(!init);
+
+	// CS3223: The retained history starts empty. Stamps of a slot are only read while it is valid.
+	if (!is_history_table_success && !is_history_entries_success && !is_history_buckets_success
+		&& !is_history_stamps_success) {
+		uint32 num_buckets = history_num_buckets(history_capacity);
+
+		Assert (init);
+		LWLockInitialize(&historyTable->history_lock, StrategyControl->listLockTrancheId);
+		historyTable->capacity = history_capacity;
+		historyTable->next = 0;
+		historyTable->num_buckets = num_buckets;
+
+		for (int i = 0; i < history_capacity; i++) {
+			historyEntries[i].valid = false;
+			historyEntries[i].hash_next = NIL_FRAME;
+		}
+		for (uint32 b = 0; b < num_buckets; b++) {
+			historyBuckets[b] = NIL_FRAME;
+		}
 	} else
 		Assert(!init);
 }
@@ -1706,5 +3244,8 @@ StrategyRejectBuffer(BufferAccessStrategy strategy, BufferDesc *buf, bool from_r
 	 */
 	strategy->buffers[strategy->current] = InvalidBuffer;
 
+	/* CS3223: It stays at the tail of B1, but is no longer the ring's */
+	release_ring_frame(buf->buf_id);
+
 	return true;
 }
@@ -0,0 +1,1481 @@
+/*-------------------------------------------------------------------------
+ *
+ * freelist.c
+ *	  routines for managing the buffer pool's replacement strategy.
+ *
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/freelist.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "port/pg_bitutils.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/proc.h"
+
+#include <assert.h>
+
+#define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
+
+/*********************************************/
+// CS3223 - Data Structure declarations
+
+// LIRS (Jiang & Zhang) ranks pages by inter-reference recency (IRR), the number of other pages referenced between
+// their last two references, rather than by recency alone. Most of the pool holds LIR pages (low IRR); the rest, HIR
+// pages (high IRR), are the only victims. Two lists:
+//   S - recency stack of LIR pages, resident HIR pages and non-resident HIR pages (ghosts, the tag of an evicted page),
+//       pruned so that its bottom is always the least recently used LIR page
+//   Q - resident HIR pages, the next victim at its tail
+// A HIR page referenced while it is still in S was referenced again more recently than the bottom LIR page, so it has
+// the lower IRR: it becomes LIR and the bottom LIR page becomes HIR (the head of Q). A loop over more pages than the
+// pool keeps its LIR pages resident, instead of missing on every one of them as LRU does.
+//
+// Pruning pops HIR entries off the bottom of S until a LIR page is there, and every entry is popped at most once after
+// it is pushed, so pruning is amortized O(1). Ghosts are kept to lirs_nonresident_percent of NBuffers; past that, the
+// oldest ghost is dropped.
+//
+// StrategyGetBuffer does not know which page the victim will hold, so a newly loaded page enters as HIR (a fresh
+// frame), and the ghost of its tag is only looked for on its first hit or when it comes up for eviction, whichever is
+// first. A fresh page that had a ghost in S is promoted to LIR then, rather than evicted.
+
+// Status of every entry, so an entry can be found by id in O(1)
+#define LIRS_NONE 0                    // Unused frame, or free ghost slot
+#define LIRS_LIR 1
+#define LIRS_HIR 2                     // Resident HIR frame, in Q
+#define LIRS_GHOST 3                   // Non-resident HIR entry, in S
+
+// Entries are linked by id (32 bits) instead of by pointer. Ids 0 to NBuffers - 1 are frames (the buf_id), the rest
+// ghost slots. NIL_FRAME ends every list.
+#define NIL_FRAME (-1)
+#define IS_GHOST(id) ((id) >= NBuffers)
+#define GHOST_SLOT(id) ((id) - NBuffers)
+
+typedef struct node {
+	int32 s_prev;                      // Id of the entry above in S (more recent), or NIL_FRAME
+	int32 s_next;                      // Id of the entry below in S (less recent), or NIL_FRAME
+	int32 q_prev;                      // Frames: towards the head of Q. Ghosts: towards the newest ghost.
+	int32 q_next;                      // Frames: towards the tail of Q. Ghosts: towards the oldest ghost, or the next
+	                                   // free slot
+	uint8 status;                      // LIRS_NONE, LIRS_LIR, LIRS_HIR or LIRS_GHOST
+	bool in_s;
+	bool fresh;                        // Resident HIR and not referenced since its page was loaded
+} node;
+
+typedef struct info {
+	int32 head;                        // Id of the head entry, or NIL_FRAME
+	int32 tail;                        // Id of the tail entry, or NIL_FRAME
+	int size;
+} info;
+
+// Tag of a ghost, chained by hash so that a lookup is O(1)
+typedef struct ghost_entry {
+	BufferTag tag;
+	int32 hash_next;                   // Id of the next ghost in the same hash bucket, or NIL_FRAME
+} ghost_entry;
+
+typedef struct lirs_info {
+	info s;                            // Head is the top (most recent), tail the bottom (always LIR once pruned)
+	info q;                            // Head is the most recently demoted or loaded HIR frame
+	info ghost_age;                    // Ghosts, newest at the head
+	int32 free_ghost;                  // Head of the free ghost slot list
+	int lir_size;                      // LIR frames
+	int lir_target;                    // Llirs: LIR frames there may be, NBuffers less the HIR share
+	int num_ghosts;                    // Ghost slots, 0 if non-resident entries are off
+	uint32 num_buckets;                // Power of two, at least num_ghosts
+	LWLock lirs_lock;                  // Exclusive to change S, Q or the ghosts, shared to walk them
+} lirs_info;
+
+static node* lirsNodes = NULL;                // NBuffers frame entries, then num_ghosts ghost entries
+static lirs_info* lirs = NULL;
+static ghost_entry* ghosts = NULL;            // Indexed by GHOST_SLOT
+static int32* ghostBuckets = NULL;            // num_buckets heads of ghost chains
+
+// CS3223: The GUCs below are defined in bufmgr.c, see the GUCs in freelist_lru.c
+
+// CS3223 - GUC (PGC_POSTMASTER): percentage of NBuffers kept for resident HIR pages (Lhirs). The LIRS paper uses 1.
+extern PGDLLIMPORT int lirs_hir_percent;
+
+// CS3223 - GUC (PGC_POSTMASTER): number of non-resident HIR entries S may hold, as a percentage of NBuffers. 0 keeps
+// none, and then only a page referenced again while still resident can become LIR.
+extern PGDLLIMPORT int lirs_nonresident_percent;
+
+int lirs_lir_target(void);
+int lirs_num_ghosts(void);
+uint32 lirs_num_buckets(int num_ghosts);
+void s_unlink(int32 id);
+void s_push(int32 id);
+void q_unlink(int32 id);
+void q_push(int32 id);
+void prune_stack(void);
+void demote_bottom_lir(void);
+void promote_hir(int32 id);
+void place_new_frame(int32 id);
+void remove_frame(int32 id);
+uint32 ghost_bucket_of(const BufferTag* tag);
+int32 ghost_lookup(const BufferTag* tag);
+void ghost_free(int32 id);
+void ghost_replace(int32 id, const BufferTag* tag);
+bool resolve_ghost(int32 id, const BufferTag* tag);
+bool claim_victim(int32 frame_id, uint32* buf_state);
+int sync_victims_from(info* list_info, int32* frame_id, bool along_s, int* buf_ids, int num_buffers, int max_buffers);
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions);
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions);
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections);
+
+/*********************************************/
+// CS3223 - Function definitions
+
+// Llirs, NBuffers less lirs_hir_percent of NBuffers. At least one frame is left for HIR pages, and at least one LIR.
+int lirs_lir_target(void) {
+	int hir_size = Max((int) ((int64) NBuffers * Min(Max(lirs_hir_percent, 0), 100) / 100), 1);
+
+	return Max(NBuffers - hir_size, 1);
+}
+
+// Ghost slots, lirs_nonresident_percent of NBuffers, up to 4 times NBuffers
+int lirs_num_ghosts(void) {
+	return (int) ((int64) NBuffers * Min(Max(lirs_nonresident_percent, 0), 400) / 100);
+}
+
+uint32 lirs_num_buckets(int num_ghosts) {
+	return pg_nextpower2_32((uint32) Max(num_ghosts, 1));
+}
+
+// S and Q - Function definitions. All of them are called with lirs_lock held exclusively.
+
+void s_unlink(int32 id) {
+	node* entry = &lirsNodes[id];
+
+	if (entry->s_prev != NIL_FRAME) {
+		lirsNodes[entry->s_prev].s_next = entry->s_next;
+	} else {
+		lirs->s.head = entry->s_next;
+	}
+
+	if (entry->s_next != NIL_FRAME) {
+		lirsNodes[entry->s_next].s_prev = entry->s_prev;
+	} else {
+		lirs->s.tail = entry->s_prev;
+	}
+
+	entry->s_prev = NIL_FRAME;
+	entry->s_next = NIL_FRAME;
+	entry->in_s = false;
+	lirs->s.size--;
+}
+
+// Push an entry (which must not be in S) on top of S
+void s_push(int32 id) {
+	node* entry = &lirsNodes[id];
+
+	Assert(!entry->in_s);
+
+	entry->s_prev = NIL_FRAME;
+	entry->s_next = lirs->s.head;
+	if (lirs->s.head != NIL_FRAME) { // Check if list is not empty
+		lirsNodes[lirs->s.head].s_prev = id;
+	}
+	lirs->s.head = id;
+
+	if (lirs->s.tail == NIL_FRAME) { // If list was empty, update tail as well
+		lirs->s.tail = id;
+	}
+
+	entry->in_s = true;
+	lirs->s.size++;
+}
+
+// Unlink a frame from Q, or a ghost from the ghost age list
+void q_unlink(int32 id) {
+	node* entry = &lirsNodes[id];
+	info* list_info = IS_GHOST(id) ? &lirs->ghost_age : &lirs->q;
+
+	if (entry->q_prev != NIL_FRAME) {
+		lirsNodes[entry->q_prev].q_next = entry->q_next;
+	} else {
+		list_info->head = entry->q_next;
+	}
+
+	if (entry->q_next != NIL_FRAME) {
+		lirsNodes[entry->q_next].q_prev = entry->q_prev;
+	} else {
+		list_info->tail = entry->q_prev;
+	}
+
+	entry->q_prev = NIL_FRAME;
+	entry->q_next = NIL_FRAME;
+	list_info->size--;
+}
+
+// Link a frame at the head of Q, or a ghost at the head of the ghost age list
+void q_push(int32 id) {
+	node* entry = &lirsNodes[id];
+	info* list_info = IS_GHOST(id) ? &lirs->ghost_age : &lirs->q;
+
+	entry->q_prev = NIL_FRAME;
+	entry->q_next = list_info->head;
+	if (list_info->head != NIL_FRAME) {
+		lirsNodes[list_info->head].q_prev = id;
+	}
+	list_info->head = id;
+
+	if (list_info->tail == NIL_FRAME) {
+		list_info->tail = id;
+	}
+
+	list_info->size++;
+}
+
+// Pop HIR entries off the bottom of S until a LIR frame is there. Resident HIR frames stay in Q, ghosts are freed.
+void prune_stack(void) {
+	int32 id;
+
+	while (lirs->s.tail != NIL_FRAME && lirsNodes[lirs->s.tail].status != LIRS_LIR) {
+		id = lirs->s.tail;
+		if (lirsNodes[id].status == LIRS_GHOST) {
+			ghost_free(id);
+		} else {
+			s_unlink(id);
+		}
+	}
+}
+
+// The LIR frame at the bottom of S becomes HIR, at the head of Q
+void demote_bottom_lir(void) {
+	int32 id = lirs->s.tail;
+
+	Assert(id != NIL_FRAME && lirsNodes[id].status == LIRS_LIR);
+
+	s_unlink(id);
+	lirsNodes[id].status = LIRS_HIR;
+	lirs->lir_size--;
+	q_push(id);
+	prune_stack();
+}
+
+// A resident HIR frame has the lower IRR: it becomes LIR on top of S, and a LIR frame makes room for it if need be
+void promote_hir(int32 id) {
+	node* frame = &lirsNodes[id];
+
+	Assert(frame->status == LIRS_HIR);
+
+	q_unlink(id);
+	if (frame->in_s) {
+		s_unlink(id);
+	}
+	frame->status = LIRS_LIR;
+	frame->fresh = false;
+	lirs->lir_size++;
+	s_push(id);
+
+	if (lirs->lir_size > lirs->lir_target) {
+		demote_bottom_lir();
+	}
+}
+
+// A frame (in neither S nor Q) is about to hold a newly loaded page. Until there are Llirs LIR frames, the page is LIR;
+// after that, it is a fresh HIR page on top of S and at the head of Q.
+void place_new_frame(int32 id) {
+	node* frame = &lirsNodes[id];
+
+	Assert(frame->status == LIRS_NONE && !frame->in_s);
+
+	if (lirs->lir_size < lirs->lir_target) {
+		frame->status = LIRS_LIR;
+		lirs->lir_size++;
+		s_push(id);
+	} else {
+		frame->status = LIRS_HIR;
+		frame->fresh = true;
+		s_push(id);
+		q_push(id);
+	}
+}
+
+// Take a frame out of S and Q. Its page leaves no ghost.
+void remove_frame(int32 id) {
+	node* frame = &lirsNodes[id];
+
+	if (frame->status == LIRS_HIR) {
+		q_unlink(id);
+	} else if (frame->status == LIRS_LIR) {
+		lirs->lir_size--;
+	}
+
+	if (frame->in_s) {
+		s_unlink(id);
+	}
+
+	frame->status = LIRS_NONE;
+	frame->fresh = false;
+	prune_stack();
+}
+
+// Ghosts - Function definitions. All of them are called with lirs_lock held exclusively.
+
+uint32 ghost_bucket_of(const BufferTag* tag) {
+	return BufTableHashCode((BufferTag*) tag) & (lirs->num_buckets - 1);
+}
+
+// Returns the id of the ghost of 'tag', or NIL_FRAME
+int32 ghost_lookup(const BufferTag* tag) {
+	if (lirs->num_ghosts == 0) {
+		return NIL_FRAME;
+	}
+
+	for (int32 id = ghostBuckets[ghost_bucket_of(tag)]; id != NIL_FRAME; id = ghosts[GHOST_SLOT(id)].hash_next) {
+		if (BufferTagsEqual(&ghosts[GHOST_SLOT(id)].tag, tag)) {
+			return id;
+		}
+	}
+
+	return NIL_FRAME;
+}
+
+// Take a ghost out of S, its hash chain and the ghost age list, and put its slot on the free list. Chains are about
+// one ghost long, as there are at least as many buckets as slots.
+void ghost_free(int32 id) {
+	node* entry = &lirsNodes[id];
+	int32* link = &ghostBuckets[ghost_bucket_of(&ghosts[GHOST_SLOT(id)].tag)];
+
+	Assert(entry->status == LIRS_GHOST);
+
+	while (*link != id) {
+		Assert(*link != NIL_FRAME);
+		link = &ghosts[GHOST_SLOT(*link)].hash_next;
+	}
+	*link = ghosts[GHOST_SLOT(id)].hash_next;
+
+	s_unlink(id);
+	q_unlink(id);
+
+	entry->status = LIRS_NONE;
+	entry->q_next = lirs->free_ghost;
+	lirs->free_ghost = id;
+}
+
+// The HIR frame 'id', which is in S, is being evicted: a ghost with its page's tag takes its place in S. The page may
+// already have a ghost, if it was loaded again straight into a LIR frame; that ghost is dropped in favour of the new
+// one. If every slot is taken, the oldest ghost makes room.
+void ghost_replace(int32 id, const BufferTag* tag) {
+	node* frame = &lirsNodes[id];
+	int32 ghost_id;
+	node* ghost;
+	uint32 bucket;
+
+	Assert(frame->in_s && frame->status == LIRS_HIR);
+
+	if (lirs->num_ghosts == 0) {
+		s_unlink(id);
+		return;
+	}
+
+	ghost_id = ghost_lookup(tag);
+	if (ghost_id != NIL_FRAME) {
+		ghost_free(ghost_id);
+	}
+
+	if (lirs->free_ghost == NIL_FRAME) {
+		ghost_free(lirs->ghost_age.tail);
+	}
+
+	ghost_id = lirs->free_ghost;
+	ghost = &lirsNodes[ghost_id];
+	lirs->free_ghost = ghost->q_next;
+
+	// Take the frame's place in S
+	ghost->s_prev = frame->s_prev;
+	ghost->s_next = frame->s_next;
+	if (ghost->s_prev != NIL_FRAME) {
+		lirsNodes[ghost->s_prev].s_next = ghost_id;
+	} else {
+		lirs->s.head = ghost_id;
+	}
+	if (ghost->s_next != NIL_FRAME) {
+		lirsNodes[ghost->s_next].s_prev = ghost_id;
+	} else {
+		lirs->s.tail = ghost_id;
+	}
+	ghost->in_s = true;
+	frame->s_prev = NIL_FRAME;
+	frame->s_next = NIL_FRAME;
+	frame->in_s = false;
+
+	ghost->status = LIRS_GHOST;
+	q_push(ghost_id);
+
+	bucket = ghost_bucket_of(tag);
+	ghosts[GHOST_SLOT(ghost_id)].tag = *tag;
+	ghosts[GHOST_SLOT(ghost_id)].hash_next = ghostBuckets[bucket];
+	ghostBuckets[bucket] = ghost_id;
+}
+
+// Called for a fresh frame, on its first hit or when it comes up for eviction, with its page's tag stable. The page
+// is no longer fresh. If it had a ghost in S, the ghost is freed and true is returned: the page was referenced again
+// while its entry was still in S.
+bool resolve_ghost(int32 id, const BufferTag* tag) {
+	int32 ghost_id = ghost_lookup(tag);
+
+	lirsNodes[id].fresh = false;
+
+	if (ghost_id == NIL_FRAME) {
+		return false;
+	}
+
+	ghost_free(ghost_id);
+	return true;
+}
+
+// Try to evict 'frame_id', from the tail end of Q or (if no HIR frame can go) the bottom of S. Called with lirs_lock
+// held exclusively, which the caller keeps; the buffer header may be locked under it (an LWLock may be held across a
+// buffer header lock, never the other way round). The refcount is peeked at first, so a pinned frame costs no header
+// lock. A fresh HIR frame whose page had a ghost is promoted to LIR instead of being evicted, and false returned.
+// Otherwise, if the frame is unpinned, a HIR page in S leaves a ghost there (its tag read under the header lock, as
+// only that keeps it stable), the frame takes the newly loaded page (see place_new_frame), and true is returned with
+// the buffer header locked.
+bool claim_victim(int32 frame_id, uint32* buf_state) {
+	node* frame = &lirsNodes[frame_id];
+	BufferDesc* buf = GetBufferDescriptor(frame_id);
+	uint32 local_buf_state;
+
+	if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf->state)) != 0) {
+		return false;
+	}
+
+	local_buf_state = LockBufHdr(buf);
+
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0) {
+		UnlockBufHdr(buf, local_buf_state);
+		return false;
+	}
+
+	if (frame->fresh && (local_buf_state & BM_TAG_VALID) && resolve_ghost(frame_id, &buf->tag)) {
+		UnlockBufHdr(buf, local_buf_state);
+		promote_hir(frame_id);
+		return false;
+	}
+
+	if (frame->status == LIRS_HIR && frame->in_s && (local_buf_state & BM_TAG_VALID)) {
+		ghost_replace(frame_id, &buf->tag);
+	}
+	remove_frame(frame_id);
+	place_new_frame(frame_id);
+
+	*buf_state = local_buf_state;
+	return true;
+}
+
+// Called by StrategySyncVictims with lirs_lock held in shared mode. Walks Q (or, if 'along_s', the LIR frames of S)
+// from '*frame_id' towards the head and appends unpinned frames to 'buf_ids' until it holds 'max_buffers' of them.
+// '*frame_id' is left where the walk stopped, so that it can be resumed. Returns the new number of buffers in
+// 'buf_ids'.
+int sync_victims_from(info* list_info, int32* frame_id, bool along_s, int* buf_ids, int num_buffers, int max_buffers) {
+	while (*frame_id != NIL_FRAME && num_buffers < max_buffers) {
+		if (lirsNodes[*frame_id].status != LIRS_GHOST
+			&& (!along_s || lirsNodes[*frame_id].status == LIRS_LIR)
+			&& BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&GetBufferDescriptor(*frame_id)->state)) == 0) {
+			buf_ids[num_buffers++] = *frame_id;
+		}
+		*frame_id = along_s ? lirsNodes[*frame_id].s_prev : lirsNodes[*frame_id].q_prev;
+	}
+
+	return num_buffers;
+}
+
+/*********************************************/
+
+
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/* Spinlock: protects the values below */
+	slock_t		buffer_strategy_lock;
+
+	/*
+	 * Clock sweep hand: index of next buffer to consider grabbing. Note that
+	 * this isn't a concrete buffer - we only ever increase the value. So, to
+	 * get an actual buffer, it needs to be used modulo NBuffers.
+	 */
+	pg_atomic_uint32 nextVictimBuffer;
+
+	int			firstFreeBuffer;	/* Head of list of unused buffers */
+	int			lastFreeBuffer; /* Tail of list of unused buffers */
+
+	/*
+	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
+	 * when the list is empty)
+	 */
+
+	/*
+	 * Statistics.  These counters should be wide enough that they can't
+	 * overflow during a single bgwriter cycle.
+	 */
+	uint32		completePasses; /* Complete cycles of the clock sweep */
+	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
+
+	/*
+	 * Bgworker process to be notified upon activity or -1 if none. See
+	 * StrategyNotifyBgWriter.
+	 */
+	int			bgwprocno;
+
+	/*
+	 * CS3223: LWLock tranche of lirs_lock, so waits on it show up as
+	 * "LIRSList" in pg_stat_activity.
+	 */
+	int			listLockTrancheId;
+
+	/*
+	 * CS3223: Buffers recycled by BufferAccessStrategy rings, against
+	 * victims evicted from Q or S for a ring and for everybody else.
+	 * Freelist allocations are not counted.
+	 */
+	pg_atomic_uint64 ringReuses;
+	pg_atomic_uint64 ringEvictions;
+	pg_atomic_uint64 poolEvictions;
+} BufferStrategyControl;
+
+/* Pointers to shared state */
+static BufferStrategyControl *StrategyControl = NULL;
+
+/*
+ * Private (non-shared) state for managing a ring of shared buffers to re-use.
+ * This is currently the only kind of BufferAccessStrategy object, but someday
+ * we might have more kinds.
+ */
+typedef struct BufferAccessStrategyData
+{
+	/* Overall strategy type */
+	BufferAccessStrategyType btype;
+	/* Number of elements in buffers[] array */
+	int			nbuffers;
+
+	/*
+	 * Index of the "current" slot in the ring, ie, the one most recently
+	 * returned by GetBufferFromRing.
+	 */
+	int			current;
+
+	/*
+	 * Array of buffer numbers.  InvalidBuffer (that is, zero) indicates we
+	 * have not yet selected a buffer for this ring slot.  For allocation
+	 * simplicity this is palloc'd together with the fixed fields of the
+	 * struct.
+	 */
+	Buffer		buffers[FLEXIBLE_ARRAY_MEMBER];
+}			BufferAccessStrategyData;
+
+
+void StrategyAccessBuffer(int buf_id, bool delete); /* cs3223 */
+
+/* Prototypes for internal functions */
+static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
+									 uint32 *buf_state);
+static void AddBufferToRing(BufferAccessStrategy strategy,
+							BufferDesc *buf);
+
+/*
+ * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ *
+ * Move the clock hand one buffer ahead of its current position and return the
+ * id of the buffer now under the hand.
+ */
+static inline uint32
+ClockSweepTick(void)
+{
+	uint32		victim;
+
+	/*
+	 * Atomically move hand ahead one buffer - if there's several processes
+	 * doing this, this can lead to buffers being returned slightly out of
+	 * apparent order.
+	 */
+	victim =
+		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+
+	if (victim >= NBuffers)
+	{
+		uint32		originalVictim = victim;
+
+		/* always wrap what we look up in BufferDescriptors */
+		victim = victim % NBuffers;
+
+		/*
+		 * If we're the one that just caused a wraparound, force
+		 * completePasses to be incremented while holding the spinlock. We
+		 * need the spinlock so StrategySyncStart() can return a consistent
+		 * value consisting of nextVictimBuffer and completePasses.
+		 */
+		if (victim == 0)
+		{
+			uint32		expected;
+			uint32		wrapped;
+			bool		success = false;
+
+			expected = originalVictim + 1;
+
+			while (!success)
+			{
+				/*
+				 * Acquire the spinlock while increasing completePasses. That
+				 * allows other readers to read nextVictimBuffer and
+				 * completePasses in a consistent manner which is required for
+				 * StrategySyncStart().  In theory delaying the increment
+				 * could lead to an overflow of nextVictimBuffers, but that's
+				 * highly unlikely and wouldn't be particularly harmful.
+				 */
+				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+				wrapped = expected % NBuffers;
+
+				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+														 &expected, wrapped);
+				if (success)
+					StrategyControl->completePasses++;
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+			}
+		}
+	}
+	return victim;
+}
+
+/*
+ * have_free_buffer -- a lockless check to see if there is a free buffer in
+ *					   buffer pool.
+ *
+ * If the result is true that will become stale once free buffers are moved out
+ * by other operations, so the caller who strictly want to use a free buffer
+ * should not call this.
+ */
+bool
+have_free_buffer(void)
+{
+	if (StrategyControl->firstFreeBuffer >= 0)
+		return true;
+	else
+		return false;
+}
+
+
+
+// cs3223
+// StrategyAccessBuffer 
+// Called by bufmgr when a buffer page is accessed.
+// Applies the LIRS rules to buffer buf_id if delete is false; otherwise, removes buffer buf_id from S and Q.
+// Takes lirs_lock, so the caller must not hold a buffer header lock or any other spinlock.
+void
+StrategyAccessBuffer(int buf_id, bool delete)
+{
+	node* frame = &lirsNodes[buf_id];
+	bool was_bottom;
+
+	// CS3223: The LIR frame on top of S is where a hit would put it already. The unlocked look is only a hint: at
+	// worst a reference is lost, or the lock is taken for nothing.
+	if (!delete && frame->status == LIRS_LIR && INT_ACCESS_ONCE(lirs->s.head) == buf_id) {
+		return;
+	}
+
+	LWLockAcquire(&lirs->lirs_lock, LW_EXCLUSIVE);
+
+	if (delete) {
+		if (frame->status != LIRS_NONE) {
+			remove_frame(buf_id);
+		}
+	} else if (frame->status == LIRS_NONE) {
+		// Not in S or Q: a buffer just taken from the freelist
+		place_new_frame(buf_id);
+	} else if (frame->status == LIRS_LIR) {
+		// A LIR page goes back on top of S. If it was the bottom, HIR entries under the next LIR page are pruned.
+		was_bottom = (lirs->s.tail == buf_id);
+		s_unlink(buf_id);
+		s_push(buf_id);
+		if (was_bottom) {
+			prune_stack();
+		}
+	} else if ((frame->fresh && resolve_ghost(buf_id, &GetBufferDescriptor(buf_id)->tag)) || frame->in_s
+			   || lirs->lir_size < lirs->lir_target) {
+		// A HIR page referenced while it (or its ghost, for the first hit since it was loaded) was still in S
+		// becomes LIR, as does any HIR page while LIR frames are missing (some went to the freelist). The caller has
+		// the page pinned, so its tag is stable.
+		promote_hir(buf_id);
+	} else {
+		// Otherwise it stays HIR, back on top of S and at the head of Q
+		s_push(buf_id);
+		q_unlink(buf_id);
+		q_push(buf_id);
+	}
+
+	LWLockRelease(&lirs->lirs_lock);
+}
+
+// CS3223 - StrategyAccessPinnedBuffer
+// Called by bufmgr in place of StrategyAccessBuffer for a hit on a buffer the backend already has pinned.
+// LIRS treats it as any other hit.
+void
+StrategyAccessPinnedBuffer(int buf_id)
+{
+	StrategyAccessBuffer(buf_id, false);
+}
+
+/*
+ * StrategyGetBuffer
+ *
+ *	Called by the bufmgr to get the next candidate buffer to use in
+ *	BufferAlloc(). The only hard requirement BufferAlloc() has is that
+ *	the selected buffer must not currently be pinned by anyone.
+ *
+ *	strategy is a BufferAccessStrategy object, or NULL for default strategy.
+ *
+ *	To ensure that no one else can pin the buffer before we do, we must
+ *	return the buffer with the buffer header spinlock still held.
+ */
+BufferDesc *
+StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_ring)
+{
+	BufferDesc *buf;
+	int			bgwprocno;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+	// CS3223
+	int32 traversal_frame_id;
+	int32 next_frame_id;
+
+	*from_ring = false;
+
+	/*
+	 * If given a strategy object, see whether it can select a buffer. We
+	 * assume strategy objects don't need buffer_strategy_lock.
+	 */
+
+	// CS3223: A recycled ring buffer stays wherever it is, and its old page gets no ghost. The ring's pages are HIR
+	// (once the LIR frames are taken), and only become LIR if something else references them.
+	if (strategy != NULL)
+	{
+		buf = GetBufferFromRing(strategy, buf_state);
+		if (buf != NULL)
+		{
+			*from_ring = true;
+			pg_atomic_fetch_add_u64(&StrategyControl->ringReuses, 1);
+			return buf;
+		}
+	}
+
+	/*
+	 * If asked, we need to waken the bgwriter. Since we don't want to rely on
+	 * a spinlock for this we force a read from shared memory once, and then
+	 * set the latch based on that value. We need to go through that length
+	 * because otherwise bgwprocno might be reset while/after we check because
+	 * the compiler might just reread from memory.
+	 *
+	 * This can possibly set the latch of the wrong process if the bgwriter
+	 * dies in the wrong moment. But since PGPROC->procLatch is never
+	 * deallocated the worst consequence of that is that we set the latch of
+	 * some arbitrary process.
+	 */
+	bgwprocno = INT_ACCESS_ONCE(StrategyControl->bgwprocno);
+	if (bgwprocno != -1)
+	{
+		/* reset bgwprocno first, before setting the latch */
+		StrategyControl->bgwprocno = -1;
+
+		/*
+		 * Not acquiring ProcArrayLock here which is slightly icky. It's
+		 * actually fine because procLatch isn't ever freed, so we just can
+		 * potentially set the wrong process' (or no process') latch.
+		 */
+		SetLatch(&ProcGlobal->allProcs[bgwprocno].procLatch);
+	}
+
+	/*
+	 * We count buffer allocation requests so that the bgwriter can estimate
+	 * the rate of buffer consumption.  Note that buffers recycled by a
+	 * strategy object are intentionally not counted here.
+	 */
+	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
+
+	/*
+	 * First check, without acquiring the lock, whether there's buffers in the
+	 * freelist. Since we otherwise don't require the spinlock in every
+	 * StrategyGetBuffer() invocation, it'd be sad to acquire it here -
+	 * uselessly in most cases. That obviously leaves a race where a buffer is
+	 * put on the freelist but we don't see the store yet - but that's pretty
+	 * harmless, it'll just get used during the next buffer acquisition.
+	 *
+	 * If there's buffers on the freelist, acquire the spinlock to pop one
+	 * buffer of the freelist. Then check whether that buffer is usable and
+	 * repeat if not.
+	 *
+	 * Note that the freeNext fields are considered to be protected by the
+	 * buffer_strategy_lock not the individual buffer spinlocks, so it's OK to
+	 * manipulate them without holding the spinlock.
+	 */
+	if (StrategyControl->firstFreeBuffer >= 0)
+	{
+		while (true)
+		{
+			/* Acquire the spinlock to remove element from the freelist */
+			SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+			if (StrategyControl->firstFreeBuffer < 0)
+			{
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+				break;
+			}
+
+			buf = GetBufferDescriptor(StrategyControl->firstFreeBuffer);
+			Assert(buf->freeNext != FREENEXT_NOT_IN_LIST);
+
+			/* Unconditionally remove buffer from freelist */
+			StrategyControl->firstFreeBuffer = buf->freeNext;
+			buf->freeNext = FREENEXT_NOT_IN_LIST;
+
+			/*
+			 * Release the lock so someone else can access the freelist while
+			 * we check out this buffer.
+			 */
+			SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+			//CS3223: Add buffer to S (and Q). This has to happen before the buffer header is locked, as lirs_lock is
+			// an LWLock. If the buffer turns out to be unusable below, somebody is using it and it belongs in S
+			// anyway.
+			StrategyAccessBuffer(buf->buf_id, false);                      // Case 2
+
+			/*
+			 * If the buffer is pinned or has a nonzero usage_count, we cannot
+			 * use it; discard it and retry.  (This can only happen if VACUUM
+			 * put a valid buffer in the freelist and then someone else used
+			 * it before we got to it.  It's probably impossible altogether as
+			 * of 8.3, but we'd better check anyway.)
+			 */
+			local_buf_state = LockBufHdr(buf);
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+				&& BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
+			{
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				*buf_state = local_buf_state;
+				return buf;
+			}
+			UnlockBufHdr(buf, local_buf_state);
+		}
+	}
+
+	// CS3223: Counts evictions for the bgwriter's pacing, see StrategySyncStart
+	(void) ClockSweepTick();
+	pg_atomic_fetch_add_u64(strategy != NULL ? &StrategyControl->ringEvictions : &StrategyControl->poolEvictions, 1);
+
+	// Case 3
+	// CS3223: Evict the resident HIR frame at the tail of Q. Only if every frame in Q is pinned, evict the least
+	// recently used unpinned LIR frame instead. lirs_lock is held exclusively throughout, as the victim has to be
+	// relinked without letting go of its buffer header lock. The next frame is taken before each try, as a frame
+	// promoted by claim_victim leaves Q.
+	LWLockAcquire(&lirs->lirs_lock, LW_EXCLUSIVE);
+
+	for (traversal_frame_id = lirs->q.tail; traversal_frame_id != NIL_FRAME; traversal_frame_id = next_frame_id) {
+		next_frame_id = lirsNodes[traversal_frame_id].q_prev;
+		if (claim_victim(traversal_frame_id, buf_state)) {
+			break;
+		}
+	}
+
+	if (traversal_frame_id == NIL_FRAME) {
+		for (traversal_frame_id = lirs->s.tail; traversal_frame_id != NIL_FRAME; traversal_frame_id = next_frame_id) {
+			next_frame_id = lirsNodes[traversal_frame_id].s_prev;
+			if (lirsNodes[traversal_frame_id].status == LIRS_LIR && claim_victim(traversal_frame_id, buf_state)) {
+				break;
+			}
+		}
+	}
+
+	if (traversal_frame_id != NIL_FRAME) {
+		LWLockRelease(&lirs->lirs_lock);
+
+		buf = GetBufferDescriptor(traversal_frame_id);
+		if (strategy != NULL)
+			AddBufferToRing(strategy, buf);
+		return buf;
+	}
+
+	LWLockRelease(&lirs->lirs_lock);
+
+	/*
+	 * We've scanned all the buffers without making any state changes, so
+	 * all the buffers are pinned (or were when we looked at them). We could
+	 * hope that someone will free one eventually, but it's probably better
+	 * to fail than to risk getting stuck in an infinite loop.
+	 */
+	elog(ERROR, "no unpinned buffers available");
+}
+
+/*
+ * StrategyFreeBuffer: put a buffer on the freelist
+ */
+void
+StrategyFreeBuffer(BufferDesc *buf)
+{
+	// Case 4
+	// CS3223: Unlink the frame before it becomes visible on the freelist. The list lock is an LWLock, which
+	// must not be taken while holding buffer_strategy_lock.
+	StrategyAccessBuffer(buf->buf_id, true);
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+	/*
+	 * It is possible that we are told to put something in the freelist that
+	 * is already in it; don't screw up the list if so.
+	 */
+	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
+	{
+		buf->freeNext = StrategyControl->firstFreeBuffer;
+		if (buf->freeNext < 0)
+			StrategyControl->lastFreeBuffer = buf->buf_id;
+		StrategyControl->firstFreeBuffer = buf->buf_id;
+	}
+
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+/*
+ * StrategySyncStart -- tell BufferSync where to start syncing
+ *
+ * The result is the buffer index of the best buffer to sync first.
+ * BufferSync() will proceed circularly around the buffer array from there.
+ *
+ * In addition, we return the completed-pass count (which is effectively
+ * the higher-order bits of nextVictimBuffer) and the count of recent buffer
+ * allocs if non-NULL pointers are passed.  The alloc count is reset after
+ * being read.
+ *
+ * CS3223: Here the clock hand only counts evictions from the list (see
+ * StrategyGetBuffer), so the result and pass count tell the bgwriter how
+ * far eviction has got but not which buffers come next; BgBufferSync gets
+ * those from StrategySyncVictims.
+ */
+int
+StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
+{
+	uint32		nextVictimBuffer;
+	int			result;
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
+	result = nextVictimBuffer % NBuffers;
+
+	if (complete_passes)
+	{
+		*complete_passes = StrategyControl->completePasses;
+
+		/*
+		 * Additionally add the number of wraparounds that happened before
+		 * completePasses could be incremented. C.f. ClockSweepTick().
+		 */
+		*complete_passes += nextVictimBuffer / NBuffers;
+	}
+
+	if (num_buf_alloc)
+	{
+		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
+	}
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+	return result;
+}
+
+
+// CS3223: No victim queue (see freelist_lru.c), the victims are at the tail of Q already
+void StrategyRefillVictimQueue(void) {
+}
+
+// CS3223: See StrategySyncVictims in freelist_lru.c. The order is Q from the tail, then the LIR frames from the bottom
+// of S.
+int StrategySyncVictims(int* buf_ids, int max_buffers) {
+	int num_buffers = 0;
+	int32 q_frame_id;
+	int32 s_frame_id;
+
+	if (max_buffers <= 0) {
+		return 0;
+	}
+
+	LWLockAcquire(&lirs->lirs_lock, LW_SHARED);
+
+	q_frame_id = lirs->q.tail;
+	s_frame_id = lirs->s.tail;
+
+	num_buffers = sync_victims_from(&lirs->q, &q_frame_id, false, buf_ids, num_buffers, max_buffers);
+	num_buffers = sync_victims_from(&lirs->s, &s_frame_id, true, buf_ids, num_buffers, max_buffers);
+
+	LWLockRelease(&lirs->lirs_lock);
+
+	return num_buffers;
+}
+
+// CS3223: LIRS does no dirty look-ahead, see lru_dirty_lookahead
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions) {
+	*clean_substitutions = 0;
+	*dirty_evictions = 0;
+}
+
+// CS3223: Ring reuse against main pool evictions, see StrategyRingStats in freelist_lru.c
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions) {
+	*ring_reuses = pg_atomic_read_u64(&StrategyControl->ringReuses);
+	*ring_evictions = pg_atomic_read_u64(&StrategyControl->ringEvictions);
+	*pool_evictions = pg_atomic_read_u64(&StrategyControl->poolEvictions);
+}
+
+// CS3223: LIRS has no admission filter, see lru_admission_filter
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections) {
+	*admissions = 0;
+	*rejections = 0;
+}
+
+/*
+ * StrategyNotifyBgWriter -- set or clear allocation notification latch
+ *
+ * If bgwprocno isn't -1, the next invocation of StrategyGetBuffer will
+ * set that latch.  Pass -1 to clear the pending notification before it
+ * happens.  This feature is used by the bgwriter process to wake itself up
+ * from hibernation, and is not meant for anybody else to use.
+ */
+void
+StrategyNotifyBgWriter(int bgwprocno)
+{
+	/*
+	 * We acquire buffer_strategy_lock just to ensure that the store appears
+	 * atomic to StrategyGetBuffer.  The bgwriter should call this rather
+	 * infrequently, so there's no performance penalty from being safe.
+	 */
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	StrategyControl->bgwprocno = bgwprocno;
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+
+/*
+ * StrategyShmemSize
+ *
+ * estimate the size of shared memory used by the freelist-related structures.
+ *
+ * Note: for somewhat historical reasons, the buffer lookup hashtable size
+ * is also determined here.
+ */
+Size
+StrategyShmemSize(void)
+{
+	Size		size = 0;
+
+	/* size of lookup hash table ... see comment in StrategyInitialize */
+	size = add_size(size, BufTableShmemSize(NBuffers + NUM_BUFFER_PARTITIONS));
+
+	/* size of the shared replacement strategy control block */
+	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
+
+	// CS3223: Allocate size for our data structures in FREE-LIST, one entry per buffer and one per ghost slot
+	size = add_size(size, mul_size(sizeof(node), add_size(NBuffers, lirs_num_ghosts())));
+
+	// Control information of S, Q and the ghosts
+	size = add_size(size, sizeof(lirs_info));
+
+	// Ghost tags and hash buckets
+	size = add_size(size, mul_size(sizeof(ghost_entry), lirs_num_ghosts()));
+	size = add_size(size, mul_size(sizeof(int32), lirs_num_buckets(lirs_num_ghosts())));
+
+	return size;
+}
+
+/*
+ * StrategyInitialize -- initialize the buffer cache replacement
+ *		strategy.
+ *
+ * Assumes: All of the buffers are already built into a linked list.
+ *		Only called by postmaster and only during initialization.
+ */
+void
+StrategyInitialize(bool init)
+{
+	bool		found;
+
+	// CS3223: Boolean values for if shared memory alloc is successful
+	bool is_dll_success = false;
+	bool is_lirs_success = false;
+	bool is_ghosts_success = false;
+	bool is_ghost_buckets_success = false;
+
+	// lirs_nonresident_percent is PGC_POSTMASTER, so every backend arrives at the same number of ghost slots
+	int num_ghosts = lirs_num_ghosts();
+	uint32 num_buckets = lirs_num_buckets(num_ghosts);
+
+	/*
+	 * Initialize the shared buffer lookup hashtable.
+	 *
+	 * Since we can't tolerate running out of lookup table entries, we must be
+	 * sure to specify an adequate table size here.  The maximum steady-state
+	 * usage is of course NBuffers entries, but BufferAlloc() tries to insert
+	 * a new entry before deleting the old.  In principle this could be
+	 * happening in each partition concurrently, so we could need as many as
+	 * NBuffers + NUM_BUFFER_PARTITIONS entries.
+	 */
+	InitBufTable(NBuffers + NUM_BUFFER_PARTITIONS);
+
+	/*
+	 * Get or create the shared strategy control block
+	 */
+	StrategyControl = (BufferStrategyControl *)
+		ShmemInitStruct("Buffer Strategy Status",
+						sizeof(BufferStrategyControl),
+						&found);
+
+
+	// CS3223: Initialize space for our data structures
+	lirs = (lirs_info *)ShmemInitStruct("LIRS Info", sizeof(lirs_info), &is_lirs_success);
+
+	// Entries of S and Q
+	lirsNodes = (node *)ShmemInitStruct("LIRS Entries",
+										mul_size(sizeof(node), add_size(NBuffers, num_ghosts)),
+										&is_dll_success);
+
+	// Ghosts
+	ghosts = (ghost_entry *)ShmemInitStruct("LIRS Ghosts",
+											mul_size(sizeof(ghost_entry), num_ghosts),
+											&is_ghosts_success);
+	ghostBuckets = (int32 *)ShmemInitStruct("LIRS Ghost Buckets",
+											mul_size(sizeof(int32), num_buckets),
+											&is_ghost_buckets_success);
+
+	if (!found)
+	{
+		/*
+		 * Only done once, usually in postmaster
+		 */
+		Assert(init);
+
+		SpinLockInit(&StrategyControl->buffer_strategy_lock);
+
+		/*
+		 * Grab the whole linked list of free buffers for our strategy. We
+		 * assume it was previously set up by InitBufferPool().
+		 */
+		StrategyControl->firstFreeBuffer = 0;
+		StrategyControl->lastFreeBuffer = NBuffers - 1;
+
+		/* Initialize the clock sweep pointer */
+		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+
+		/* Clear statistics */
+		StrategyControl->completePasses = 0;
+		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
+
+		/* No pending notification */
+		StrategyControl->bgwprocno = -1;
+
+		/* CS3223: Clear ring statistics */
+		pg_atomic_init_u64(&StrategyControl->ringReuses, 0);
+		pg_atomic_init_u64(&StrategyControl->ringEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->poolEvictions, 0);
+
+		/* CS3223: Tranche of lirs_lock */
+		StrategyControl->listLockTrancheId = LWLockNewTrancheId();
+	}
+	else
+		Assert(!init);
+
+	// CS3223: Tranche names are backend-local, so every backend registers it
+	LWLockRegisterTranche(StrategyControl->listLockTrancheId, "LIRSList");
+
+	// CS3223: S and Q start empty, every entry unused, and every ghost slot on the free list
+	if (!is_dll_success && !is_lirs_success && !is_ghosts_success && !is_ghost_buckets_success) {
+		Assert (init);
+		LWLockInitialize(&lirs->lirs_lock, StrategyControl->listLockTrancheId);
+
+		lirs->s.head = NIL_FRAME;
+		lirs->s.tail = NIL_FRAME;
+		lirs->s.size = 0;
+		lirs->q.head = NIL_FRAME;
+		lirs->q.tail = NIL_FRAME;
+		lirs->q.size = 0;
+		lirs->ghost_age.head = NIL_FRAME;
+		lirs->ghost_age.tail = NIL_FRAME;
+		lirs->ghost_age.size = 0;
+		lirs->lir_size = 0;
+
+		// lirs_hir_percent is PGC_POSTMASTER as well
+		lirs->lir_target = lirs_lir_target();
+		lirs->num_ghosts = num_ghosts;
+		lirs->num_buckets = num_buckets;
+
+		for (int32 id = 0; id < NBuffers + num_ghosts; id++) {
+			lirsNodes[id].s_prev = NIL_FRAME;
+			lirsNodes[id].s_next = NIL_FRAME;
+			lirsNodes[id].q_prev = NIL_FRAME;
+			lirsNodes[id].q_next = (IS_GHOST(id) && id + 1 < NBuffers + num_ghosts) ? id + 1 : NIL_FRAME;
+			lirsNodes[id].status = LIRS_NONE;
+			lirsNodes[id].in_s = false;
+			lirsNodes[id].fresh = false;
+		}
+		lirs->free_ghost = (num_ghosts > 0) ? NBuffers : NIL_FRAME;
+
+		for (uint32 b = 0; b < num_buckets; b++) {
+			ghostBuckets[b] = NIL_FRAME;
+		}
+	} else
+		Assert(!init);
+}
+
+
+/* ----------------------------------------------------------------
+ *				Backend-private buffer ring management
+ * ----------------------------------------------------------------
+ */
+
+
+/*
+ * GetAccessStrategy -- create a BufferAccessStrategy object
+ *
+ * The object is allocated in the current memory context.
+ */
+BufferAccessStrategy
+GetAccessStrategy(BufferAccessStrategyType btype)
+{
+	int			ring_size_kb;
+
+	/*
+	 * Select ring size to use.  See buffer/README for rationales.
+	 *
+	 * Note: if you change the ring size for BAS_BULKREAD, see also
+	 * SYNC_SCAN_REPORT_INTERVAL in access/heap/syncscan.c.
+	 */
+	switch (btype)
+	{
+		case BAS_NORMAL:
+			/* if someone asks for NORMAL, just give 'em a "default" object */
+			return NULL;
+
+		case BAS_BULKREAD:
+			ring_size_kb = 256;
+			break;
+		case BAS_BULKWRITE:
+			ring_size_kb = 16 * 1024;
+			break;
+		case BAS_VACUUM:
+			ring_size_kb = 256;
+			break;
+
+		default:
+			elog(ERROR, "unrecognized buffer access strategy: %d",
+				 (int) btype);
+			return NULL;		/* keep compiler quiet */
+	}
+
+	return GetAccessStrategyWithSize(btype, ring_size_kb);
+}
+
+/*
+ * GetAccessStrategyWithSize -- create a BufferAccessStrategy object with a
+ *		number of buffers equivalent to the passed in size.
+ *
+ * If the given ring size is 0, no BufferAccessStrategy will be created and
+ * the function will return NULL.  ring_size_kb must not be negative.
+ */
+BufferAccessStrategy
+GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb)
+{
+	int			ring_buffers;
+	BufferAccessStrategy strategy;
+
+	Assert(ring_size_kb >= 0);
+
+	/* Figure out how many buffers ring_size_kb is */
+	ring_buffers = ring_size_kb / (BLCKSZ / 1024);
+
+	/* 0 means unlimited, so no BufferAccessStrategy required */
+	if (ring_buffers == 0)
+		return NULL;
+
+	/* Cap to 1/8th of shared_buffers */
+	ring_buffers = Min(NBuffers / 8, ring_buffers);
+
+	/* NBuffers should never be less than 16, so this shouldn't happen */
+	Assert(ring_buffers > 0);
+
+	/* Allocate the object and initialize all elements to zeroes */
+	strategy = (BufferAccessStrategy)
+		palloc0(offsetof(BufferAccessStrategyData, buffers) +
+				ring_buffers * sizeof(Buffer));
+
+	/* Set fields that don't start out zero */
+	strategy->btype = btype;
+	strategy->nbuffers = ring_buffers;
+
+	return strategy;
+}
+
+/*
+ * GetAccessStrategyBufferCount -- an accessor for the number of buffers in
+ *		the ring
+ *
+ * Returns 0 on NULL input to match behavior of GetAccessStrategyWithSize()
+ * returning NULL with 0 size.
+ */
+int
+GetAccessStrategyBufferCount(BufferAccessStrategy strategy)
+{
+	if (strategy == NULL)
+		return 0;
+
+	return strategy->nbuffers;
+}
+
+/*
+ * FreeAccessStrategy -- release a BufferAccessStrategy object
+ *
+ * A simple pfree would do at the moment, but we would prefer that callers
+ * don't assume that much about the representation of BufferAccessStrategy.
+ */
+void
+FreeAccessStrategy(BufferAccessStrategy strategy)
+{
+	/* don't crash if called on a "default" strategy */
+	if (strategy != NULL)
+		pfree(strategy);
+}
+
+/*
+ * GetBufferFromRing -- returns a buffer from the ring, or NULL if the
+ *		ring is empty / not usable.
+ *
+ * The bufhdr spin lock is held on the returned buffer.
+ */
+static BufferDesc *
+GetBufferFromRing(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	Buffer		bufnum;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+
+	/* Advance to next ring slot */
+	if (++strategy->current >= strategy->nbuffers)
+		strategy->current = 0;
+
+	/*
+	 * If the slot hasn't been filled yet, tell the caller to allocate a new
+	 * buffer with the normal allocation strategy.  He will then fill this
+	 * slot by calling AddBufferToRing with the new buffer.
+	 */
+	bufnum = strategy->buffers[strategy->current];
+	if (bufnum == InvalidBuffer)
+		return NULL;
+
+	/*
+	 * If the buffer is pinned we cannot use it under any circumstances.
+	 *
+	 * If usage_count is 0 or 1 then the buffer is fair game (we expect 1,
+	 * since our own previous usage of the ring element would have left it
+	 * there, but it might've been decremented by clock sweep since then). A
+	 * higher usage_count indicates someone else has touched the buffer, so we
+	 * shouldn't re-use it.
+	 */
+	buf = GetBufferDescriptor(bufnum - 1);
+	local_buf_state = LockBufHdr(buf);
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+		&& BUF_STATE_GET_USAGECOUNT(local_buf_state) <= 1)
+	{
+		*buf_state = local_buf_state;
+		return buf;
+	}
+	UnlockBufHdr(buf, local_buf_state);
+
+	/*
+	 * Tell caller to allocate a new buffer with the normal allocation
+	 * strategy.  He'll then replace this ring element via AddBufferToRing.
+	 */
+	return NULL;
+}
+
+/*
+ * AddBufferToRing -- add a buffer to the buffer ring
+ *
+ * Caller must hold the buffer header spinlock on the buffer.  Since this
+ * is called with the spinlock held, it had better be quite cheap.
+ */
+static void
+AddBufferToRing(BufferAccessStrategy strategy, BufferDesc *buf)
+{
+	strategy->buffers[strategy->current] = BufferDescriptorGetBuffer(buf);
+}
+
+/*
+ * Utility function returning the IOContext of a given BufferAccessStrategy's
+ * strategy ring.
+ */
+IOContext
+IOContextForStrategy(BufferAccessStrategy strategy)
+{
+	if (!strategy)
+		return IOCONTEXT_NORMAL;
+
+	switch (strategy->btype)
+	{
+		case BAS_NORMAL:
+
+			/*
+			 * Currently, GetAccessStrategy() returns NULL for
+			 * BufferAccessStrategyType BAS_NORMAL, so this case is
+			 * unreachable.
+			 */
+			pg_unreachable();
+			return IOCONTEXT_NORMAL;
+		case BAS_BULKREAD:
+			return IOCONTEXT_BULKREAD;
+		case BAS_BULKWRITE:
+			return IOCONTEXT_BULKWRITE;
+		case BAS_VACUUM:
+			return IOCONTEXT_VACUUM;
+	}
+
+	elog(ERROR, "unrecognized BufferAccessStrategyType: %d", strategy->btype);
+	pg_unreachable();
+}
+
+/*
+ * StrategyRejectBuffer -- consider rejecting a dirty buffer
+ *
+ * When a nondefault strategy is used, the buffer manager calls this function
+ * when it turns out that the buffer selected by StrategyGetBuffer needs to
+ * be written out and doing so would require flushing WAL too.  This gives us
+ * a chance to choose a different victim.
+ *
+ * Returns true if buffer manager should ask for a new victim, and false
+ * if this buffer should be written and re-used.
+ */
+bool
+StrategyRejectBuffer(BufferAccessStrategy strategy, BufferDesc *buf, bool from_ring)
+{
+	/* We only do this in bulkread mode */
+	if (strategy->btype != BAS_BULKREAD)
+		return false;
+
+	/* Don't muck with behavior of normal buffer-replacement strategy */
+	if (!from_ring ||
+		strategy->buffers[strategy->current] != BufferDescriptorGetBuffer(buf))
+		return false;
+
+	/*
+	 * Remove the dirty buffer from the ring; necessary to prevent infinite
+	 * loop if all ring members are dirty.
+	 */
+	strategy->buffers[strategy->current] = InvalidBuffer;
+
+	return true;
+}
@@ -15,11 +15,16 @@
  */
 #include "postgres.h"
 
+#include "access/xact.h"
+#include "common/hashfn.h"
+#include "common/pg_prng.h"
 #include "pgstat.h"
 #include "port/atomics.h"
+#include "port/pg_bitutils.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/proc.h"
+#include "utils/timestamp.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -29,93 +34,970 @@
 
 /*********************************************/
 // CS3223 - Data Structure declarations
+
+// List membership tag for every node. The LRU policy only has the one list (B1),
+// but the tag lets us find a frame by buf_id in O(1) instead of walking the list.
+#define LIST_NONE 0
+#define LIST_B1 1
+
+#define LRU_ACCESS_RING_MAX 64         // Upper bound for lru_access_ring_size
+#define VICTIM_QUEUE_SCAN_FACTOR 4     // A refill looks at up to this many frames per victim it wants
+#define VICTIM_QUEUE_LOW_WATER 4       // The bgwriter is woken once the victim queue is down to 1/4 of its capacity
+#define SKETCH_DEPTH 4                 // Rows of the admission sketch, each page has one counter in every row
+#define SKETCH_COUNTERS_PER_BUFFER 2   // Counters in every row of the admission sketch per buffer
+#define SKETCH_COUNTER_MAX 15          // Sketch counters are 4 bits, 16 to a 64-bit word
+#define SKETCH_COUNTERS_PER_WORD 16
+#define SKETCH_SAMPLE_FACTOR 4         // The sketch is aged once every SKETCH_SAMPLE_FACTOR hits per counter in a row
+#define DOORKEEPER_BITS_PER_COUNTER 8  // Doorkeeper bits per counter in a row
+
+// Nodes are linked by buf_id (32 bits) instead of by pointer
+#define NIL_FRAME (-1)
+#define FRAME_ID(frame) ((int32) ((frame) - doubleLinkedList))
+
 typedef struct node {
-	struct node* prev;
-	struct node* next;
-	int frame_id;
+	int32 prev;                        // buf_id of the previous node, or NIL_FRAME
+	int32 next;                        // buf_id of the next node, or NIL_FRAME
+	uint8 list;                        // LIST_NONE or LIST_B1
+	bool ring;                         // Placed at the tail for a BufferAccessStrategy ring, see place_ring_frame
+	bool old;                          // In the partition's old sublist, see balance_old_sublist
+	bool probation;                    // Holds a newly loaded page that has not been admitted yet, see apply_admission
+	uint32 promoted_at;                // Partition's promotions count when the frame was last put at the head
+	uint32 entered_at;                 // midpoint_clock() when the frame was put at the midpoint
 } node;
 
 typedef struct info {
-	struct node* head;
-	struct node* tail;
+	int32 head;                        // buf_id of the head node, or NIL_FRAME
+	int32 tail;                        // buf_id of the tail node, or NIL_FRAME
 	int size;
-	slock_t linkedListInfo_spinlock;
+	uint32 promotions;                 // Frames put at the head so far (wraps around), see skip_promotion
+	int32 old_head;                    // buf_id of the first node of the old sublist, or NIL_FRAME
+	int old_size;                      // Nodes from old_head to the tail
+	LWLock linkedListInfo_lock;        // Exclusive to change the list, shared to walk it
 } info;
 
-static node* doubleLinkedList = NULL; //Make Global Declare it in InitializeStructure
-static info* linkedListInfo = NULL;
+// The list is split into numPartitions partitions, each with its own recency order and its own lock.
+// Frame buf_id always belongs to partition buf_id % numPartitions. Partitions are padded to a cache line
+// so that backends waiting on different partitions do not share one.
+// Lock order is a partition's list lock, then a buffer header lock. No LWLock is taken while a buffer header lock or a
+// spinlock is held, and no code path holds the locks of two partitions at once.
+typedef union info_padded {
+	info list;
+	char pad[PG_CACHE_LINE_SIZE];
+} info_padded;
+
+static node* doubleLinkedList = NULL; // Indexed by buf_id, so doubleLinkedList[buf_id] is the node for that frame
+static info_padded* linkedListInfo = NULL; // numPartitions entries
+static int numPartitions = 1;              // lru_num_partitions as latched by StrategyInitialize
+static int oldPercent = 0;                 // lru_old_percent as latched by StrategyInitialize, 0 if off
+
+// Victims the bgwriter picked in advance from the tails of the partitions, so that StrategyGetBuffer can usually
+// take one in O(1) instead of walking the list. Entries are only hints: promoted_at is the frame's version when it
+// was picked, and an entry whose frame has been moved or pinned since is dropped when it is popped.
+typedef struct victim_entry {
+	int32 buf_id;
+	uint32 promoted_at;
+} victim_entry;
+
+typedef struct victim_queue {
+	slock_t victimQueue_spinlock;      // Protects head, count and entries
+	int head;                          // Slot of the next entry to pop
+	int count;                         // Entries left to pop, entries[head .. head + count - 1]
+	int capacity;                      // lru_victim_queue_size as latched by StrategyInitialize, 0 if disabled
+	int bgwprocno;                     // pgprocno of the bgwriter that refills the queue, or -1
+	pg_atomic_uint32 refill_requested; // Set once the queue runs low, cleared by the next refill
+	victim_entry entries[FLEXIBLE_ARRAY_MEMBER];
+} victim_queue;
+
+static victim_queue* victimQueue = NULL;
+
+// Admission filter: a count-min sketch of how often each page has been hit lately, keyed by the hash of its
+// BufferTag, so it remembers pages across evictions. Every counter is halved once sample_size hits have been recorded,
+// so old popularity fades. In front of the sketch is a doorkeeper Bloom filter, cleared by the same aging, that takes
+// the first hit of every page, so pages hit only once never reach the counters. Counters and doorkeeper bits are
+// updated with atomics, never under a lock. With SKETCH_COUNTERS_PER_BUFFER counters per buffer in a row (rounded up
+// to a power of 2), that is 6 bytes per buffer in all.
+typedef struct admission_sketch {
+	uint32 width;                      // Counters per row, a power of 2, 0 if the filter is off
+	uint32 sample_size;                // Hits recorded between two agings
+	pg_atomic_uint32 samples;          // Hits recorded since the last aging
+	pg_atomic_uint64 admissions;       // Pages on probation that beat the frame behind them
+	pg_atomic_uint64 rejections;       // Pages on probation that were evicted
+	pg_atomic_uint64 words[FLEXIBLE_ARRAY_MEMBER];   // SKETCH_DEPTH rows of counters, then the doorkeeper
+} admission_sketch;
+
+static admission_sketch* admissionSketch = NULL;
+static bool admissionFilter = false;       // lru_admission_filter as latched by StrategyInitialize
+
+#define PARTITION_OF(frame_id) (&linkedListInfo[(frame_id) % numPartitions].list)
+
+// CS3223: The GUCs below are defined in bufmgr.c and registered in guc_tables.c by bufmgr.patch, not here: guc_tables.c
+// refers to the GUCs of every engine, and has to link with whichever one is copied in as freelist.c.
+
+// CS3223 - GUC (PGC_POSTMASTER): number of independently locked LRU partitions, at most NUM_BUFFER_PARTITIONS.
+// 1 keeps a single exact LRU list; more partitions trade global LRU order for less lock contention.
+extern PGDLLIMPORT int lru_num_partitions;
+
+// CS3223 - GUC (PGC_USERSET): number of accesses a backend collects before moving them to the head of the list
+// in one go. 0 moves every accessed frame immediately. See record_access.
+extern PGDLLIMPORT int lru_access_ring_size;
+
+// CS3223 - GUC (PGC_USERSET): percentage of a partition, counted from the head, inside which an accessed frame is
+// not moved to the head again. 0 always moves it. See skip_promotion.
+extern PGDLLIMPORT int lru_promotion_filter;
+
+// CS3223 - GUC (PGC_USERSET): percentage chance that a frame inside the lru_promotion_filter window is moved anyway
+extern PGDLLIMPORT int lru_promotion_probability;
+
+// CS3223 - GUC (PGC_POSTMASTER): number of victims the bgwriter keeps picked in advance, at most NBuffers.
+// 0 disables the victim queue, so every StrategyGetBuffer walks the list. See StrategyRefillVictimQueue.
+extern PGDLLIMPORT int lru_victim_queue_size;
+
+// CS3223 - GUC (PGC_USERSET): number of unpinned candidates from the tail that victim search looks at when the first
+// one is dirty, to substitute a clean one that the backend need not write out first. 0 or 1 evicts the first one.
+extern PGDLLIMPORT int lru_dirty_lookahead;
+
+// CS3223 - GUC (PGC_USERSET): how much younger than the true LRU victim a clean substitute may be, as a percentage
+// of the partition (counted in promotions). See find_clean_victim.
+extern PGDLLIMPORT int lru_dirty_age_tolerance;
+
+// CS3223 - GUC (PGC_POSTMASTER): percentage of every partition, counted from the tail, kept as its old sublist, at most
+// 95. Newly loaded pages enter at the head of the old sublist instead of the head of the list. 0 disables midpoint
+// insertion. See balance_old_sublist.
+extern PGDLLIMPORT int lru_old_percent;
+
+// CS3223 - GUC (PGC_USERSET): milliseconds a page has to stay in the old sublist before a re-reference moves it to the
+// head. Re-references within that time (e.g. the rest of the rows of a page read by a scan) leave it where it is.
+extern PGDLLIMPORT int lru_old_dwell_ms;
+
+// CS3223 - GUC (PGC_POSTMASTER): keep newly loaded pages on probation until they are hit again. A page on probation
+// that comes up for eviction only stays if the admission sketch says it is more popular than the frame LRU would evict
+// after it, which then goes in its place. Works best with lru_old_percent on, whose old sublist then serves as the
+// admission window. See apply_admission.
+extern PGDLLIMPORT bool lru_admission_filter;
+
+// CS3223 - GUC (PGC_USERSET): number of unpinned frames behind a page on probation that victim search looks through for
+// an admitted one to compare it with. 0 evicts pages on probation without comparing them.
+extern PGDLLIMPORT int lru_admission_lookahead;
+
+// Per-backend ring of accessed buf_ids that have not been moved to the head yet
+static int accessRing[LRU_ACCESS_RING_MAX];
+static int accessRingCount = 0;
+static bool accessRingCallbackRegistered = false;
+
+int lru_partition_count(void);
+bool skip_promotion(int buf_id);
+bool skip_ring_promotion(int buf_id);
+int32 find_clean_victim(info* list_info, int32 dirty_frame_id);
+bool record_access(int buf_id);
+void flush_access_ring(void);
+void access_ring_xact_callback(XactEvent event, void* arg);
+int lru_victim_queue_capacity(void);
+Size victim_queue_shmem_size(int capacity);
+int pick_victims(info* list_info, victim_entry* out, int quota, bool prefer_clean);
+int collect_victims(victim_entry* out, int max_victims, bool prefer_clean, int start_partition);
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions);
+void request_victim_queue_refill(void);
+BufferDesc* pop_victim(uint32* buf_state, bool for_ring, uint32 now_ms);
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions);
+void place_ring_frame(int buf_id);
+void release_ring_frame(int buf_id);
 node* search_for_frame(int desired_frame_id);
 void delete_arbitrarily(int frame_id_for_deletion);
 void insert_at_head(node* frame);
 void move_to_head(node* frame);       // Case 1 - Called by StrategyAccessBuffer(..., false) in bufmgr_lru.c
+void insert_at_tail(node* frame);
+void move_to_tail(node* frame);       // Victims taken for a BufferAccessStrategy ring
+void insert_at_midpoint(node* frame, uint32 now_ms);
+void move_to_midpoint(node* frame, uint32 now_ms);    // Victims taken with lru_old_percent on
+void place_victim(node* frame, bool for_ring, uint32 now_ms);
+void balance_old_sublist(info* list_info);
+uint32 midpoint_clock(void);
+bool old_frame_dwelling(int buf_id);
+uint32 admission_sketch_width(void);
+Size admission_sketch_shmem_size(uint32 width);
+void sketch_increment(uint32 row, uint32 index);
+uint32 sketch_estimate(uint32 hash);
+void sketch_age(void);
+void record_frequency(int buf_id);
+uint32 frame_frequency(int32 frame_id);
+bool find_admission_rival(const victim_entry* victim, victim_entry* rival);
+bool apply_admission(const victim_entry* victim, const victim_entry* rival);
+BufferDesc* claim_victim(const victim_entry* seen, bool for_ring, uint32 now_ms, uint32* buf_state);
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections);
 
 /*********************************************/
 // CS3223 - Function definitions
 
-// Traverse through linkedListInfo for frame corresponding to some 'frame_id'
-node* search_for_frame(int desired_frame_id) {
-	node* traversal_ptr;
-
-	if (linkedListInfo->head == NULL) { 
-		//elog(ERROR, "linkedListInfo is empty");
-		return NULL; // Handle empty list case properly
-	} else {
-		traversal_ptr = linkedListInfo->head;
+// Number of partitions to use, lru_num_partitions clamped to [1, Min(NUM_BUFFER_PARTITIONS, NBuffers)]
+int lru_partition_count(void) {
+	return Min(Max(lru_num_partitions, 1), Min(NUM_BUFFER_PARTITIONS, NBuffers));
+}
 
-		while (traversal_ptr != NULL) {
-			if (traversal_ptr->frame_id == desired_frame_id) {
-				return traversal_ptr;
-			}
+// Look up the node for 'desired_frame_id' in O(1); returns NULL if the frame is not in the list
+node* search_for_frame(int desired_frame_id) {
+	node* frame = &doubleLinkedList[desired_frame_id];
 
-			traversal_ptr = traversal_ptr->next;
-		}
+	if (frame->list == LIST_NONE) {
+		return NULL;
 	}
 
-	return NULL; // Return NULL if frame_id not found
+	return frame;
 }
 
+// Unlink a frame from its partition's list in O(1). Frames that are not in the list are ignored.
 void delete_arbitrarily(int frame_id_for_deletion) {
 	node* frame_for_deletion = search_for_frame(frame_id_for_deletion);
+	info* list_info = PARTITION_OF(frame_id_for_deletion);
 
 	if (!frame_for_deletion) { // Handle case where frame is not found
 		return;
 	}
 
-	if (frame_for_deletion == linkedListInfo->head) { // Correctly check and update head
-		if (linkedListInfo->head->next) { // Check if there's a next node
-			linkedListInfo->head = linkedListInfo->head->next;
-			linkedListInfo->head->prev = NULL;
-		} else { // List becomes empty
-			linkedListInfo->head = linkedListInfo->tail = NULL;
+	if (frame_for_deletion->old) {
+		if (list_info->old_head == frame_id_for_deletion) {
+			list_info->old_head = frame_for_deletion->next;
 		}
-		} else if (frame_for_deletion == linkedListInfo->tail) { // Correctly check and update tail
-			linkedListInfo->tail = linkedListInfo->tail->prev;
-			linkedListInfo->tail->next = NULL;
-		} else { // Node is in the middle
-			frame_for_deletion->prev->next = frame_for_deletion->next;
-			frame_for_deletion->next->prev = frame_for_deletion->prev;
+		list_info->old_size--;
+	}
+
+	if (frame_for_deletion->prev != NIL_FRAME) {
+		doubleLinkedList[frame_for_deletion->prev].next = frame_for_deletion->next;
+	} else {
+		list_info->head = frame_for_deletion->next;
 	}
+
+	if (frame_for_deletion->next != NIL_FRAME) {
+		doubleLinkedList[frame_for_deletion->next].prev = frame_for_deletion->prev;
+	} else {
+		list_info->tail = frame_for_deletion->prev;
+	}
+
+	frame_for_deletion->prev = NIL_FRAME;
+	frame_for_deletion->next = NIL_FRAME;
+	frame_for_deletion->list = LIST_NONE;
+	frame_for_deletion->ring = false;
+	frame_for_deletion->old = false;
+	frame_for_deletion->probation = false;
+	list_info->size--;
+
+	balance_old_sublist(list_info);
 }
 
+// Link a frame (which must not be in the list) at the head of its partition's list
 void insert_at_head(node* frame) { 
-	frame->next = linkedListInfo->head; 
-	if (linkedListInfo->head != NULL) { // Check if list is not empty
-		linkedListInfo->head->prev = frame; 
+	info* list_info = PARTITION_OF(FRAME_ID(frame));
+
+	Assert(frame->list == LIST_NONE);
+
+	frame->prev = NIL_FRAME;
+	frame->next = list_info->head; 
+	if (list_info->head != NIL_FRAME) { // Check if list is not empty
+		doubleLinkedList[list_info->head].prev = FRAME_ID(frame); 
 	}
-	linkedListInfo->head = frame; 
+	list_info->head = FRAME_ID(frame); 
 
-	if (linkedListInfo->tail == NULL) { // If list was empty, update tail as well
-		linkedListInfo->tail = frame;
+	if (list_info->tail == NIL_FRAME) { // If list was empty, update tail as well
+		list_info->tail = FRAME_ID(frame);
 	}
 
-	frame->prev = NULL; // Set frame's prev to NULL
+	frame->list = LIST_B1;
+	frame->ring = false;
+	frame->promoted_at = ++list_info->promotions;
+	list_info->size++;
+
+	balance_old_sublist(list_info);
 } 
 
 void move_to_head(node* frame) { 
-	delete_arbitrarily(frame->frame_id);
+	if (FRAME_ID(frame) == PARTITION_OF(FRAME_ID(frame))->head) { // Already the most recently used frame
+		return;
+	}
+
+	delete_arbitrarily(FRAME_ID(frame));
 	insert_at_head(frame); 
 }
 
+// Link a frame (which must not be in the list) at the tail of its partition's list, for a strategy's ring.
+// promoted_at still moves on, since victim search uses it as the frame's version.
+void insert_at_tail(node* frame) {
+	info* list_info = PARTITION_OF(FRAME_ID(frame));
+
+	Assert(frame->list == LIST_NONE);
+
+	frame->next = NIL_FRAME;
+	frame->prev = list_info->tail;
+	if (list_info->tail != NIL_FRAME) { // Check if list is not empty
+		doubleLinkedList[list_info->tail].next = FRAME_ID(frame);
+	}
+	list_info->tail = FRAME_ID(frame);
+
+	if (list_info->head == NIL_FRAME) { // If list was empty, update head as well
+		list_info->head = FRAME_ID(frame);
+	}
+
+	frame->list = LIST_B1;
+	frame->ring = true;
+	frame->promoted_at = ++list_info->promotions;
+	list_info->size++;
+
+	// The tail is part of the old sublist whenever there is one
+	if (oldPercent > 0) {
+		frame->old = true;
+		frame->entered_at = 0;
+		if (list_info->old_head == NIL_FRAME) {
+			list_info->old_head = FRAME_ID(frame);
+		}
+		list_info->old_size++;
+	}
+
+	balance_old_sublist(list_info);
+}
+
+void move_to_tail(node* frame) {
+	delete_arbitrarily(FRAME_ID(frame));
+	insert_at_tail(frame);
+}
+
+// Midpoint insertion - Function definitions
+
+// With lru_old_percent on, the tail end of every partition is its old sublist: the old_size frames from old_head to
+// the tail. A newly loaded page enters at old_head and is only moved to the head once it is re-referenced at least
+// lru_old_dwell_ms later, so a scan that reads every page once only ever cycles through the old sublist and leaves the
+// young sublist (the working set) alone.
+
+// Link a frame holding a newly loaded page (which must not be in the list) at the head of its partition's old sublist
+void insert_at_midpoint(node* frame, uint32 now_ms) {
+	info* list_info = PARTITION_OF(FRAME_ID(frame));
+
+	Assert(frame->list == LIST_NONE);
+
+	// With an empty old sublist the midpoint is the tail
+	frame->next = list_info->old_head;
+	frame->prev = (frame->next != NIL_FRAME) ? doubleLinkedList[frame->next].prev : list_info->tail;
+
+	if (frame->prev != NIL_FRAME) {
+		doubleLinkedList[frame->prev].next = FRAME_ID(frame);
+	} else {
+		list_info->head = FRAME_ID(frame);
+	}
+
+	if (frame->next != NIL_FRAME) {
+		doubleLinkedList[frame->next].prev = FRAME_ID(frame);
+	} else {
+		list_info->tail = FRAME_ID(frame);
+	}
+
+	frame->list = LIST_B1;
+	frame->ring = false;
+	frame->old = true;
+	frame->entered_at = now_ms;
+	frame->promoted_at = ++list_info->promotions;    // Only the frame's version here, skip_promotion ignores old frames
+	list_info->old_head = FRAME_ID(frame);
+	list_info->old_size++;
+	list_info->size++;
+
+	balance_old_sublist(list_info);
+}
+
+void move_to_midpoint(node* frame, uint32 now_ms) {
+	delete_arbitrarily(FRAME_ID(frame));
+	insert_at_midpoint(frame, now_ms);
+}
+
+// Where StrategyGetBuffer puts the victim it has claimed: the tail for a ring, the midpoint with lru_old_percent on,
+// and the head otherwise. With lru_admission_filter on, the newly loaded page is on probation until it is hit again.
+void place_victim(node* frame, bool for_ring, uint32 now_ms) {
+	if (for_ring) {
+		move_to_tail(frame);
+		return;
+	}
+
+	if (oldPercent > 0) {
+		move_to_midpoint(frame, now_ms);
+	} else {
+		move_to_head(frame);
+	}
+	frame->probation = admissionFilter;
+}
+
+// Called with the partition's lock held exclusively after every frame linked or unlinked. Each of those changes the
+// partition's size and its old sublist by at most one frame, so moving the boundary by one frame keeps old_size at
+// exactly lru_old_percent of the partition, in O(1).
+void balance_old_sublist(info* list_info) {
+	int target;
+	int32 frame_id;
+
+	if (oldPercent == 0) {
+		return;
+	}
+
+	target = (int) ((int64) list_info->size * oldPercent / 100);
+
+	if (list_info->old_size > target) {
+		// The first old frame becomes the last young one. Its promoted_at is set to what it would be had it been
+		// pushed there from the head, so that it still bounds the frame's distance from the head (see skip_promotion).
+		frame_id = list_info->old_head;
+		doubleLinkedList[frame_id].old = false;
+		list_info->old_head = doubleLinkedList[frame_id].next;
+		list_info->old_size--;
+		doubleLinkedList[frame_id].promoted_at = list_info->promotions - (uint32) (list_info->size - list_info->old_size - 1);
+	} else if (list_info->old_size < target) {
+		// The last young frame becomes the first old one
+		frame_id = (list_info->old_head != NIL_FRAME) ? doubleLinkedList[list_info->old_head].prev : list_info->tail;
+		doubleLinkedList[frame_id].old = true;
+		list_info->old_head = frame_id;
+		list_info->old_size++;
+	}
+}
+
+// Milliseconds, wrapping around every 49 days, for lru_old_dwell_ms
+uint32 midpoint_clock(void) {
+	return (uint32) (GetCurrentTimestamp() / 1000);
+}
+
+// Called by StrategyAccessBuffer without any lock: true if the frame is in the old sublist and was put there less than
+// lru_old_dwell_ms ago, in which case the access leaves it where it is. A frame that ages out of the young sublist
+// keeps its entered_at, so its next access promotes it unless it is still within its own dwell time.
+// The unlocked reads can be stale, which only misjudges one access.
+bool old_frame_dwelling(int buf_id) {
+	node* frame = &doubleLinkedList[buf_id];
+
+	if (!frame->old || frame->list == LIST_NONE) {
+		return false;
+	}
+
+	return midpoint_clock() - frame->entered_at < (uint32) Max(lru_old_dwell_ms, 0);
+}
+
+// Admission filter - Function definitions
+
+// Counters per row of the admission sketch: SKETCH_COUNTERS_PER_BUFFER per buffer, as there are many more pages than
+// buffers to tell apart, rounded up to a power of 2 so a hash can be masked. 0 if lru_admission_filter is off.
+uint32 admission_sketch_width(void) {
+	if (!lru_admission_filter) {
+		return 0;
+	}
+
+	return Max(pg_nextpower2_32((uint32) NBuffers * SKETCH_COUNTERS_PER_BUFFER), SKETCH_COUNTERS_PER_WORD);
+}
+
+Size admission_sketch_shmem_size(uint32 width) {
+	Size num_words = add_size(mul_size(SKETCH_DEPTH, width / SKETCH_COUNTERS_PER_WORD), width * DOORKEEPER_BITS_PER_COUNTER / 64);
+
+	return add_size(offsetof(admission_sketch, words), mul_size(sizeof(pg_atomic_uint64), num_words));
+}
+
+// Add one to counter 'index' of row 'row', unless it is already at SKETCH_COUNTER_MAX
+void sketch_increment(uint32 row, uint32 index) {
+	pg_atomic_uint64* word = &admissionSketch->words[row * (admissionSketch->width / SKETCH_COUNTERS_PER_WORD) + index / SKETCH_COUNTERS_PER_WORD];
+	int shift = (index % SKETCH_COUNTERS_PER_WORD) * 4;
+	uint64 old_word = pg_atomic_read_u64(word);
+
+	while (((old_word >> shift) & SKETCH_COUNTER_MAX) < SKETCH_COUNTER_MAX) {
+		if (pg_atomic_compare_exchange_u64(word, &old_word, old_word + (UINT64CONST(1) << shift))) {
+			break;
+		}
+	}
+}
+
+// How often the page with BufferTag hash 'hash' has been hit lately: the smallest of its counters, plus one if the
+// doorkeeper has seen it. Pages that share all of their counters with more popular ones are overestimated, never
+// underestimated. Every row uses its own probe, row r at hash + r * step, with an odd step so rows differ.
+uint32 sketch_estimate(uint32 hash) {
+	uint32 width = admissionSketch->width;
+	uint32 step = murmurhash32(hash) | 1;
+	uint32 doorkeeper_bit = murmurhash32(step) & (width * DOORKEEPER_BITS_PER_COUNTER - 1);
+	pg_atomic_uint64* doorkeeper = &admissionSketch->words[SKETCH_DEPTH * (width / SKETCH_COUNTERS_PER_WORD)];
+	uint32 estimate = SKETCH_COUNTER_MAX;
+
+	for (uint32 row = 0; row < SKETCH_DEPTH; row++) {
+		uint32 index = (hash + row * step) & (width - 1);
+		uint64 word = pg_atomic_read_u64(&admissionSketch->words[row * (width / SKETCH_COUNTERS_PER_WORD) + index / SKETCH_COUNTERS_PER_WORD]);
+
+		estimate = Min(estimate, (uint32) ((word >> ((index % SKETCH_COUNTERS_PER_WORD) * 4)) & SKETCH_COUNTER_MAX));
+	}
+
+	if (pg_atomic_read_u64(&doorkeeper[doorkeeper_bit / 64]) & (UINT64CONST(1) << (doorkeeper_bit % 64))) {
+		estimate++;
+	}
+
+	return estimate;
+}
+
+// Halve every counter of the sketch and clear the doorkeeper. Called by the backend whose hit completes a sample, while
+// others go on recording; an increment that races with the halving of its word is simply redone on the new value.
+// O(width), once every sample_size hits.
+void sketch_age(void) {
+	uint32 width = admissionSketch->width;
+	uint32 num_counter_words = SKETCH_DEPTH * (width / SKETCH_COUNTERS_PER_WORD);
+	uint32 num_doorkeeper_words = width * DOORKEEPER_BITS_PER_COUNTER / 64;
+
+	for (uint32 i = 0; i < num_counter_words; i++) {
+		pg_atomic_uint64* word = &admissionSketch->words[i];
+		uint64 old_word = pg_atomic_read_u64(word);
+
+		// Shifting the whole word right halves each counter; the mask drops the bit every counter got from the next one
+		while (!pg_atomic_compare_exchange_u64(word, &old_word, (old_word >> 1) & UINT64CONST(0x7777777777777777))) {
+		}
+	}
+
+	for (uint32 i = 0; i < num_doorkeeper_words; i++) {
+		pg_atomic_write_u64(&admissionSketch->words[num_counter_words + i], 0);
+	}
+
+	pg_atomic_sub_fetch_u32(&admissionSketch->samples, admissionSketch->sample_size);
+}
+
+// Called by StrategyAccessBuffer, without any lock, for every hit. The caller has the buffer pinned, so its tag is
+// stable; the freelist's call (Case 2) is for a buffer nobody has pinned yet, which is not a hit and is skipped.
+// A page's first hit since the last aging only goes into the doorkeeper, later ones into its counters.
+void record_frequency(int buf_id) {
+	BufferDesc* buf = GetBufferDescriptor(buf_id);
+	uint32 state = pg_atomic_read_u32(&buf->state);
+	uint32 width = admissionSketch->width;
+	uint32 hash;
+	uint32 step;
+	uint32 doorkeeper_bit;
+	uint64 doorkeeper_mask;
+
+	if (BUF_STATE_GET_REFCOUNT(state) == 0 || !(state & BM_TAG_VALID)) {
+		return;
+	}
+
+	hash = BufTableHashCode(&buf->tag);
+	step = murmurhash32(hash) | 1;
+	doorkeeper_bit = murmurhash32(step) & (width * DOORKEEPER_BITS_PER_COUNTER - 1);
+	doorkeeper_mask = UINT64CONST(1) << (doorkeeper_bit % 64);
+
+	if (pg_atomic_add_fetch_u32(&admissionSketch->samples, 1) == admissionSketch->sample_size) {
+		sketch_age();
+	}
+
+	if (!(pg_atomic_fetch_or_u64(&admissionSketch->words[SKETCH_DEPTH * (width / SKETCH_COUNTERS_PER_WORD) + doorkeeper_bit / 64], doorkeeper_mask) & doorkeeper_mask)) {
+		return;
+	}
+
+	for (uint32 row = 0; row < SKETCH_DEPTH; row++) {
+		sketch_increment(row, (hash + row * step) & (width - 1));
+	}
+}
+
+// Estimated popularity of the page in unpinned frame 'frame_id'. Its buffer header is locked just long enough to copy
+// the tag, so the caller must not hold any lock. A frame without a valid tag counts as 0.
+uint32 frame_frequency(int32 frame_id) {
+	BufferDesc* buf = GetBufferDescriptor(frame_id);
+	uint32 state = LockBufHdr(buf);
+	BufferTag tag = buf->tag;
+
+	UnlockBufHdr(buf, state);
+
+	if (!(state & BM_TAG_VALID)) {
+		return 0;
+	}
+
+	return sketch_estimate(BufTableHashCode(&tag));
+}
+
+// Called by victim search, holding the partition's lock (shared mode is enough), for the unpinned frame 'victim' it is
+// about to evict. Returns false unless the frame is still as it was picked and on probation, i.e. holds a page that was
+// loaded and has not been hit since (or only within lru_old_dwell_ms). Then 'rival' is set to the frame LRU would evict
+// in its place: the first admitted frame among the next lru_admission_lookahead unpinned frames towards the head, or
+// NIL_FRAME if there is none that close.
+bool find_admission_rival(const victim_entry* victim, victim_entry* rival) {
+	node* frame = &doubleLinkedList[victim->buf_id];
+	int candidates_left = lru_admission_lookahead;
+
+	if (frame->list != LIST_B1 || frame->promoted_at != victim->promoted_at || !frame->probation) {
+		return false;
+	}
+
+	rival->buf_id = NIL_FRAME;
+	for (int32 rival_id = frame->prev; rival_id != NIL_FRAME && candidates_left > 0; rival_id = doubleLinkedList[rival_id].prev) {
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&GetBufferDescriptor(rival_id)->state)) != 0) {
+			continue;
+		}
+
+		candidates_left--;
+		if (doubleLinkedList[rival_id].probation || doubleLinkedList[rival_id].ring) {
+			continue;
+		}
+
+		rival->buf_id = rival_id;
+		rival->promoted_at = doubleLinkedList[rival_id].promoted_at;
+		break;
+	}
+
+	return true;
+}
+
+// Called by victim search, holding no lock, for the frame on probation 'victim' and the 'rival' find_admission_rival
+// found for it. The page on probation gets to stay only if it is more popular than the rival's. In that case it is
+// admitted, moved to the head like a hit would, and true is returned: the rival is to be evicted instead. The tags are
+// read with no list lock held, so the frames may have moved meanwhile, which claim_victim finds out.
+bool apply_admission(const victim_entry* victim, const victim_entry* rival) {
+	info* list_info = PARTITION_OF(victim->buf_id);
+	node* frame = &doubleLinkedList[victim->buf_id];
+	uint32 frequency;
+
+	// A page nobody has hit lately cannot beat anything
+	frequency = (rival->buf_id != NIL_FRAME) ? frame_frequency(victim->buf_id) : 0;
+
+	if (frequency == 0 || frequency <= frame_frequency(rival->buf_id)) {
+		pg_atomic_fetch_add_u64(&admissionSketch->rejections, 1);
+		return false;
+	}
+
+	// Unless a hit has promoted it already
+	LWLockAcquire(&list_info->linkedListInfo_lock, LW_EXCLUSIVE);
+	if (frame->list == LIST_B1 && frame->promoted_at == victim->promoted_at) {
+		move_to_head(frame);
+	}
+	LWLockRelease(&list_info->linkedListInfo_lock);
+
+	pg_atomic_fetch_add_u64(&admissionSketch->admissions, 1);
+	return true;
+}
+
+// Try to evict the frame 'seen' describes, holding no lock. Unless it has been moved since it was seen (promoted_at
+// changes whenever it is), the frame is first moved to where place_victim puts it, under the partition's lock. Only
+// then, with the list unlocked, is its buffer header locked to make sure nobody has pinned it meanwhile, as the
+// freelist path in StrategyGetBuffer does. A frame pinned in between has only been promoted a little early, as a pin
+// is almost always a hit that promotes it anyway. Returns the buffer with its header locked, or NULL.
+BufferDesc* claim_victim(const victim_entry* seen, bool for_ring, uint32 now_ms, uint32* buf_state) {
+	info* list_info = PARTITION_OF(seen->buf_id);
+	node* frame = &doubleLinkedList[seen->buf_id];
+	BufferDesc* buf = GetBufferDescriptor(seen->buf_id);
+	uint32 local_buf_state;
+	bool moved;
+
+	LWLockAcquire(&list_info->linkedListInfo_lock, LW_EXCLUSIVE);
+	moved = (frame->list != LIST_B1 || frame->promoted_at != seen->promoted_at);
+	if (!moved) {
+		place_victim(frame, for_ring, now_ms);
+	}
+	LWLockRelease(&list_info->linkedListInfo_lock);
+
+	if (moved) {
+		return NULL;
+	}
+
+	local_buf_state = LockBufHdr(buf);
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0) {
+		UnlockBufHdr(buf, local_buf_state);
+		return NULL;
+	}
+
+	*buf_state = local_buf_state;
+	return buf;
+}
+
+// Called by StrategyGetBuffer, holding no buffer header lock, for a buffer it is about to hand to a strategy's ring.
+// Ring buffers are kept at the tail: the ring recycles them itself, and once it has moved on they are the first to
+// be evicted, so a bulk scan or VACUUM does not push the rest of the pool towards the tail.
+void place_ring_frame(int buf_id) {
+	info* list_info = PARTITION_OF(buf_id);
+
+	LWLockAcquire(&list_info->linkedListInfo_lock, LW_EXCLUSIVE);
+	move_to_tail(&doubleLinkedList[buf_id]);
+	LWLockRelease(&list_info->linkedListInfo_lock);
+}
+
+// Called by StrategyRejectBuffer once a ring has given up a buffer. The frame stays where it is, but the next access
+// promotes it like any other. Its promoted_at is set back as far as the partition is long, so skip_promotion does not
+// take it for a frame near the head.
+void release_ring_frame(int buf_id) {
+	info* list_info = PARTITION_OF(buf_id);
+	node* frame = &doubleLinkedList[buf_id];
+
+	LWLockAcquire(&list_info->linkedListInfo_lock, LW_EXCLUSIVE);
+	if (frame->ring && frame->list != LIST_NONE) {
+		frame->ring = false;
+		frame->promoted_at = list_info->promotions - (uint32) list_info->size;
+	}
+	LWLockRelease(&list_info->linkedListInfo_lock);
+}
+
+// Called by StrategyAccessBuffer without any lock: true if the frame belongs to a ring and only the ring has used it,
+// in which case the access leaves it at the tail. The ring's own pins never take the usage count above 1, so a higher
+// one means somebody else uses the buffer too (the test GetBufferFromRing makes); that access promotes the frame,
+// which takes it out of the ring's care. The unlocked reads can be stale, which only misjudges one access.
+bool skip_ring_promotion(int buf_id) {
+	node* frame = &doubleLinkedList[buf_id];
+
+	return frame->ring && frame->list != LIST_NONE &&
+		BUF_STATE_GET_USAGECOUNT(pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state)) <= 1;
+}
+
+// Called by StrategyAccessBuffer without any lock: true if the frame is close enough to the head that moving it
+// there is not worth the list write. Every insert_at_head pushes a frame at most one place further from the head, so
+// the number of promotions in its partition since its own last promotion bounds its distance from the head.
+// The unlocked reads can be stale, which only means an access is filtered (or not) by mistake.
+bool skip_promotion(int buf_id) {
+	node* frame = &doubleLinkedList[buf_id];
+	info* list_info = PARTITION_OF(buf_id);
+	uint32 window;
+
+	// Ring and old frames have a recent promoted_at although they sit far from the head
+	if (lru_promotion_filter <= 0 || frame->list == LIST_NONE || frame->ring || frame->old) {
+		return false;
+	}
+
+	window = (uint32) ((uint64) list_info->size * Min(lru_promotion_filter, 100) / 100);
+	if (list_info->promotions - frame->promoted_at >= window) {
+		return false;
+	}
+
+	return lru_promotion_probability <= 0 ||
+		pg_prng_double(&pg_global_prng_state) * 100 >= lru_promotion_probability;
+}
+
+// Called by victim search, holding the partition's lock, when the first unpinned candidate 'dirty_frame_id' is dirty.
+// Looks at up to lru_dirty_lookahead - 1 further unpinned candidates towards the head and returns the first clean
+// one, or NIL_FRAME if there is none. Candidates put at the head more than lru_dirty_age_tolerance percent of the
+// partition's promotions after the dirty one are too young to stand in for it, and end the search.
+int32 find_clean_victim(info* list_info, int32 dirty_frame_id) {
+	uint32 oldest = doubleLinkedList[dirty_frame_id].promoted_at;
+	uint32 window = (uint32) ((uint64) list_info->size * Min(Max(lru_dirty_age_tolerance, 0), 100) / 100);
+	int candidates_left = lru_dirty_lookahead - 1;
+
+	for (int32 frame_id = doubleLinkedList[dirty_frame_id].prev; frame_id != NIL_FRAME && candidates_left > 0; frame_id = doubleLinkedList[frame_id].prev) {
+		uint32 state = pg_atomic_read_u32(&GetBufferDescriptor(frame_id)->state);
+
+		// Signed, as ring frames sit at the tail with a newer promoted_at than the frames in front of them
+		if ((int32) (doubleLinkedList[frame_id].promoted_at - oldest) > (int32) window) {
+			break;
+		}
+
+		if (BUF_STATE_GET_REFCOUNT(state) != 0) {
+			continue;
+		}
+
+		if (!(state & BM_DIRTY)) {
+			return frame_id;
+		}
+
+		candidates_left--;
+	}
+
+	return NIL_FRAME;
+}
+
+// Called by StrategyAccessBuffer. If the access ring is enabled and the frame is already in the list, the access is
+// only recorded in this backend's ring and true is returned; the caller then has nothing left to do. Frames that are
+// not in the list (fresh from the freelist) are never deferred, otherwise they could not be evicted until the ring is
+// flushed. The unlocked look at frame->list is only a hint, flush_access_ring checks it again.
+bool record_access(int buf_id) {
+	int ring_size = Min(lru_access_ring_size, LRU_ACCESS_RING_MAX);
+
+	if (ring_size <= 0 || doubleLinkedList[buf_id].list == LIST_NONE) {
+		return false;
+	}
+
+	// Accessing the same frame again before anything else changes nothing in LRU order
+	if (accessRingCount > 0 && accessRing[accessRingCount - 1] == buf_id) {
+		return true;
+	}
+
+	if (!accessRingCallbackRegistered) {
+		RegisterXactCallback(access_ring_xact_callback, NULL);
+		accessRingCallbackRegistered = true;
+	}
+
+	accessRing[accessRingCount++] = buf_id;
+	if (accessRingCount >= ring_size) {
+		flush_access_ring();
+	}
+
+	return true;
+}
+
+// Move every frame recorded in this backend's ring to the head of its partition, in the order they were accessed.
+// Each partition's lock is taken once for all of its entries. Frames freed since they were recorded are left
+// alone; a frame that was evicted and reused in the meantime is moved for its new page, which is only a stale hint.
+void flush_access_ring(void) {
+	int count = accessRingCount;
+
+	accessRingCount = 0;
+
+	for (int i = 0; i < count; i++) {
+		info* list_info;
+
+		if (accessRing[i] == NIL_FRAME) { // Already applied together with an earlier entry of its partition
+			continue;
+		}
+
+		list_info = PARTITION_OF(accessRing[i]);
+		LWLockAcquire(&list_info->linkedListInfo_lock, LW_EXCLUSIVE);
+
+		for (int j = i; j < count; j++) {
+			node* frame;
+
+			if (accessRing[j] == NIL_FRAME || PARTITION_OF(accessRing[j]) != list_info) {
+				continue;
+			}
+
+			frame = search_for_frame(accessRing[j]);
+			if (frame) {
+				move_to_head(frame);
+			}
+			accessRing[j] = NIL_FRAME;
+		}
+
+		LWLockRelease(&list_info->linkedListInfo_lock);
+	}
+}
+
+// Registered with RegisterXactCallback by record_access, so a backend never sits on recorded accesses past
+// the end of a transaction
+void access_ring_xact_callback(XactEvent event, void* arg) {
+	if (accessRingCount > 0) {
+		flush_access_ring();
+	}
+}
+
+// Victim queue - Function definitions
+
+// Number of entries in the victim queue, lru_victim_queue_size clamped to [0, NBuffers]
+int lru_victim_queue_capacity(void) {
+	return Min(Max(lru_victim_queue_size, 0), NBuffers);
+}
+
+Size victim_queue_shmem_size(int capacity) {
+	return add_size(offsetof(victim_queue, entries), mul_size(sizeof(victim_entry), capacity));
+}
+
+// Walk one partition from its tail, in shared mode, and collect up to 'quota' unpinned frames into 'out'.
+// With 'prefer_clean', clean frames come first so that backends seldom have to write a page out before reusing its
+// buffer, and dirty ones only make up for a shortage of clean ones. Returns the number of frames collected.
+int pick_victims(info* list_info, victim_entry* out, int quota, bool prefer_clean) {
+	victim_entry* dirty = palloc(mul_size(sizeof(victim_entry), quota));
+	int num_picked = 0;
+	int num_dirty = 0;
+	int scan_limit = quota * VICTIM_QUEUE_SCAN_FACTOR;
+
+	LWLockAcquire(&list_info->linkedListInfo_lock, LW_SHARED);
+
+	for (int32 frame_id = list_info->tail; frame_id != NIL_FRAME && num_picked < quota && scan_limit-- > 0; frame_id = doubleLinkedList[frame_id].prev) {
+		uint32 state = pg_atomic_read_u32(&GetBufferDescriptor(frame_id)->state);
+		victim_entry entry = {frame_id, doubleLinkedList[frame_id].promoted_at};
+
+		if (BUF_STATE_GET_REFCOUNT(state) != 0) {
+			continue;
+		}
+
+		if (!prefer_clean || !(state & BM_DIRTY)) {
+			out[num_picked++] = entry;
+		} else if (num_dirty < quota) {
+			dirty[num_dirty++] = entry;
+		}
+	}
+
+	LWLockRelease(&list_info->linkedListInfo_lock);
+
+	for (int i = 0; i < num_dirty && num_picked < quota; i++) {
+		out[num_picked++] = dirty[i];
+	}
+
+	pfree(dirty);
+	return num_picked;
+}
+
+// Collect up to 'max_victims' of the frames closest to eviction into 'out', see pick_victims. The partitions are
+// interleaved from 'start_partition' on, which should be where the next victim search starts, so the result follows
+// the order in which StrategyGetBuffer visits them. Returns the number of frames collected.
+int collect_victims(victim_entry* out, int max_victims, bool prefer_clean, int start_partition) {
+	int quota = (max_victims + numPartitions - 1) / numPartitions;
+	victim_entry* picked = palloc(mul_size(sizeof(victim_entry), mul_size(quota, numPartitions)));
+	int* num_picked = palloc(mul_size(sizeof(int), numPartitions));
+	int num_entries = 0;
+
+	for (int p = 0; p < numPartitions; p++) {
+		num_picked[p] = pick_victims(&linkedListInfo[p].list, &picked[p * quota], quota, prefer_clean);
+	}
+
+	for (int k = 0; k < quota && num_entries < max_victims; k++) {
+		for (int i = 0; i < numPartitions && num_entries < max_victims; i++) {
+			int p = (start_partition + i) % numPartitions;
+
+			if (k < num_picked[p]) {
+				out[num_entries++] = picked[p * quota + k];
+			}
+		}
+	}
+
+	pfree(picked);
+	pfree(num_picked);
+	return num_entries;
+}
+
+// Wake the bgwriter to refill the victim queue, at most once until it has done so
+void request_victim_queue_refill(void) {
+	int bgwprocno = INT_ACCESS_ONCE(victimQueue->bgwprocno);
+
+	if (bgwprocno == -1 || pg_atomic_read_u32(&victimQueue->refill_requested) != 0) {
+		return;
+	}
+
+	if (pg_atomic_exchange_u32(&victimQueue->refill_requested, 1) == 0) {
+		SetLatch(&ProcGlobal->allProcs[bgwprocno].procLatch);
+	}
+}
+
+// Pop entries off the victim queue until one is still good, i.e. its frame is unpinned and has not been moved since
+// it was picked. That frame is moved to where place_victim puts it and returned with its buffer header locked, see
+// claim_victim. Returns NULL once the queue is empty, and then the caller walks the list itself.
+BufferDesc* pop_victim(uint32* buf_state, bool for_ring, uint32 now_ms) {
+	for (;;) {
+		victim_entry entry;
+		victim_entry rival;
+		int remaining;
+		info* list_info;
+		BufferDesc* buf;
+		bool on_probation;
+
+		// Unlocked first look, like the freelist check in StrategyGetBuffer
+		if (victimQueue->count == 0) {
+			request_victim_queue_refill();
+			return NULL;
+		}
+
+		SpinLockAcquire(&victimQueue->victimQueue_spinlock);
+
+		if (victimQueue->count == 0) {
+			SpinLockRelease(&victimQueue->victimQueue_spinlock);
+			continue;
+		}
+
+		entry = victimQueue->entries[victimQueue->head++];
+		remaining = --victimQueue->count;
+
+		SpinLockRelease(&victimQueue->victimQueue_spinlock);
+
+		if (remaining < victimQueue->capacity / VICTIM_QUEUE_LOW_WATER) {
+			request_victim_queue_refill();
+		}
+
+		// The bgwriter picked the frame without regard to admission, so a page on probation may still stay
+		if (admissionFilter) {
+			list_info = PARTITION_OF(entry.buf_id);
+
+			LWLockAcquire(&list_info->linkedListInfo_lock, LW_SHARED);
+			on_probation = find_admission_rival(&entry, &rival);
+			LWLockRelease(&list_info->linkedListInfo_lock);
+
+			if (on_probation && apply_admission(&entry, &rival)) {
+				entry = rival;
+			}
+		}
+
+		buf = claim_victim(&entry, for_ring, now_ms, buf_state);
+		if (buf != NULL) {
+			return buf;
+		}
+	}
+}
+
+// Caller must hold the partition's lock; shared mode is enough
 char* print_list_to_string(info* linkedListInfo) {
     // Initial allocation for the string
     int str_size = 256; // Initial size, may need to increase depending on list size
@@ -127,10 +1009,10 @@ char* print_list_to_string(info* linkedListInfo) {
 
     list_str[0] = '\0'; // Start with an empty string
 
-    node* current = linkedListInfo->head;
+    int32 current = linkedListInfo->head;
     int offset = 0; // Keep track of the number of characters written
 
-    while (current != NULL) {
+    while (current != NIL_FRAME) {
         // Check remaining buffer size and reallocate if necessary
         if (str_size - offset < 50) { // Ensure there's at least 50 chars of space
             str_size *= 2; // Double the buffer size
@@ -142,7 +1024,7 @@ char* print_list_to_string(info* linkedListInfo) {
         }
 
         // Append current node's frame_id to the string
-        int written = snprintf(list_str + offset, str_size - offset, "Frame ID: %d -> ", current->frame_id);
+        int written = snprintf(list_str + offset, str_size - offset, "Frame ID: %d -> ", current);
         if (written > 0) {
             offset += written; // Increase offset by the number of characters written
         } else {
@@ -151,7 +1033,7 @@ char* print_list_to_string(info* linkedListInfo) {
             return NULL;
         }
 
-        current = current->next;
+        current = doubleLinkedList[current].next;
     }
 
     // Optionally, remove the last arrow " -> " for aesthetics
@@ -210,6 +1092,35 @@ typedef struct
 	 * StrategyNotifyBgWriter.
 	 */
 	int			bgwprocno;
+
+	/*
+	 * CS3223: Partition the next victim search starts from, taken modulo the
+	 * number of list partitions.
+	 */
+	pg_atomic_uint32 nextVictimPartition;
+
+	/*
+	 * CS3223: LWLock tranche of the list partition locks, so waits on them
+	 * show up as "LRUList" in pg_stat_activity.
+	 */
+	int			listLockTrancheId;
+
+	/*
+	 * CS3223: Victim search statistics while lru_dirty_lookahead is on.
+	 * Every clean substitution is a write the backend did not have to do;
+	 * dirtyEvictions counts the dirty victims it could not avoid.
+	 */
+	pg_atomic_uint64 cleanSubstitutions;
+	pg_atomic_uint64 dirtyEvictions;
+
+	/*
+	 * CS3223: Buffers recycled by BufferAccessStrategy rings, against
+	 * victims evicted from the list for a ring and for everybody else.
+	 * Freelist allocations are not counted.
+	 */
+	pg_atomic_uint64 ringReuses;
+	pg_atomic_uint64 ringEvictions;
+	pg_atomic_uint64 poolEvictions;
 } BufferStrategyControl;
 
 /* Pointers to shared state */
@@ -339,40 +1250,80 @@ have_free_buffer(void)
 // Called by bufmgr when a buffer page is accessed.
 // Adjusts the position of buffer (identified by buf_id) in the LRU stack if delete is false;
 // otherwise, delete buffer buf_id from the LRU stack.
+// Takes the partition's LWLock.
 void
 StrategyAccessBuffer(int buf_id, bool delete)
 {
+	info* list_info = PARTITION_OF(buf_id);
 	node* frame;
+	uint32 now_ms;
+
+	// CS3223: Every hit counts towards the page's popularity, however the list treats it, see record_frequency. It
+	// also admits a page on probation, even if the frame is not moved below: the caller has it pinned, so victim
+	// search leaves the flag alone and a plain store will do.
+	if (!delete && admissionFilter) {
+		record_frequency(buf_id);
+		doubleLinkedList[buf_id].probation = false;
+	}
+
+	// CS3223: Ring frames only the ring uses stay at the tail, see skip_ring_promotion
+	if (!delete && skip_ring_promotion(buf_id)) {
+		return;
+	}
+
+	// CS3223: Newly loaded pages stay at the midpoint for lru_old_dwell_ms, see old_frame_dwelling
+	if (!delete && old_frame_dwelling(buf_id)) {
+		return;
+	}
+
+	// CS3223: Frames already near the head are left where they are, see skip_promotion
+	if (!delete && skip_promotion(buf_id)) {
+		return;
+	}
+
+	// CS3223: With the access ring enabled, an access is recorded now and applied later, see record_access
+	if (!delete && record_access(buf_id)) {
+		return;
+	}
+
 	if (delete) {
-        SpinLockAcquire(&linkedListInfo->linkedListInfo_spinlock);
-		//elog(LOG, "SpinLOCK A");
-		//log_linked_list(linkedListInfo);
+        LWLockAcquire(&list_info->linkedListInfo_lock, LW_EXCLUSIVE);
 
         delete_arbitrarily(buf_id);
 
-        SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-		//elog(LOG, "SpinRELEASE A");
-		//log_linked_list(linkedListInfo);
+        LWLockRelease(&list_info->linkedListInfo_lock);
     } else {
-		SpinLockAcquire(&linkedListInfo->linkedListInfo_spinlock);
-		//elog(LOG, "SpinLOCK B");
-		//log_linked_list(linkedListInfo);
+		// A frame that is not in the list holds a newly loaded page, which goes to the midpoint with lru_old_percent on.
+		// Read the clock before taking the lock.
+		now_ms = (oldPercent > 0) ? midpoint_clock() : 0;
+
+		LWLockAcquire(&list_info->linkedListInfo_lock, LW_EXCLUSIVE);
 		frame = search_for_frame(buf_id);
 
 		if (frame) {
 			move_to_head(frame);
 		} else {
-			node* new_frame = &doubleLinkedList[buf_id];
-			new_frame->frame_id = buf_id;
-			insert_at_head(new_frame);
+			if (oldPercent > 0) {
+				insert_at_midpoint(&doubleLinkedList[buf_id], now_ms);
+			} else {
+				insert_at_head(&doubleLinkedList[buf_id]);
+			}
+			doubleLinkedList[buf_id].probation = admissionFilter;
 		}
 
-		SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-		//elog(LOG, "SpinRELEASE B");
-		//log_linked_list(linkedListInfo);
+		LWLockRelease(&list_info->linkedListInfo_lock);
 	}
 }
 
+// CS3223 - StrategyAccessPinnedBuffer
+// Called by bufmgr in place of StrategyAccessBuffer for a hit on a buffer the backend already has pinned.
+// LRU treats it as any other hit.
+void
+StrategyAccessPinnedBuffer(int buf_id)
+{
+	StrategyAccessBuffer(buf_id, false);
+}
+
 /*
  * StrategyGetBuffer
  *
@@ -394,28 +1345,54 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
 
 	// CS3223
-	node* traversal_frame;
-	int fetched_frame_id;
-	node *fetched_frame;
+	int32 traversal_frame_id;
+	victim_entry seen;
+	victim_entry rival;
+	bool on_probation;
+	bool substituted;
+	info* list_info;
+	int partition;
+	int partitions_left;
+	uint32 now_ms;
 
 	*from_ring = false;
 
+	// CS3223: Victim selection has to see this backend's recent accesses, so apply its access ring first
+	if (accessRingCount > 0) {
+		flush_access_ring();
+	}
+
 	/*
 	 * If given a strategy object, see whether it can select a buffer. We
 	 * assume strategy objects don't need buffer_strategy_lock.
 	 */
 
-	// CS3223 - We check the freelist first before doing anything (strictly following LRU policy)
-	// if (strategy != NULL)
-	// {
-	// 	buf = GetBufferFromRing(strategy, buf_state);
-	// 	if (buf != NULL)
-	// 	{
-	// 		*from_ring = true;
-	// 		StrategyAccessBuffer(buf->buf_id, false); // cs3223
-	// 		return buf;
-	// 	}
-	// }
+	// CS3223: A recycled ring buffer is not promoted, it stays at the tail with the rest of its ring (see
+	// place_ring_frame). The ring's buffer may have been evicted and used by somebody else since, in which case it is
+	// moved back to the tail first, with the buffer header unlocked, and the buffer checked again. The unlocked look
+	// at the ring flag is only a hint.
+	if (strategy != NULL)
+	{
+		buf = GetBufferFromRing(strategy, buf_state);
+		if (buf != NULL && !doubleLinkedList[buf->buf_id].ring)
+		{
+			UnlockBufHdr(buf, *buf_state);
+			place_ring_frame(buf->buf_id);
+			*buf_state = LockBufHdr(buf);
+			if (BUF_STATE_GET_REFCOUNT(*buf_state) != 0
+				|| BUF_STATE_GET_USAGECOUNT(*buf_state) > 1)
+			{
+				UnlockBufHdr(buf, *buf_state);
+				buf = NULL;
+			}
+		}
+		if (buf != NULL)
+		{
+			*from_ring = true;
+			pg_atomic_fetch_add_u64(&StrategyControl->ringReuses, 1);
+			return buf;
+		}
+	}
 
 	/*
 	 * If asked, we need to waken the bgwriter. Since we don't want to rely on
@@ -494,6 +1471,15 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 			 */
 			SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 
+			//CS3223: Add buffer to the head of the linked list, or to the tail for a ring, before the buffer
+			// header is locked. If the buffer turns out to be unusable below, somebody is using it and it belongs
+			// in the list anyway.
+			if (strategy != NULL) {
+				place_ring_frame(buf->buf_id);                             // Case 2, for a ring
+			} else {
+				StrategyAccessBuffer(buf->buf_id, false);                  // Case 2
+			}
+
 			/*
 			 * If the buffer is pinned or has a nonzero usage_count, we cannot
 			 * use it; discard it and retry.  (This can only happen if VACUUM
@@ -505,17 +1491,8 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
 				&& BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
 			{
-				
-				// SpinLockAcquire(&linkedListInfo->linkedListInfo_spinlock);
-				//elog(LOG, "Case 2");
-				// //log_linked_list(linkedListInfo);
-			
-				// AddBufferToRing(strategy, buf);
-				//CS3223: Add buffer to the head of the linked list
-				StrategyAccessBuffer(buf->buf_id, false);                      // Case 2
-				// SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-				//elog(LOG, "Case 2");
-				////log_linked_list(linkedListInfo);
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
 				*buf_state = local_buf_state;
 				return buf;
 			}
@@ -524,14 +1501,40 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 	}
 
 
+	// CS3223: Nothing on the freelist, so a buffer is evicted from the list. There is no clock hand to sweep, but
+	// ticking it counts evictions, so StrategySyncStart reports how fast the bgwriter has to keep up.
+	(void) ClockSweepTick();
+	pg_atomic_fetch_add_u64(strategy != NULL ? &StrategyControl->ringEvictions : &StrategyControl->poolEvictions, 1);
+
+	// CS3223: The victim gets a newly loaded page, so with lru_old_percent on it goes to the midpoint (see
+	// place_victim). The clock is read here, as the victim is placed with its buffer header locked.
+	now_ms = (oldPercent > 0 && strategy == NULL) ? midpoint_clock() : 0;
+
+	// CS3223: Take a victim the bgwriter picked in advance if there is one
+	if (victimQueue->capacity > 0)
+	{
+		buf = pop_victim(&local_buf_state, strategy != NULL, now_ms);
+		if (buf != NULL)
+		{
+			if (strategy != NULL)
+				AddBufferToRing(strategy, buf);
+			*buf_state = local_buf_state;
+			return buf;
+		}
+	}
+
 	/**************** Nothing on the freelist, so we run the LRU algorithm below ... ****************/
-	// 1. Start from tail
+	// 1. Start from tail of one partition
 	// 2. Traverse to head, while checking for a suitable frame to evict
+	// 3. Move on to the next partition, round-robin, if every frame in this one is pinned
 
-	SpinLockAcquire(&linkedListInfo->linkedListInfo_spinlock);    // Acquire DLL lock
-	//elog(LOG, "SpinLOCK Case 3");
-	//log_linked_list(linkedListInfo);
-	traversal_frame = linkedListInfo->tail;				          // Reset traversal to the tail
+	// Every call starts at the next partition so evictions are spread over all of them
+	partition = (numPartitions > 1) ? pg_atomic_fetch_add_u32(&StrategyControl->nextVictimPartition, 1) % numPartitions : 0;
+	partitions_left = numPartitions;
+	list_info = &linkedListInfo[partition].list;
+
+	LWLockAcquire(&list_info->linkedListInfo_lock, LW_SHARED);    // Acquire DLL lock, walking it only needs shared mode
+	traversal_frame_id = list_info->tail;				      // Reset traversal to the tail
 	trycounter = NBuffers;                                        // NOTE: NBuffers is 16 (as defined by Chee Yong) 
 
 	// Case 3
@@ -543,67 +1546,87 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 		 * it; decrement the usage_count (unless pinned) and keep scanning.
 		 */
 
-		if (traversal_frame == NULL) {
+		if (traversal_frame_id == NIL_FRAME) {
 			// We must have traversed the entire list, or the list is empty
 			// i.e All buffers are pinned
 
+			LWLockRelease(&list_info->linkedListInfo_lock);    // Release the DLL lock we acquired before for(;;)
+
+			if (--partitions_left > 0) {
+				// Only this partition is exhausted, carry on from the tail of the next one
+				partition = (partition + 1) % numPartitions;
+				list_info = &linkedListInfo[partition].list;
+				LWLockAcquire(&list_info->linkedListInfo_lock, LW_SHARED);
+				traversal_frame_id = list_info->tail;
+				continue;
+			}
+
 			// Thus, the result should be similar to Clock Policy (where all frames are pinned, none can be evicted)
 			// We follow their method there
-			traversal_frame = linkedListInfo->tail;				          // Reset traversal to the tail
-			SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);    // Release the DLL spinlock we acquired before for(;;)
 			elog(ERROR, "no unpinned buffers available");                 // Throw an error (and exit)
 		}
 
-		fetched_frame_id = traversal_frame->frame_id;
-		buf = GetBufferDescriptor(fetched_frame_id);
-		local_buf_state = LockBufHdr(buf);
+		buf = GetBufferDescriptor(traversal_frame_id);
 
-		//elog(NOTICE, "fetched_frame is %d", fetched_frame_id);
-		//elog(NOTICE, "RC is %d", BUF_STATE_GET_REFCOUNT(local_buf_state));
+		// Only peek at the refcount here, other backends may be walking the list too
+		local_buf_state = pg_atomic_read_u32(&buf->state);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0) {
+			traversal_frame_id = doubleLinkedList[traversal_frame_id].prev;
+			continue;
+		}
 
-		// Check if the frame_id will be valid below...
-		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-		{
-			//elog(LOG, "Entered: if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0) ");
-			// if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
-			// {
-			// 	local_buf_state -= BUF_USAGECOUNT_ONE;
-			// 	trycounter = NBuffers;
-			// }
-			// else
-			//{
-				/* Found a usable buffer */
-				if (strategy != NULL) {
-					//elog(LOG, "Non-default strategy found a buffer");
-				}
-				// AddBufferToRing(strategy, buf);
+		// A dirty victim would have to be written out by this backend first, so try a clean one close behind it
+		substituted = false;
+		if (lru_dirty_lookahead > 1 && (local_buf_state & BM_DIRTY)) {
+			int32 clean_frame_id = find_clean_victim(list_info, traversal_frame_id);
+
+			if (clean_frame_id != NIL_FRAME) {
+				traversal_frame_id = clean_frame_id;
+				buf = GetBufferDescriptor(traversal_frame_id);
+				substituted = true;
+			}
+		}
+
+		// Looks unpinned. Remember the frame's version (promoted_at changes whenever the frame is moved) and let go of
+		// the list: claim_victim takes the lock back only to move the frame, and locks the buffer header after that, so
+		// no list lock is held across a buffer header lock.
+		seen.buf_id = traversal_frame_id;
+		seen.promoted_at = doubleLinkedList[traversal_frame_id].promoted_at;
+
+		// A page on probation has to beat the frame behind it to stay, see apply_admission
+		on_probation = admissionFilter && find_admission_rival(&seen, &rival);
+
+		LWLockRelease(&list_info->linkedListInfo_lock);
 
-			fetched_frame = search_for_frame(fetched_frame_id);
-			move_to_head(fetched_frame);
-			SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-			//elog(LOG, "SpinRELEASE Case 3 else");
-			//log_linked_list(linkedListInfo);
+		if (on_probation && apply_admission(&seen, &rival)) {
+			seen = rival;
+			substituted = false;
+		}
+
+		buf = claim_victim(&seen, strategy != NULL, now_ms, &local_buf_state);
+		if (buf != NULL) {
+			if (strategy != NULL) {
+				AddBufferToRing(strategy, buf);
+			}
+
+			if (lru_dirty_lookahead > 1) {
+				if (local_buf_state & BM_DIRTY) {
+					pg_atomic_fetch_add_u64(&StrategyControl->dirtyEvictions, 1);
+				} else if (substituted) {
+					pg_atomic_fetch_add_u64(&StrategyControl->cleanSubstitutions, 1);
+				}
+			}
 			*buf_state = local_buf_state;
 			return buf;
-			//}
 		}
-		// else if (--trycounter == 0)
-		// {
-		// 	/*
-		// 	 * We've scanned all the buffers without making any state changes,
-		// 	 * so all the buffers are pinned (or were when we looked at them).
-		// 	 * We could hope that someone will free one eventually, but it's
-		// 	 * probably better to fail than to risk getting stuck in an
-		// 	 * infinite loop.
-		// 	 */
-		// 	UnlockBufHdr(buf, local_buf_state);
-		// 	SpinLockRelease(&linkedListInfo->linkedListInfo_spinlock);
-		// 	elog(LOG, "SpinRELEASE Case 3 elseif");
-		// 	//log_linked_list(linkedListInfo);
-		// 	elog(ERROR, "no unpinned buffers available");
-		// }
-		UnlockBufHdr(buf, local_buf_state);
-		traversal_frame = traversal_frame -> prev;
+
+		// Moved or pinned since we peeked, so where we were in the list means nothing any more. Start again from the
+		// tail, but like the clock sweep give up rather than risk getting stuck in an infinite loop.
+		if (--trycounter == 0) {
+			elog(ERROR, "no unpinned buffers available");
+		}
+		LWLockAcquire(&list_info->linkedListInfo_lock, LW_SHARED);
+		traversal_frame_id = list_info->tail;
 	}
 }
 
@@ -613,9 +1636,11 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 void
 StrategyFreeBuffer(BufferDesc *buf)
 {
+	// Case 4
+	// CS3223: Unlink the frame before it becomes visible on the freelist, and before buffer_strategy_lock is taken
+	StrategyAccessBuffer(buf->buf_id, true);
+
 	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
-	//elog(LOG, "SpinLOCK Case 4");
-	//log_linked_list(linkedListInfo);
 
 	/*
 	 * It is possible that we are told to put something in the freelist that
@@ -627,15 +1652,9 @@ StrategyFreeBuffer(BufferDesc *buf)
 		if (buf->freeNext < 0)
 			StrategyControl->lastFreeBuffer = buf->buf_id;
 		StrategyControl->firstFreeBuffer = buf->buf_id;
-
-
-		// Case 4
-		StrategyAccessBuffer(buf->buf_id, true);
 	}
 
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
-	//elog(LOG, "SpinRELEASE Case 4");
-	//log_linked_list(linkedListInfo);
 }
 
 /*
@@ -648,6 +1667,11 @@ StrategyFreeBuffer(BufferDesc *buf)
  * the higher-order bits of nextVictimBuffer) and the count of recent buffer
  * allocs if non-NULL pointers are passed.  The alloc count is reset after
  * being read.
+ *
+ * CS3223: Here the clock hand only counts evictions from the list (see
+ * StrategyGetBuffer), so the result and pass count tell the bgwriter how
+ * far eviction has got but not which buffers come next; BgBufferSync gets
+ * those from StrategySyncVictims.
  */
 int
 StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
@@ -678,6 +1702,78 @@ StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
 	return result;
 }
 
+// Called by the bgwriter on every round. Replaces the contents of the victim queue with fresh victims from the
+// tails of the partitions, clean ones first.
+void StrategyRefillVictimQueue(void) {
+	int capacity = victimQueue->capacity;
+	int num_entries;
+	victim_entry* picked;
+
+	if (capacity == 0) {
+		return;
+	}
+
+	victimQueue->bgwprocno = MyProc->pgprocno;
+
+	picked = palloc(mul_size(sizeof(victim_entry), capacity));
+	num_entries = collect_victims(picked, capacity, true, pg_atomic_read_u32(&StrategyControl->nextVictimPartition) % numPartitions);
+
+	SpinLockAcquire(&victimQueue->victimQueue_spinlock);
+	memcpy(victimQueue->entries, picked, mul_size(sizeof(victim_entry), num_entries));
+	victimQueue->head = 0;
+	victimQueue->count = num_entries;
+	SpinLockRelease(&victimQueue->victimQueue_spinlock);
+
+	pg_atomic_write_u32(&victimQueue->refill_requested, 0);
+
+	pfree(picked);
+}
+
+// CS3223: The bgwriter's counterpart of StrategySyncStart for the list engines, which have no clock hand to sweep
+// from. Fills 'buf_ids' with up to 'max_buffers' unpinned buffers in the order they will be evicted (partition
+// tails first), so that BgBufferSync can write out the dirty ones before a backend has to. Returns the number of
+// buffers filled in.
+int StrategySyncVictims(int* buf_ids, int max_buffers) {
+	victim_entry* victims;
+	int num_victims;
+
+	if (max_buffers <= 0) {
+		return 0;
+	}
+
+	victims = palloc(mul_size(sizeof(victim_entry), max_buffers));
+	num_victims = collect_victims(victims, max_buffers, false, pg_atomic_read_u32(&StrategyControl->nextVictimPartition) % numPartitions);
+
+	for (int i = 0; i < num_victims; i++) {
+		buf_ids[i] = victims[i].buf_id;
+	}
+
+	pfree(victims);
+	return num_victims;
+}
+
+// CS3223: Victim search statistics for lru_dirty_lookahead, reported by pg_stat_get_buf_clean_substitutions() and
+// pg_stat_get_buf_dirty_evictions() (see bufmgr.patch)
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions) {
+	*clean_substitutions = pg_atomic_read_u64(&StrategyControl->cleanSubstitutions);
+	*dirty_evictions = pg_atomic_read_u64(&StrategyControl->dirtyEvictions);
+}
+
+// CS3223: Ring reuse against main pool evictions, reported by pg_stat_get_buf_ring_reuses(),
+// pg_stat_get_buf_ring_evictions() and pg_stat_get_buf_pool_evictions() (see bufmgr.patch)
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions) {
+	*ring_reuses = pg_atomic_read_u64(&StrategyControl->ringReuses);
+	*ring_evictions = pg_atomic_read_u64(&StrategyControl->ringEvictions);
+	*pool_evictions = pg_atomic_read_u64(&StrategyControl->poolEvictions);
+}
+
+// CS3223: Admission filter decisions for lru_admission_filter, reported by pg_stat_get_buf_admissions() and
+// pg_stat_get_buf_rejections() (see bufmgr.patch)
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections) {
+	*admissions = pg_atomic_read_u64(&admissionSketch->admissions);
+	*rejections = pg_atomic_read_u64(&admissionSketch->rejections);
+}
+
 /*
  * StrategyNotifyBgWriter -- set or clear allocation notification latch
  *
@@ -697,6 +1793,13 @@ StrategyNotifyBgWriter(int bgwprocno)
 	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
 	StrategyControl->bgwprocno = bgwprocno;
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+	/*
+	 * CS3223: Unlike bgwprocno, which is cleared once used, the victim queue
+	 * keeps the bgwriter so that it can wake it whenever the queue runs low.
+	 */
+	if (bgwprocno != -1)
+		victimQueue->bgwprocno = bgwprocno;
 }
 
 
@@ -719,11 +1822,17 @@ StrategyShmemSize(void)
 	/* size of the shared replacement strategy control block */
 	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
 
-	// CS3223: Allocate size for our data structures in FREE-LIST
-	size = add_size(size, sizeof(node) * (NBuffers + NUM_BUFFER_PARTITIONS));
+	// CS3223: Allocate size for our data structures in FREE-LIST, one node per buffer
+	size = add_size(size, mul_size(sizeof(node), NBuffers));
+
+	//Size of the control information of double link list, one per partition
+	size = add_size(size, mul_size(sizeof(info_padded), lru_partition_count()));
+
+	// Victim queue
+	size = add_size(size, victim_queue_shmem_size(lru_victim_queue_capacity()));
 
-	//Size of the control information of double link list
-	size = add_size(size, sizeof(info));
+	// Admission sketch
+	size = add_size(size, admission_sketch_shmem_size(admission_sketch_width()));
 
 	return size;
 }
@@ -743,6 +1852,8 @@ StrategyInitialize(bool init)
 	// CS3223: Boolean values for if shared memory alloc is successful
 	bool is_dll_success = false;
 	bool is_link_list_info_success = false;
+	bool is_victim_queue_success = false;
+	bool is_sketch_success = false;
 
 	/*
 	 * Initialize the shared buffer lookup hashtable.
@@ -766,16 +1877,32 @@ StrategyInitialize(bool init)
 
 
 	// CS3223: Initialize space for our data structures
-	// Linked List Info
-	linkedListInfo = (info *)ShmemInitStruct("Link List Info",
-												sizeof(info),
+	// lru_num_partitions is PGC_POSTMASTER, so every backend arrives at the same partition count
+	numPartitions = lru_partition_count();
+	// lru_old_percent is PGC_POSTMASTER too, the old sublists are sized by it
+	oldPercent = Min(Max(lru_old_percent, 0), 95);
+
+	// Linked List Info, one per partition
+	linkedListInfo = (info_padded *)ShmemInitStruct("Link List Info",
+												mul_size(sizeof(info_padded), numPartitions),
 												&is_link_list_info_success);
 
 	// Double Linked List itself
 	doubleLinkedList = (node *)ShmemInitStruct("Double Link List",
-														sizeof(node) * (NBuffers + NUM_BUFFER_PARTITIONS),
+														mul_size(sizeof(node), NBuffers),
 														&is_dll_success);
 
+	// Victim queue, lru_victim_queue_size is PGC_POSTMASTER as well
+	victimQueue = (victim_queue *)ShmemInitStruct("Victim Queue",
+												victim_queue_shmem_size(lru_victim_queue_capacity()),
+												&is_victim_queue_success);
+
+	// Admission sketch, lru_admission_filter is PGC_POSTMASTER too
+	admissionFilter = lru_admission_filter;
+	admissionSketch = (admission_sketch *)ShmemInitStruct("Admission Sketch",
+												admission_sketch_shmem_size(admission_sketch_width()),
+												&is_sketch_success);
+
 	if (!found)
 	{
 		/*
@@ -801,18 +1928,71 @@ StrategyInitialize(bool init)
 
 		/* No pending notification */
 		StrategyControl->bgwprocno = -1;
+
+		/* CS3223: Victim search starts at the first list partition */
+		pg_atomic_init_u32(&StrategyControl->nextVictimPartition, 0);
+
+		/* CS3223: Clear victim search statistics */
+		pg_atomic_init_u64(&StrategyControl->cleanSubstitutions, 0);
+		pg_atomic_init_u64(&StrategyControl->dirtyEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->ringReuses, 0);
+		pg_atomic_init_u64(&StrategyControl->ringEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->poolEvictions, 0);
+
+		/* CS3223: One tranche shared by all list partition locks */
+		StrategyControl->listLockTrancheId = LWLockNewTrancheId();
 	}
 	else
 		Assert(!init);
 
+	// CS3223: Tranche names are backend-local, so every backend registers it
+	LWLockRegisterTranche(StrategyControl->listLockTrancheId, "LRUList");
+
 	// CS3223: Intialize our DLL Data Structure
 	if (!is_dll_success && !is_link_list_info_success) { //Initiate our Double Link List Data Structure here
 		Assert (init);
-		SpinLockInit(&linkedListInfo->linkedListInfo_spinlock);
+		for (int p = 0; p < numPartitions; p++) {
+			LWLockInitialize(&linkedListInfo[p].list.linkedListInfo_lock, StrategyControl->listLockTrancheId);
+
+			linkedListInfo[p].list.head = NIL_FRAME;
+			linkedListInfo[p].list.tail = NIL_FRAME;
+			linkedListInfo[p].list.size = 0;
+			linkedListInfo[p].list.promotions = 0;
+			linkedListInfo[p].list.old_head = NIL_FRAME;
+			linkedListInfo[p].list.old_size = 0;
+		}
+
+		// An all-zero node is a valid unlinked node (list is LIST_NONE, prev/next are only read while linked)
+		memset(doubleLinkedList, 0, mul_size(sizeof(node), NBuffers));
+	} else
+		Assert(!init);
+
+	// CS3223: The victim queue starts empty, the bgwriter fills it on its first round
+	if (!is_victim_queue_success) {
+		Assert (init);
+		SpinLockInit(&victimQueue->victimQueue_spinlock);
+		victimQueue->head = 0;
+		victimQueue->count = 0;
+		victimQueue->capacity = lru_victim_queue_capacity();
+		victimQueue->bgwprocno = -1;
+		pg_atomic_init_u32(&victimQueue->refill_requested, 0);
+	} else
+		Assert(!init);
+
+	// CS3223: The admission sketch starts out knowing no page
+	if (!is_sketch_success) {
+		uint32 width = admission_sketch_width();
+		Size num_words = (admission_sketch_shmem_size(width) - offsetof(admission_sketch, words)) / sizeof(pg_atomic_uint64);
 
-		linkedListInfo->tail = NULL;
-		linkedListInfo->size = 0;
-		linkedListInfo->head = doubleLinkedList;
+		Assert (init);
+		admissionSketch->width = width;
+		admissionSketch->sample_size = width * SKETCH_SAMPLE_FACTOR;
+		pg_atomic_init_u32(&admissionSketch->samples, 0);
+		pg_atomic_init_u64(&admissionSketch->admissions, 0);
+		pg_atomic_init_u64(&admissionSketch->rejections, 0);
+		for (Size i = 0; i < num_words; i++) {
+			pg_atomic_init_u64(&admissionSketch->words[i], 0);
+		}
 	} else
 		Assert(!init);
 }
@@ -1062,5 +2242,8 @@ StrategyRejectBuffer(BufferAccessStrategy strategy, BufferDesc *buf, bool from_r
 	 */
 	strategy->buffers[strategy->current] = InvalidBuffer;
 
+	/* CS3223: It stays at the tail of the list, but is no longer the ring's */
+	release_ring_frame(buf->buf_id);
+
 	return true;
 }
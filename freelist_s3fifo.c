@@ -0,0 +1,1387 @@
+/*-------------------------------------------------------------------------
+ *
+ * freelist.c
+ *	  routines for managing the buffer pool's replacement strategy.
+ *
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/freelist.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "port/pg_bitutils.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/proc.h"
+
+#include <assert.h>
+
+#define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
+
+/*********************************************/
+// CS3223 - Data Structure declarations
+
+// S3-FIFO (Yang, Zhang, Qiu, Yue & Rashmi) keeps every resident frame in one of two FIFO queues:
+//   small - probation for newly loaded pages, about a tenth of the pool
+//   main  - pages that were referenced while in small, or came back while small still remembered them
+// and remembers the tags of pages recently evicted from small in the ghost queue, a FIFO that holds no frames.
+// Neither queue is reordered on a hit: a hit only bumps the frequency of its frame, a 2-bit counter, and the queues
+// are sorted out at eviction time instead. The page at the tail of small moves to main if it was referenced since it
+// was loaded, and is evicted (leaving a ghost) otherwise; the page at the tail of main goes back to the head of main
+// with its frequency decremented, until it reaches 0 and is evicted. Victims come from small while it holds more than
+// its share of the pool, from main otherwise. Most pages that are only used once, a scan's in particular, leave from
+// small without ever getting to main.
+//
+// So a hit takes no lock: StrategyAccessBuffer is a compare-and-swap on the frequency word of the frame, which the
+// caller has pinned and eviction therefore leaves alone. The list lock is only taken to link a buffer from the
+// freelist into small, to unlink one going back to the freelist, and on the first hit of a newly loaded page:
+// StrategyGetBuffer does not know which page the victim will hold, so a newly loaded page always enters small (as a
+// fresh frame), and the ghost queue is looked up on its first hit, or when it comes up for eviction if it has none,
+// instead of when it is loaded.
+
+// List membership tag for every node, so a frame can be found by buf_id in O(1)
+#define LIST_NONE 0
+#define LIST_SMALL 1
+#define LIST_MAIN 2
+
+// Frequency word of every frame
+#define S3FIFO_FREQ_MASK 0x03              // References since the frame was loaded, or since eviction last passed it
+#define S3FIFO_FRESH 0x04                  // In small and not hit since its page was loaded
+
+// Nodes are linked by buf_id (32 bits) instead of by pointer. NIL_FRAME also ends the ghost hash chains.
+#define NIL_FRAME (-1)
+#define FRAME_ID(frame) ((int32) ((frame) - doubleLinkedList))
+
+typedef struct node {
+	int32 prev;                        // buf_id of the previous node, or NIL_FRAME
+	int32 next;                        // buf_id of the next node, or NIL_FRAME
+	uint8 list;                        // LIST_NONE, LIST_SMALL or LIST_MAIN
+} node;
+
+typedef struct info {
+	int32 head;                        // buf_id of the head node, or NIL_FRAME
+	int32 tail;                        // buf_id of the tail node, or NIL_FRAME
+	int size;
+} info;
+
+// Ghost queue entry. Ghosts are kept in a ring of slots in FIFO order; a slot is reused once the ring comes round to
+// it again, which drops the oldest ghost. Ghosts are also chained by hash of their tag, so a lookup is O(1).
+typedef struct ghost_entry {
+	BufferTag tag;
+	int32 hash_next;                   // Slot of the next ghost in the same hash bucket, or NIL_FRAME
+	bool valid;                        // False while the slot is unused, or once its ghost was referenced
+} ghost_entry;
+
+typedef struct s3fifo_info {
+	info small;                        // Head is the most recently loaded page
+	info main;                         // Head is the page most recently promoted or passed over
+	int small_target;                  // Small is evicted from first while it holds more frames than this
+	int ghost_capacity;                // Number of ghost slots, 0 if the ghost queue is off
+	int ghost_next;                    // Slot the next ghost goes into
+	int ghost_size;                    // Valid ghosts
+	uint32 num_buckets;                // Power of two, at least ghost_capacity
+	LWLock list_lock;                  // Exclusive to change small, main or the ghosts, shared to walk small or main
+} s3fifo_info;
+
+static node* doubleLinkedList = NULL;         // Indexed by buf_id, NBuffers nodes shared by small and main
+static s3fifo_info* s3fifo = NULL;
+static pg_atomic_uint32* frameFreq = NULL;    // Indexed by buf_id, frequency and S3FIFO_FRESH
+static ghost_entry* ghosts = NULL;            // Ghost queue, ghost_capacity slots
+static int32* ghostBuckets = NULL;            // Ghost hash buckets, num_buckets heads of slot chains
+
+// CS3223: The GUCs below are defined in bufmgr.c, see the GUCs in freelist_lru.c
+
+// CS3223 - GUC (PGC_POSTMASTER): percentage of NBuffers that small may hold before victims are taken from it rather
+// than from main. The S3-FIFO paper recommends 10.
+extern PGDLLIMPORT int s3fifo_small_percent;
+
+// CS3223 - GUC (PGC_POSTMASTER): number of ghosts remembered, as a percentage of NBuffers. The S3-FIFO paper sizes the
+// ghost queue like main, hence 90. 0 turns the ghost queue off, and then only pages referenced in small get to main.
+extern PGDLLIMPORT int s3fifo_ghost_percent;
+
+int s3fifo_small_target(void);
+int s3fifo_ghost_capacity(void);
+uint32 s3fifo_num_buckets(int capacity);
+void unlink_frame(info* list_info, node* frame);
+void insert_at_head(info* list_info, node* frame);
+info* list_of(node* frame);
+uint32 frame_freq(int32 frame_id);
+uint32 ghost_bucket_of(const BufferTag* tag);
+void ghost_unlink(int slot);
+void ghost_insert(const BufferTag* tag);
+bool ghost_remove(const BufferTag* tag);
+bool claim_victim(int32 frame_id, uint32* buf_state);
+void pass_over(int32 frame_id);
+int sync_victims_from(info* list_info, int32* frame_id, int* buf_ids, int num_buffers, int max_buffers);
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions);
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions);
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections);
+
+/*********************************************/
+// CS3223 - Function definitions
+
+// s3fifo_small_percent of NBuffers, at least 1
+int s3fifo_small_target(void) {
+	return Max((int) ((int64) NBuffers * Min(Max(s3fifo_small_percent, 0), 100) / 100), 1);
+}
+
+// s3fifo_ghost_percent of NBuffers. The ghost queue may remember more pages than fit in the pool, up to 4 times
+// NBuffers.
+int s3fifo_ghost_capacity(void) {
+	return (int) ((int64) NBuffers * Min(Max(s3fifo_ghost_percent, 0), 400) / 100);
+}
+
+uint32 s3fifo_num_buckets(int capacity) {
+	return pg_nextpower2_32((uint32) Max(capacity, 1));
+}
+
+// Unlink a frame from small or main in O(1)
+void unlink_frame(info* list_info, node* frame) {
+	if (frame->prev != NIL_FRAME) {
+		doubleLinkedList[frame->prev].next = frame->next;
+	} else {
+		list_info->head = frame->next;
+	}
+
+	if (frame->next != NIL_FRAME) {
+		doubleLinkedList[frame->next].prev = frame->prev;
+	} else {
+		list_info->tail = frame->prev;
+	}
+
+	frame->prev = NIL_FRAME;
+	frame->next = NIL_FRAME;
+	frame->list = LIST_NONE;
+	list_info->size--;
+}
+
+// Link a frame (which must not be in small or main) at the head of small or main
+void insert_at_head(info* list_info, node* frame) {
+	Assert(frame->list == LIST_NONE);
+
+	frame->prev = NIL_FRAME;
+	frame->next = list_info->head;
+	if (list_info->head != NIL_FRAME) { // Check if list is not empty
+		doubleLinkedList[list_info->head].prev = FRAME_ID(frame);
+	}
+	list_info->head = FRAME_ID(frame);
+
+	if (list_info->tail == NIL_FRAME) { // If list was empty, update tail as well
+		list_info->tail = FRAME_ID(frame);
+	}
+
+	frame->list = (list_info == &s3fifo->small) ? LIST_SMALL : LIST_MAIN;
+	list_info->size++;
+}
+
+info* list_of(node* frame) {
+	return (frame->list == LIST_SMALL) ? &s3fifo->small : &s3fifo->main;
+}
+
+// References the frame has had since it was loaded, or since eviction last passed it over
+uint32 frame_freq(int32 frame_id) {
+	return pg_atomic_read_u32(&frameFreq[frame_id]) & S3FIFO_FREQ_MASK;
+}
+
+// Ghost queue - Function definitions. All of them are called with list_lock held exclusively.
+
+uint32 ghost_bucket_of(const BufferTag* tag) {
+	return BufTableHashCode((BufferTag*) tag) & (s3fifo->num_buckets - 1);
+}
+
+// Take the ghost in 'slot' off its hash chain. Chains are about one ghost long, as there are at least as many buckets
+// as slots.
+void ghost_unlink(int slot) {
+	int32* link = &ghostBuckets[ghost_bucket_of(&ghosts[slot].tag)];
+
+	while (*link != slot) {
+		Assert(*link != NIL_FRAME);
+		link = &ghosts[*link].hash_next;
+	}
+
+	*link = ghosts[slot].hash_next;
+	ghosts[slot].valid = false;
+	s3fifo->ghost_size--;
+}
+
+// Remember the tag of a page evicted from small, dropping the oldest ghost if the ghost queue is full. The page may
+// already have a ghost, if it was loaded again and evicted before its first hit; that ghost is dropped in favour of
+// the new one.
+void ghost_insert(const BufferTag* tag) {
+	int slot;
+	uint32 bucket;
+
+	if (s3fifo->ghost_capacity == 0) {
+		return;
+	}
+
+	(void) ghost_remove(tag);
+
+	slot = s3fifo->ghost_next;
+	s3fifo->ghost_next = (slot + 1) % s3fifo->ghost_capacity;
+
+	if (ghosts[slot].valid) {
+		ghost_unlink(slot);
+	}
+
+	bucket = ghost_bucket_of(tag);
+	ghosts[slot].tag = *tag;
+	ghosts[slot].valid = true;
+	ghosts[slot].hash_next = ghostBuckets[bucket];
+	ghostBuckets[bucket] = slot;
+	s3fifo->ghost_size++;
+}
+
+// Look up a page in the ghost queue. A ghost that is found is removed, as its page is resident again.
+bool ghost_remove(const BufferTag* tag) {
+	if (s3fifo->ghost_capacity == 0) {
+		return false;
+	}
+
+	for (int32 slot = ghostBuckets[ghost_bucket_of(tag)]; slot != NIL_FRAME; slot = ghosts[slot].hash_next) {
+		if (BufferTagsEqual(&ghosts[slot].tag, tag)) {
+			ghost_unlink(slot);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Try to evict 'frame_id' from the tail of small or main. Called with list_lock held exclusively, which the caller
+// keeps; the buffer header may be locked under it (an LWLock may be held across a buffer header lock, never the
+// other way round). The refcount is peeked at first, so a pinned frame costs no header lock. A fresh frame whose page
+// had a ghost came back while small still remembered it, so it is promoted to main instead of being evicted, and
+// false is returned. Otherwise, if the frame is unpinned, the tag of a page leaving small goes to the ghost queue
+// (read under the header lock, as only that keeps it stable), the frame becomes a fresh frame at the head of small,
+// and true is returned with the buffer header locked. Nobody can hit an unpinned frame while its header is locked, so
+// its frequency word may simply be overwritten.
+bool claim_victim(int32 frame_id, uint32* buf_state) {
+	node* frame = &doubleLinkedList[frame_id];
+	BufferDesc* buf = GetBufferDescriptor(frame_id);
+	uint32 local_buf_state;
+
+	if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf->state)) != 0) {
+		return false;
+	}
+
+	local_buf_state = LockBufHdr(buf);
+
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0) {
+		UnlockBufHdr(buf, local_buf_state);
+		return false;
+	}
+
+	if ((pg_atomic_read_u32(&frameFreq[frame_id]) & S3FIFO_FRESH) && (local_buf_state & BM_TAG_VALID)
+		&& ghost_remove(&buf->tag)) {
+		pg_atomic_write_u32(&frameFreq[frame_id], 0);
+		UnlockBufHdr(buf, local_buf_state);
+		unlink_frame(&s3fifo->small, frame);
+		insert_at_head(&s3fifo->main, frame);
+		return false;
+	}
+
+	if (frame->list == LIST_SMALL && (local_buf_state & BM_TAG_VALID)) {
+		ghost_insert(&buf->tag);
+	}
+
+	unlink_frame(list_of(frame), frame);
+	insert_at_head(&s3fifo->small, frame);
+	pg_atomic_write_u32(&frameFreq[frame_id], S3FIFO_FRESH);
+
+	*buf_state = local_buf_state;
+	return true;
+}
+
+// Called with list_lock held exclusively for the frame at the tail of small or main that eviction does not take: a
+// frame that was referenced, or is pinned. A referenced frame in small is promoted to main, and starts over there
+// with no references; one in main goes back to the head of main with one reference less. A pinned frame that was not
+// referenced goes back to the head of its own queue, as if it had been. The frequency word is changed atomically, as
+// backends that have the frame pinned may be hitting it meanwhile.
+void pass_over(int32 frame_id) {
+	node* frame = &doubleLinkedList[frame_id];
+	pg_atomic_uint32* frame_freq = &frameFreq[frame_id];
+	uint32 old_freq = pg_atomic_read_u32(frame_freq);
+	uint32 new_freq;
+
+	if (frame->list == LIST_SMALL) {
+		if (old_freq & S3FIFO_FREQ_MASK) {
+			(void) pg_atomic_fetch_and_u32(frame_freq, ~S3FIFO_FREQ_MASK);
+			unlink_frame(&s3fifo->small, frame);
+			insert_at_head(&s3fifo->main, frame);
+		} else {
+			unlink_frame(&s3fifo->small, frame);
+			insert_at_head(&s3fifo->small, frame);
+		}
+		return;
+	}
+
+	do {
+		if ((old_freq & S3FIFO_FREQ_MASK) == 0) {
+			break;
+		}
+		new_freq = old_freq - 1;
+	} while (!pg_atomic_compare_exchange_u32(frame_freq, &old_freq, new_freq));
+
+	unlink_frame(&s3fifo->main, frame);
+	insert_at_head(&s3fifo->main, frame);
+}
+
+// Called by StrategySyncVictims with list_lock held in shared mode. Walks 'list_info' from '*frame_id' towards the
+// head and appends unpinned frames with no references to 'buf_ids' until it holds 'max_buffers' of them. '*frame_id'
+// is left where the walk stopped, so that it can be resumed. Returns the new number of buffers in 'buf_ids'.
+int sync_victims_from(info* list_info, int32* frame_id, int* buf_ids, int num_buffers, int max_buffers) {
+	while (*frame_id != NIL_FRAME && num_buffers < max_buffers) {
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&GetBufferDescriptor(*frame_id)->state)) == 0
+			&& frame_freq(*frame_id) == 0) {
+			buf_ids[num_buffers++] = *frame_id;
+		}
+		*frame_id = doubleLinkedList[*frame_id].prev;
+	}
+
+	return num_buffers;
+}
+
+/*********************************************/
+
+
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/* Spinlock: protects the values below */
+	slock_t		buffer_strategy_lock;
+
+	/*
+	 * Clock sweep hand: index of next buffer to consider grabbing. Note that
+	 * this isn't a concrete buffer - we only ever increase the value. So, to
+	 * get an actual buffer, it needs to be used modulo NBuffers.
+	 */
+	pg_atomic_uint32 nextVictimBuffer;
+
+	int			firstFreeBuffer;	/* Head of list of unused buffers */
+	int			lastFreeBuffer; /* Tail of list of unused buffers */
+
+	/*
+	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
+	 * when the list is empty)
+	 */
+
+	/*
+	 * Statistics.  These counters should be wide enough that they can't
+	 * overflow during a single bgwriter cycle.
+	 */
+	uint32		completePasses; /* Complete cycles of the clock sweep */
+	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
+
+	/*
+	 * Bgworker process to be notified upon activity or -1 if none. See
+	 * StrategyNotifyBgWriter.
+	 */
+	int			bgwprocno;
+
+	/*
+	 * CS3223: LWLock tranche of list_lock, so waits on it show up as
+	 * "S3FIFOList" in pg_stat_activity.
+	 */
+	int			listLockTrancheId;
+
+	/*
+	 * CS3223: Buffers recycled by BufferAccessStrategy rings, against
+	 * victims evicted from small or main for a ring and for everybody else.
+	 * Freelist allocations are not counted.
+	 */
+	pg_atomic_uint64 ringReuses;
+	pg_atomic_uint64 ringEvictions;
+	pg_atomic_uint64 poolEvictions;
+} BufferStrategyControl;
+
+/* Pointers to shared state */
+static BufferStrategyControl *StrategyControl = NULL;
+
+/*
+ * Private (non-shared) state for managing a ring of shared buffers to re-use.
+ * This is currently the only kind of BufferAccessStrategy object, but someday
+ * we might have more kinds.
+ */
+typedef struct BufferAccessStrategyData
+{
+	/* Overall strategy type */
+	BufferAccessStrategyType btype;
+	/* Number of elements in buffers[] array */
+	int			nbuffers;
+
+	/*
+	 * Index of the "current" slot in the ring, ie, the one most recently
+	 * returned by GetBufferFromRing.
+	 */
+	int			current;
+
+	/*
+	 * Array of buffer numbers.  InvalidBuffer (that is, zero) indicates we
+	 * have not yet selected a buffer for this ring slot.  For allocation
+	 * simplicity this is palloc'd together with the fixed fields of the
+	 * struct.
+	 */
+	Buffer		buffers[FLEXIBLE_ARRAY_MEMBER];
+}			BufferAccessStrategyData;
+
+
+void StrategyAccessBuffer(int buf_id, bool delete); /* cs3223 */
+
+/* Prototypes for internal functions */
+static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
+									 uint32 *buf_state);
+static void AddBufferToRing(BufferAccessStrategy strategy,
+							BufferDesc *buf);
+
+/*
+ * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ *
+ * Move the clock hand one buffer ahead of its current position and return the
+ * id of the buffer now under the hand.
+ */
+static inline uint32
+ClockSweepTick(void)
+{
+	uint32		victim;
+
+	/*
+	 * Atomically move hand ahead one buffer - if there's several processes
+	 * doing this, this can lead to buffers being returned slightly out of
+	 * apparent order.
+	 */
+	victim =
+		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+
+	if (victim >= NBuffers)
+	{
+		uint32		originalVictim = victim;
+
+		/* always wrap what we look up in BufferDescriptors */
+		victim = victim % NBuffers;
+
+		/*
+		 * If we're the one that just caused a wraparound, force
+		 * completePasses to be incremented while holding the spinlock. We
+		 * need the spinlock so StrategySyncStart() can return a consistent
+		 * value consisting of nextVictimBuffer and completePasses.
+		 */
+		if (victim == 0)
+		{
+			uint32		expected;
+			uint32		wrapped;
+			bool		success = false;
+
+			expected = originalVictim + 1;
+
+			while (!success)
+			{
+				/*
+				 * Acquire the spinlock while increasing completePasses. That
+				 * allows other readers to read nextVictimBuffer and
+				 * completePasses in a consistent manner which is required for
+				 * StrategySyncStart().  In theory delaying the increment
+				 * could lead to an overflow of nextVictimBuffers, but that's
+				 * highly unlikely and wouldn't be particularly harmful.
+				 */
+				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+				wrapped = expected % NBuffers;
+
+				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+														 &expected, wrapped);
+				if (success)
+					StrategyControl->completePasses++;
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+			}
+		}
+	}
+	return victim;
+}
+
+/*
+ * have_free_buffer -- a lockless check to see if there is a free buffer in
+ *					   buffer pool.
+ *
+ * If the result is true that will become stale once free buffers are moved out
+ * by other operations, so the caller who strictly want to use a free buffer
+ * should not call this.
+ */
+bool
+have_free_buffer(void)
+{
+	if (StrategyControl->firstFreeBuffer >= 0)
+		return true;
+	else
+		return false;
+}
+
+
+
+// cs3223
+// StrategyAccessBuffer 
+// Called by bufmgr when a buffer page is accessed.
+// Counts a reference to buffer buf_id if delete is false; otherwise, removes buffer buf_id from small or main.
+// A hit takes no lock. The first hit of a newly loaded page, a buffer just taken from the freelist and delete take
+// list_lock, so the caller must not hold a buffer header lock or any other spinlock.
+void
+StrategyAccessBuffer(int buf_id, bool delete)
+{
+	node* frame = &doubleLinkedList[buf_id];
+	pg_atomic_uint32* frame_freq = &frameFreq[buf_id];
+	uint32 old_freq;
+	uint32 new_freq;
+
+	// CS3223: A hit on a frame in small or main. The caller has it pinned, so eviction leaves it in its queue and only
+	// its frequency word needs changing. The unlocked look at its list is only there to tell a hit from a buffer just
+	// taken from the freelist, which is in no queue; nothing but the caller of Case 2 has that buffer.
+	if (!delete && frame->list != LIST_NONE) {
+		old_freq = pg_atomic_read_u32(frame_freq);
+		do {
+			// Saturated. A fresh frame never is, as it has had no reference yet.
+			if ((old_freq & S3FIFO_FREQ_MASK) == S3FIFO_FREQ_MASK) {
+				return;
+			}
+			new_freq = (old_freq & ~S3FIFO_FRESH) + 1;
+		} while (!pg_atomic_compare_exchange_u32(frame_freq, &old_freq, new_freq));
+
+		// Another backend that pinned the same page may have got here too; only the one that cleared the flag goes on
+		if (!(old_freq & S3FIFO_FRESH)) {
+			return;
+		}
+	}
+
+	LWLockAcquire(&s3fifo->list_lock, LW_EXCLUSIVE);
+
+	if (delete) {
+		if (frame->list != LIST_NONE) {
+			unlink_frame(list_of(frame), frame);
+		}
+		pg_atomic_write_u32(frame_freq, 0);
+	} else if (frame->list == LIST_NONE) {
+		// Not in small or main: a buffer just taken from the freelist
+		insert_at_head(&s3fifo->small, frame);
+		pg_atomic_write_u32(frame_freq, S3FIFO_FRESH);
+	} else if (frame->list == LIST_SMALL && ghost_remove(&GetBufferDescriptor(buf_id)->tag)) {
+		// First hit of the page since it was loaded, and it was evicted from small not long ago. The caller has it
+		// pinned, so its tag is stable. Eviction may have promoted it in the meantime, and then it stays where it is.
+		unlink_frame(&s3fifo->small, frame);
+		insert_at_head(&s3fifo->main, frame);
+	}
+
+	LWLockRelease(&s3fifo->list_lock);
+}
+
+// CS3223 - StrategyAccessPinnedBuffer
+// Called by bufmgr in place of StrategyAccessBuffer for a hit on a buffer the backend already has pinned.
+// S3-FIFO treats it as any other hit.
+void
+StrategyAccessPinnedBuffer(int buf_id)
+{
+	StrategyAccessBuffer(buf_id, false);
+}
+
+/*
+ * StrategyGetBuffer
+ *
+ *	Called by the bufmgr to get the next candidate buffer to use in
+ *	BufferAlloc(). The only hard requirement BufferAlloc() has is that
+ *	the selected buffer must not currently be pinned by anyone.
+ *
+ *	strategy is a BufferAccessStrategy object, or NULL for default strategy.
+ *
+ *	To ensure that no one else can pin the buffer before we do, we must
+ *	return the buffer with the buffer header spinlock still held.
+ */
+BufferDesc *
+StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_ring)
+{
+	BufferDesc *buf;
+	int			bgwprocno;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+	// CS3223
+	info* list_info;
+	int32 frame_id;
+	int small_passed = 0;
+	int main_passed = 0;
+
+	*from_ring = false;
+
+	/*
+	 * If given a strategy object, see whether it can select a buffer. We
+	 * assume strategy objects don't need buffer_strategy_lock.
+	 */
+
+	// CS3223: A recycled ring buffer stays wherever it is. Its new page has had no reference yet, and the ring's
+	// pages are evicted from small without reaching main unless something else references them.
+	if (strategy != NULL)
+	{
+		buf = GetBufferFromRing(strategy, buf_state);
+		if (buf != NULL)
+		{
+			*from_ring = true;
+			pg_atomic_fetch_add_u64(&StrategyControl->ringReuses, 1);
+			return buf;
+		}
+	}
+
+	/*
+	 * If asked, we need to waken the bgwriter. Since we don't want to rely on
+	 * a spinlock for this we force a read from shared memory once, and then
+	 * set the latch based on that value. We need to go through that length
+	 * because otherwise bgwprocno might be reset while/after we check because
+	 * the compiler might just reread from memory.
+	 *
+	 * This can possibly set the latch of the wrong process if the bgwriter
+	 * dies in the wrong moment. But since PGPROC->procLatch is never
+	 * deallocated the worst consequence of that is that we set the latch of
+	 * some arbitrary process.
+	 */
+	bgwprocno = INT_ACCESS_ONCE(StrategyControl->bgwprocno);
+	if (bgwprocno != -1)
+	{
+		/* reset bgwprocno first, before setting the latch */
+		StrategyControl->bgwprocno = -1;
+
+		/*
+		 * Not acquiring ProcArrayLock here which is slightly icky. It's
+		 * actually fine because procLatch isn't ever freed, so we just can
+		 * potentially set the wrong process' (or no process') latch.
+		 */
+		SetLatch(&ProcGlobal->allProcs[bgwprocno].procLatch);
+	}
+
+	/*
+	 * We count buffer allocation requests so that the bgwriter can estimate
+	 * the rate of buffer consumption.  Note that buffers recycled by a
+	 * strategy object are intentionally not counted here.
+	 */
+	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
+
+	/*
+	 * First check, without acquiring the lock, whether there's buffers in the
+	 * freelist. Since we otherwise don't require the spinlock in every
+	 * StrategyGetBuffer() invocation, it'd be sad to acquire it here -
+	 * uselessly in most cases. That obviously leaves a race where a buffer is
+	 * put on the freelist but we don't see the store yet - but that's pretty
+	 * harmless, it'll just get used during the next buffer acquisition.
+	 *
+	 * If there's buffers on the freelist, acquire the spinlock to pop one
+	 * buffer of the freelist. Then check whether that buffer is usable and
+	 * repeat if not.
+	 *
+	 * Note that the freeNext fields are considered to be protected by the
+	 * buffer_strategy_lock not the individual buffer spinlocks, so it's OK to
+	 * manipulate them without holding the spinlock.
+	 */
+	if (StrategyControl->firstFreeBuffer >= 0)
+	{
+		while (true)
+		{
+			/* Acquire the spinlock to remove element from the freelist */
+			SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+			if (StrategyControl->firstFreeBuffer < 0)
+			{
+				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+				break;
+			}
+
+			buf = GetBufferDescriptor(StrategyControl->firstFreeBuffer);
+			Assert(buf->freeNext != FREENEXT_NOT_IN_LIST);
+
+			/* Unconditionally remove buffer from freelist */
+			StrategyControl->firstFreeBuffer = buf->freeNext;
+			buf->freeNext = FREENEXT_NOT_IN_LIST;
+
+			/*
+			 * Release the lock so someone else can access the freelist while
+			 * we check out this buffer.
+			 */
+			SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+			//CS3223: Add buffer to the head of small. This has to happen before the buffer header is locked, as
+			// list_lock is an LWLock. If the buffer turns out to be unusable below, somebody is using it and it
+			// belongs in small anyway.
+			StrategyAccessBuffer(buf->buf_id, false);                      // Case 2
+
+			/*
+			 * If the buffer is pinned or has a nonzero usage_count, we cannot
+			 * use it; discard it and retry.  (This can only happen if VACUUM
+			 * put a valid buffer in the freelist and then someone else used
+			 * it before we got to it.  It's probably impossible altogether as
+			 * of 8.3, but we'd better check anyway.)
+			 */
+			local_buf_state = LockBufHdr(buf);
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+				&& BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
+			{
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				*buf_state = local_buf_state;
+				return buf;
+			}
+			UnlockBufHdr(buf, local_buf_state);
+		}
+	}
+
+	// CS3223: Counts evictions for the bgwriter's pacing, see StrategySyncStart
+	(void) ClockSweepTick();
+	pg_atomic_fetch_add_u64(strategy != NULL ? &StrategyControl->ringEvictions : &StrategyControl->poolEvictions, 1);
+
+	// Case 3
+	// CS3223: Look at the tail of small while it holds more than its share of the pool, or when main is empty; at the
+	// tail of main otherwise. A tail frame with no references is evicted, others are passed over (see pass_over) and
+	// the next tail is looked at. The victim is moved to the head of small, as it is about to hold a newly loaded
+	// page. list_lock is held exclusively throughout, as the victim has to be relinked without letting go of its
+	// buffer header lock.
+	//
+	// Passing over a referenced frame takes one of its references away, so it will do for the tail eventually unless
+	// it is pinned. Once a queue has been passed over from end to end without that, every frame left in it is pinned,
+	// and the other queue is looked at instead, until both are found to be.
+	LWLockAcquire(&s3fifo->list_lock, LW_EXCLUSIVE);
+
+	for (;;) {
+		bool small_exhausted = small_passed >= s3fifo->small.size;
+		bool main_exhausted = main_passed >= s3fifo->main.size;
+
+		if (small_exhausted && main_exhausted) {
+			break;
+		}
+
+		if (main_exhausted
+			|| (!small_exhausted && (s3fifo->small.size > s3fifo->small_target || s3fifo->main.size == 0))) {
+			list_info = &s3fifo->small;
+		} else {
+			list_info = &s3fifo->main;
+		}
+
+		frame_id = list_info->tail;
+		if (frame_freq(frame_id) == 0 && claim_victim(frame_id, buf_state)) {
+			LWLockRelease(&s3fifo->list_lock);
+
+			buf = GetBufferDescriptor(frame_id);
+			if (strategy != NULL)
+				AddBufferToRing(strategy, buf);
+			return buf;
+		}
+
+		// A fresh frame that claim_victim promoted to main has left the tail already, like a passed over one
+		if (list_info->tail != frame_id) {
+			small_passed = 0;
+			continue;
+		}
+
+		// A pinned frame with no references counts towards the queue being exhausted, any other restarts the count
+		if (frame_freq(frame_id) == 0) {
+			if (list_info == &s3fifo->small) {
+				small_passed++;
+			} else {
+				main_passed++;
+			}
+		} else if (list_info == &s3fifo->small) {
+			small_passed = 0;
+		} else {
+			main_passed = 0;
+		}
+
+		pass_over(frame_id);
+	}
+
+	LWLockRelease(&s3fifo->list_lock);
+
+	/*
+	 * We've scanned all the buffers without making any state changes, so
+	 * all the buffers are pinned (or were when we looked at them). We could
+	 * hope that someone will free one eventually, but it's probably better
+	 * to fail than to risk getting stuck in an infinite loop.
+	 */
+	elog(ERROR, "no unpinned buffers available");
+}
+
+/*
+ * StrategyFreeBuffer: put a buffer on the freelist
+ */
+void
+StrategyFreeBuffer(BufferDesc *buf)
+{
+	// Case 4
+	// CS3223: Unlink the frame before it becomes visible on the freelist. The list lock is an LWLock, which
+	// must not be taken while holding buffer_strategy_lock.
+	StrategyAccessBuffer(buf->buf_id, true);
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+	/*
+	 * It is possible that we are told to put something in the freelist that
+	 * is already in it; don't screw up the list if so.
+	 */
+	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
+	{
+		buf->freeNext = StrategyControl->firstFreeBuffer;
+		if (buf->freeNext < 0)
+			StrategyControl->lastFreeBuffer = buf->buf_id;
+		StrategyControl->firstFreeBuffer = buf->buf_id;
+	}
+
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+/*
+ * StrategySyncStart -- tell BufferSync where to start syncing
+ *
+ * The result is the buffer index of the best buffer to sync first.
+ * BufferSync() will proceed circularly around the buffer array from there.
+ *
+ * In addition, we return the completed-pass count (which is effectively
+ * the higher-order bits of nextVictimBuffer) and the count of recent buffer
+ * allocs if non-NULL pointers are passed.  The alloc count is reset after
+ * being read.
+ *
+ * CS3223: Here the clock hand only counts evictions from the list (see
+ * StrategyGetBuffer), so the result and pass count tell the bgwriter how
+ * far eviction has got but not which buffers come next; BgBufferSync gets
+ * those from StrategySyncVictims.
+ */
+int
+StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
+{
+	uint32		nextVictimBuffer;
+	int			result;
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
+	result = nextVictimBuffer % NBuffers;
+
+	if (complete_passes)
+	{
+		*complete_passes = StrategyControl->completePasses;
+
+		/*
+		 * Additionally add the number of wraparounds that happened before
+		 * completePasses could be incremented. C.f. ClockSweepTick().
+		 */
+		*complete_passes += nextVictimBuffer / NBuffers;
+	}
+
+	if (num_buf_alloc)
+	{
+		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
+	}
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+	return result;
+}
+
+
+// CS3223: No victim queue (see freelist_lru.c), the victims are at the tails of small and main already
+void StrategyRefillVictimQueue(void) {
+}
+
+// CS3223: See StrategySyncVictims in freelist_lru.c. The order is roughly the frames small holds beyond its share, then
+// main, then the rest of small, all from the tail. Referenced frames are skipped, as eviction passes them over first.
+int StrategySyncVictims(int* buf_ids, int max_buffers) {
+	int num_buffers = 0;
+	int32 small_frame_id;
+	int32 main_frame_id;
+
+	if (max_buffers <= 0) {
+		return 0;
+	}
+
+	LWLockAcquire(&s3fifo->list_lock, LW_SHARED);
+
+	small_frame_id = s3fifo->small.tail;
+	main_frame_id = s3fifo->main.tail;
+
+	num_buffers = sync_victims_from(&s3fifo->small, &small_frame_id, buf_ids, num_buffers,
+									Min(max_buffers, Max(s3fifo->small.size - s3fifo->small_target, 0)));
+	num_buffers = sync_victims_from(&s3fifo->main, &main_frame_id, buf_ids, num_buffers, max_buffers);
+	num_buffers = sync_victims_from(&s3fifo->small, &small_frame_id, buf_ids, num_buffers, max_buffers);
+
+	LWLockRelease(&s3fifo->list_lock);
+
+	return num_buffers;
+}
+
+// CS3223: S3-FIFO does no dirty look-ahead, see lru_dirty_lookahead
+void StrategyDirtyLookaheadStats(uint64* clean_substitutions, uint64* dirty_evictions) {
+	*clean_substitutions = 0;
+	*dirty_evictions = 0;
+}
+
+// CS3223: Ring reuse against main pool evictions, see StrategyRingStats in freelist_lru.c
+void StrategyRingStats(uint64* ring_reuses, uint64* ring_evictions, uint64* pool_evictions) {
+	*ring_reuses = pg_atomic_read_u64(&StrategyControl->ringReuses);
+	*ring_evictions = pg_atomic_read_u64(&StrategyControl->ringEvictions);
+	*pool_evictions = pg_atomic_read_u64(&StrategyControl->poolEvictions);
+}
+
+// CS3223: S3-FIFO has no admission filter, see lru_admission_filter
+void StrategyAdmissionStats(uint64* admissions, uint64* rejections) {
+	*admissions = 0;
+	*rejections = 0;
+}
+
+/*
+ * StrategyNotifyBgWriter -- set or clear allocation notification latch
+ *
+ * If bgwprocno isn't -1, the next invocation of StrategyGetBuffer will
+ * set that latch.  Pass -1 to clear the pending notification before it
+ * happens.  This feature is used by the bgwriter process to wake itself up
+ * from hibernation, and is not meant for anybody else to use.
+ */
+void
+StrategyNotifyBgWriter(int bgwprocno)
+{
+	/*
+	 * We acquire buffer_strategy_lock just to ensure that the store appears
+	 * atomic to StrategyGetBuffer.  The bgwriter should call this rather
+	 * infrequently, so there's no performance penalty from being safe.
+	 */
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	StrategyControl->bgwprocno = bgwprocno;
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
+
+
+/*
+ * StrategyShmemSize
+ *
+ * estimate the size of shared memory used by the freelist-related structures.
+ *
+ * Note: for somewhat historical reasons, the buffer lookup hashtable size
+ * is also determined here.
+ */
+Size
+StrategyShmemSize(void)
+{
+	Size		size = 0;
+
+	/* size of lookup hash table ... see comment in StrategyInitialize */
+	size = add_size(size, BufTableShmemSize(NBuffers + NUM_BUFFER_PARTITIONS));
+
+	/* size of the shared replacement strategy control block */
+	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
+
+	// CS3223: Allocate size for our data structures in FREE-LIST, one node per buffer
+	size = add_size(size, mul_size(sizeof(node), NBuffers));
+
+	// Control information of small, main and the ghost queue
+	size = add_size(size, sizeof(s3fifo_info));
+
+	// Frequency word of every frame
+	size = add_size(size, mul_size(sizeof(pg_atomic_uint32), NBuffers));
+
+	// Ghost slots and hash buckets
+	size = add_size(size, mul_size(sizeof(ghost_entry), s3fifo_ghost_capacity()));
+	size = add_size(size, mul_size(sizeof(int32), s3fifo_num_buckets(s3fifo_ghost_capacity())));
+
+	return size;
+}
+
+/*
+ * StrategyInitialize -- initialize the buffer cache replacement
+ *		strategy.
+ *
+ * Assumes: All of the buffers are already built into a linked list.
+ *		Only called by postmaster and only during initialization.
+ */
+void
+StrategyInitialize(bool init)
+{
+	bool		found;
+
+	// CS3223: Boolean values for if shared memory alloc is successful
+	bool is_dll_success = false;
+	bool is_s3fifo_success = false;
+	bool is_freq_success = false;
+	bool is_ghosts_success = false;
+	bool is_ghost_buckets_success = false;
+
+	// s3fifo_ghost_percent is PGC_POSTMASTER, so every backend arrives at the same ghost queue size
+	int ghost_capacity = s3fifo_ghost_capacity();
+	uint32 num_buckets = s3fifo_num_buckets(ghost_capacity);
+
+	/*
+	 * Initialize the shared buffer lookup hashtable.
+	 *
+	 * Since we can't tolerate running out of lookup table entries, we must be
+	 * sure to specify an adequate table size here.  The maximum steady-state
+	 * usage is of course NBuffers entries, but BufferAlloc() tries to insert
+	 * a new entry before deleting the old.  In principle this could be
+	 * happening in each partition concurrently, so we could need as many as
+	 * NBuffers + NUM_BUFFER_PARTITIONS entries.
+	 */
+	InitBufTable(NBuffers + NUM_BUFFER_PARTITIONS);
+
+	/*
+	 * Get or create the shared strategy control block
+	 */
+	StrategyControl = (BufferStrategyControl *)
+		ShmemInitStruct("Buffer Strategy Status",
+						sizeof(BufferStrategyControl),
+						&found);
+
+
+	// CS3223: Initialize space for our data structures
+	s3fifo = (s3fifo_info *)ShmemInitStruct("S3FIFO Info", sizeof(s3fifo_info), &is_s3fifo_success);
+
+	// Double Linked List itself
+	doubleLinkedList = (node *)ShmemInitStruct("Double Link List",
+														mul_size(sizeof(node), NBuffers),
+														&is_dll_success);
+
+	// Frequency words
+	frameFreq = (pg_atomic_uint32 *)ShmemInitStruct("S3FIFO Frame Frequencies",
+													mul_size(sizeof(pg_atomic_uint32), NBuffers),
+													&is_freq_success);
+
+	// Ghost queue
+	ghosts = (ghost_entry *)ShmemInitStruct("S3FIFO Ghosts",
+											mul_size(sizeof(ghost_entry), ghost_capacity),
+											&is_ghosts_success);
+	ghostBuckets = (int32 *)ShmemInitStruct("S3FIFO Ghost Buckets",
+											mul_size(sizeof(int32), num_buckets),
+											&is_ghost_buckets_success);
+
+	if (!found)
+	{
+		/*
+		 * Only done once, usually in postmaster
+		 */
+		Assert(init);
+
+		SpinLockInit(&StrategyControl->buffer_strategy_lock);
+
+		/*
+		 * Grab the whole linked list of free buffers for our strategy. We
+		 * assume it was previously set up by InitBufferPool().
+		 */
+		StrategyControl->firstFreeBuffer = 0;
+		StrategyControl->lastFreeBuffer = NBuffers - 1;
+
+		/* Initialize the clock sweep pointer */
+		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+
+		/* Clear statistics */
+		StrategyControl->completePasses = 0;
+		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
+
+		/* No pending notification */
+		StrategyControl->bgwprocno = -1;
+
+		/* CS3223: Clear ring statistics */
+		pg_atomic_init_u64(&StrategyControl->ringReuses, 0);
+		pg_atomic_init_u64(&StrategyControl->ringEvictions, 0);
+		pg_atomic_init_u64(&StrategyControl->poolEvictions, 0);
+
+		/* CS3223: Tranche of list_lock */
+		StrategyControl->listLockTrancheId = LWLockNewTrancheId();
+	}
+	else
+		Assert(!init);
+
+	// CS3223: Tranche names are backend-local, so every backend registers it
+	LWLockRegisterTranche(StrategyControl->listLockTrancheId, "S3FIFOList");
+
+	// CS3223: Small and main start empty, every node unlinked and no frame referenced
+	if (!is_dll_success && !is_s3fifo_success && !is_freq_success) {
+		Assert (init);
+		LWLockInitialize(&s3fifo->list_lock, StrategyControl->listLockTrancheId);
+
+		s3fifo->small.head = NIL_FRAME;
+		s3fifo->small.tail = NIL_FRAME;
+		s3fifo->small.size = 0;
+		s3fifo->main.head = NIL_FRAME;
+		s3fifo->main.tail = NIL_FRAME;
+		s3fifo->main.size = 0;
+
+		// s3fifo_small_percent is PGC_POSTMASTER as well
+		s3fifo->small_target = s3fifo_small_target();
+
+		// An all-zero node is a valid unlinked node (list is LIST_NONE, prev/next are only read while linked)
+		memset(doubleLinkedList, 0, mul_size(sizeof(node), NBuffers));
+
+		for (int i = 0; i < NBuffers; i++) {
+			pg_atomic_init_u32(&frameFreq[i], 0);
+		}
+	} else
+		Assert(!init);
+
+	// CS3223: The ghost queue starts empty
+	if (!is_ghosts_success && !is_ghost_buckets_success) {
+		Assert (init);
+		s3fifo->ghost_capacity = ghost_capacity;
+		s3fifo->ghost_next = 0;
+		s3fifo->ghost_size = 0;
+		s3fifo->num_buckets = num_buckets;
+
+		for (int i = 0; i < ghost_capacity; i++) {
+			ghosts[i].valid = false;
+			ghosts[i].hash_next = NIL_FRAME;
+		}
+		for (uint32 b = 0; b < num_buckets; b++) {
+			ghostBuckets[b] = NIL_FRAME;
+		}
+	} else
+		Assert(!init);
+}
+
+/* ----------------------------------------------------------------
+ *				Backend-private buffer ring management
+ * ----------------------------------------------------------------
+ */
+
+
+/*
+ * GetAccessStrategy -- create a BufferAccessStrategy object
+ *
+ * The object is allocated in the current memory context.
+ */
+BufferAccessStrategy
+GetAccessStrategy(BufferAccessStrategyType btype)
+{
+	int			ring_size_kb;
+
+	/*
+	 * Select ring size to use.  See buffer/README for rationales.
+	 *
+	 * Note: if you change the ring size for BAS_BULKREAD, see also
+	 * SYNC_SCAN_REPORT_INTERVAL in access/heap/syncscan.c.
+	 */
+	switch (btype)
+	{
+		case BAS_NORMAL:
+			/* if someone asks for NORMAL, just give 'em a "default" object */
+			return NULL;
+
+		case BAS_BULKREAD:
+			ring_size_kb = 256;
+			break;
+		case BAS_BULKWRITE:
+			ring_size_kb = 16 * 1024;
+			break;
+		case BAS_VACUUM:
+			ring_size_kb = 256;
+			break;
+
+		default:
+			elog(ERROR, "unrecognized buffer access strategy: %d",
+				 (int) btype);
+			return NULL;		/* keep compiler quiet */
+	}
+
+	return GetAccessStrategyWithSize(btype, ring_size_kb);
+}
+
+/*
+ * GetAccessStrategyWithSize -- create a BufferAccessStrategy object with a
+ *		number of buffers equivalent to the passed in size.
+ *
+ * If the given ring size is 0, no BufferAccessStrategy will be created and
+ * the function will return NULL.  ring_size_kb must not be negative.
+ */
+BufferAccessStrategy
+GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb)
+{
+	int			ring_buffers;
+	BufferAccessStrategy strategy;
+
+	Assert(ring_size_kb >= 0);
+
+	/* Figure out how many buffers ring_size_kb is */
+	ring_buffers = ring_size_kb / (BLCKSZ / 1024);
+
+	/* 0 means unlimited, so no BufferAccessStrategy required */
+	if (ring_buffers == 0)
+		return NULL;
+
+	/* Cap to 1/8th of shared_buffers */
+	ring_buffers = Min(NBuffers / 8, ring_buffers);
+
+	/* NBuffers should never be less than 16, so this shouldn't happen */
+	Assert(ring_buffers > 0);
+
+	/* Allocate the object and initialize all elements to zeroes */
+	strategy = (BufferAccessStrategy)
+		palloc0(offsetof(BufferAccessStrategyData, buffers) +
+				ring_buffers * sizeof(Buffer));
+
+	/* Set fields that don't start out zero */
+	strategy->btype = btype;
+	strategy->nbuffers = ring_buffers;
+
+	return strategy;
+}
+
+/*
+ * GetAccessStrategyBufferCount -- an accessor for the number of buffers in
+ *		the ring
+ *
+ * Returns 0 on NULL input to match behavior of GetAccessStrategyWithSize()
+ * returning NULL with 0 size.
+ */
+int
+GetAccessStrategyBufferCount(BufferAccessStrategy strategy)
+{
+	if (strategy == NULL)
+		return 0;
+
+	return strategy->nbuffers;
+}
+
+/*
+ * FreeAccessStrategy -- release a BufferAccessStrategy object
+ *
+ * A simple pfree would do at the moment, but we would prefer that callers
+ * don't assume that much about the representation of BufferAccessStrategy.
+ */
+void
+FreeAccessStrategy(BufferAccessStrategy strategy)
+{
+	/* don't crash if called on a "default" strategy */
+	if (strategy != NULL)
+		pfree(strategy);
+}
+
+/*
+ * GetBufferFromRing -- returns a buffer from the ring, or NULL if the
+ *		ring is empty / not usable.
+ *
+ * The bufhdr spin lock is held on the returned buffer.
+ */
+static BufferDesc *
+GetBufferFromRing(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	Buffer		bufnum;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+
+	/* Advance to next ring slot */
+	if (++strategy->current >= strategy->nbuffers)
+		strategy->current = 0;
+
+	/*
+	 * If the slot hasn't been filled yet, tell the caller to allocate a new
+	 * buffer with the normal allocation strategy.  He will then fill this
+	 * slot by calling AddBufferToRing with the new buffer.
+	 */
+	bufnum = strategy->buffers[strategy->current];
+	if (bufnum == InvalidBuffer)
+		return NULL;
+
+	/*
+	 * If the buffer is pinned we cannot use it under any circumstances.
+	 *
+	 * If usage_count is 0 or 1 then the buffer is fair game (we expect 1,
+	 * since our own previous usage of the ring element would have left it
+	 * there, but it might've been decremented by clock sweep since then). A
+	 * higher usage_count indicates someone else has touched the buffer, so we
+	 * shouldn't re-use it.
+	 */
+	buf = GetBufferDescriptor(bufnum - 1);
+	local_buf_state = LockBufHdr(buf);
+	if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+		&& BUF_STATE_GET_USAGECOUNT(local_buf_state) <= 1)
+	{
+		*buf_state = local_buf_state;
+		return buf;
+	}
+	UnlockBufHdr(buf, local_buf_state);
+
+	/*
+	 * Tell caller to allocate a new buffer with the normal allocation
+	 * strategy.  He'll then replace this ring element via AddBufferToRing.
+	 */
+	return NULL;
+}
+
+/*
+ * AddBufferToRing -- add a buffer to the buffer ring
+ *
+ * Caller must hold the buffer header spinlock on the buffer.  Since this
+ * is called with the spinlock held, it had better be quite cheap.
+ */
+static void
+AddBufferToRing(BufferAccessStrategy strategy, BufferDesc *buf)
+{
+	strategy->buffers[strategy->current] = BufferDescriptorGetBuffer(buf);
+}
+
+/*
+ * Utility function returning the IOContext of a given BufferAccessStrategy's
+ * strategy ring.
+ */
+IOContext
+IOContextForStrategy(BufferAccessStrategy strategy)
+{
+	if (!strategy)
+		return IOCONTEXT_NORMAL;
+
+	switch (strategy->btype)
+	{
+		case BAS_NORMAL:
+
+			/*
+			 * Currently, GetAccessStrategy() returns NULL for
+			 * BufferAccessStrategyType BAS_NORMAL, so this case is
+			 * unreachable.
+			 */
+			pg_unreachable();
+			return IOCONTEXT_NORMAL;
+		case BAS_BULKREAD:
+			return IOCONTEXT_BULKREAD;
+		case BAS_BULKWRITE:
+			return IOCONTEXT_BULKWRITE;
+		case BAS_VACUUM:
+			return IOCONTEXT_VACUUM;
+	}
+
+	elog(ERROR, "unrecognized BufferAccessStrategyType: %d", strategy->btype);
+	pg_unreachable();
+}
+
+/*
+ * StrategyRejectBuffer -- consider rejecting a dirty buffer
+ *
+ * When a nondefault strategy is used, the buffer manager calls this function
+ * when it turns out that the buffer selected by StrategyGetBuffer needs to
+ * be written out and doing so would require flushing WAL too.  This gives us
+ * a chance to choose a different victim.
+ *
+ * Returns true if buffer manager should ask for a new victim, and false
+ * if this buffer should be written and re-used.
+ */
+bool
+StrategyRejectBuffer(BufferAccessStrategy strategy, BufferDesc *buf, bool from_ring)
+{
+	/* We only do this in bulkread mode */
+	if (strategy->btype != BAS_BULKREAD)
+		return false;
+
+	/* Don't muck with behavior of normal buffer-replacement strategy */
+	if (!from_ring ||
+		strategy->buffers[strategy->current] != BufferDescriptorGetBuffer(buf))
+		return false;
+
+	/*
+	 * Remove the dirty buffer from the ring; necessary to prevent infinite
+	 * loop if all ring members are dirty.
+	 */
+	strategy->buffers[strategy->current] = InvalidBuffer;
+
+	return true;
+}